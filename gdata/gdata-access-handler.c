@@ -71,8 +71,8 @@ gdata_access_handler_get_type (void)
  *
  * A %GDATA_SERVICE_ERROR_WITH_QUERY will be returned if the server indicates there is a problem with the query.
  *
- * For each rule in the response feed, @progress_callback will be called in the main thread. If there was an error parsing the XML response,
- * a #GDataParserError will be returned.
+ * For each rule in the response feed, @progress_callback will be called in the thread-default main context of the thread which called this
+ * function. If there was an error parsing the XML response, a #GDataParserError will be returned.
  *
  * Return value: a #GDataFeed of access control rules, or %NULL; unref with g_object_unref()
  *
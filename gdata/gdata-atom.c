@@ -28,7 +28,10 @@
  * GData APIs, as the GData API is based on Atom.
  **/
 
+#include <glib.h>
+
 #include "gdata-atom.h"
+#include "gdata-private.h"
 
 /**
  * gdata_category_new:
@@ -57,6 +60,21 @@ gdata_category_new (const gchar *term, const gchar *scheme, const gchar *label)
 	return self;
 }
 
+/* Like gdata_category_new(), but takes ownership of its (g_malloc()ed) parameters rather than copying them, for use by the parsers */
+GDataCategory *
+_gdata_category_new_take (gchar *term, gchar *scheme, gchar *label)
+{
+	GDataCategory *self;
+
+	g_return_val_if_fail (term != NULL, NULL);
+
+	self = g_slice_new (GDataCategory);
+	self->term = term;
+	self->scheme = scheme;
+	self->label = label;
+	return self;
+}
+
 /**
  * gdata_category_compare:
  * @a: a #GDataCategory, or %NULL
@@ -137,6 +155,51 @@ gdata_link_new (const gchar *href, const gchar *rel, const gchar *type, const gc
 	return self;
 }
 
+/* Like gdata_link_new(), but takes ownership of its (g_malloc()ed) parameters rather than copying them, for use by the parsers */
+GDataLink *
+_gdata_link_new_take (gchar *href, gchar *rel, gchar *type, gchar *hreflang, gchar *title, gint length)
+{
+	GDataLink *self;
+
+	g_return_val_if_fail (href != NULL, NULL);
+	if (rel == NULL)
+		rel = g_strdup ("alternate");
+
+	self = g_slice_new (GDataLink);
+	self->href = href;
+	self->rel = rel;
+	self->type = type;
+	self->hreflang = hreflang;
+	self->title = title;
+	self->length = length;
+	return self;
+}
+
+/* Builds a hash table mapping each rel value in @links to a #GList of the links with that rel, in the same order as in @links. Neither the
+ * rel strings nor the links are owned by the table, so it must be rebuilt whenever @links changes. */
+GHashTable *
+_gdata_link_index_new (GList *links)
+{
+	GHashTable *index;
+	GList *i;
+
+	index = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) g_list_free);
+
+	/* Walk backwards so that prepending keeps the links in order */
+	for (i = g_list_last (links); i != NULL; i = i->prev) {
+		GDataLink *link = (GDataLink*) i->data;
+		GList *rel_links = NULL;
+
+		/* Steal the existing list so that replacing it doesn't free it */
+		if (g_hash_table_lookup_extended (index, link->rel, NULL, (gpointer*) &rel_links) == TRUE)
+			g_hash_table_steal (index, link->rel);
+
+		g_hash_table_insert (index, link->rel, g_list_prepend (rel_links, link));
+	}
+
+	return index;
+}
+
 /**
  * gdata_link_compare:
  * @a: a #GDataLink, or %NULL
@@ -211,6 +274,21 @@ gdata_author_new (const gchar *name, const gchar *uri, const gchar *email)
 	return self;
 }
 
+/* Like gdata_author_new(), but takes ownership of its (g_malloc()ed) parameters rather than copying them, for use by the parsers */
+GDataAuthor *
+_gdata_author_new_take (gchar *name, gchar *uri, gchar *email)
+{
+	GDataAuthor *self;
+
+	g_return_val_if_fail (name != NULL, NULL);
+
+	self = g_slice_new (GDataAuthor);
+	self->name = name;
+	self->uri = uri;
+	self->email = email;
+	return self;
+}
+
 /**
  * gdata_author_compare:
  * @a: a #GDataAuthor, or %NULL
@@ -0,0 +1,710 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2009 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-batch-operation
+ * @short_description: GData batch operation object
+ * @stability: Unstable
+ * @include: gdata/gdata-batch-operation.h
+ *
+ * #GDataBatchOperation allows many queries, insertions, updates and deletions to be sent to a feed's batch processing URI in a single
+ * request, rather than making one round trip to the server for each. For more information, see the
+ * <ulink type="http" url="http://code.google.com/apis/gdata/docs/batch.html">online documentation</ulink> for the GData protocol.
+ *
+ * Operations are added to the batch with gdata_batch_operation_add_query(), gdata_batch_operation_add_insertion(),
+ * gdata_batch_operation_add_update() and gdata_batch_operation_add_deletion(), each of which takes a callback to be called with the result
+ * of that operation once the batch has been run with gdata_batch_operation_run(). If the batch contains more operations than the server
+ * accepts in a single request, it is automatically split into several requests.
+ *
+ * Since: 0.4.0
+ **/
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+#include <libxml/parser.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "gdata-batch-operation.h"
+#include "gdata-private.h"
+#include "gdata-parser.h"
+
+/* The maximum number of operations the server will accept in a single batch feed */
+#define MAX_OPERATIONS_PER_REQUEST 100
+
+#define BATCH_NAMESPACE "http://schemas.google.com/gdata/batch"
+
+typedef struct {
+	guint id;
+	GDataBatchOperationType type;
+	GType entry_type;
+	gchar *query_id;
+	GDataEntry *entry;
+	GDataBatchOperationCallback callback;
+	gpointer user_data;
+	gboolean has_result;
+} BatchOperation;
+
+static void gdata_batch_operation_dispose (GObject *object);
+static void gdata_batch_operation_finalize (GObject *object);
+static void gdata_batch_operation_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_batch_operation_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+struct _GDataBatchOperationPrivate {
+	GDataService *service;
+	gchar *feed_uri;
+
+	GList *operations;
+	guint next_id;
+};
+
+enum {
+	PROP_SERVICE = 1,
+	PROP_FEED_URI
+};
+
+G_DEFINE_TYPE (GDataBatchOperation, gdata_batch_operation, G_TYPE_OBJECT)
+#define GDATA_BATCH_OPERATION_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GDATA_TYPE_BATCH_OPERATION, GDataBatchOperationPrivate))
+
+static void
+gdata_batch_operation_class_init (GDataBatchOperationClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataBatchOperationPrivate));
+
+	gobject_class->get_property = gdata_batch_operation_get_property;
+	gobject_class->set_property = gdata_batch_operation_set_property;
+	gobject_class->dispose = gdata_batch_operation_dispose;
+	gobject_class->finalize = gdata_batch_operation_finalize;
+
+	/**
+	 * GDataBatchOperation:service:
+	 *
+	 * The #GDataService to which the batch operation will be sent.
+	 *
+	 * Since: 0.4.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_SERVICE,
+				g_param_spec_object ("service",
+					"Service", "The service to which the batch operation will be sent.",
+					GDATA_TYPE_SERVICE,
+					G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataBatchOperation:feed-uri:
+	 *
+	 * The batch processing URI of the feed the operations apply to. This is the URI of the feed's #GDATA_LINK_BATCH link.
+	 *
+	 * Since: 0.4.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_FEED_URI,
+				g_param_spec_string ("feed-uri",
+					"Feed URI", "The batch processing URI of the feed the operations apply to.",
+					NULL,
+					G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gdata_batch_operation_init (GDataBatchOperation *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_BATCH_OPERATION, GDataBatchOperationPrivate);
+	self->priv->next_id = 1;
+}
+
+static void
+batch_operation_free (BatchOperation *operation)
+{
+	g_free (operation->query_id);
+	if (operation->entry != NULL)
+		g_object_unref (operation->entry);
+
+	g_slice_free (BatchOperation, operation);
+}
+
+static void
+gdata_batch_operation_dispose (GObject *object)
+{
+	GDataBatchOperationPrivate *priv = GDATA_BATCH_OPERATION_GET_PRIVATE (object);
+
+	if (priv->service != NULL)
+		g_object_unref (priv->service);
+	priv->service = NULL;
+
+	g_list_foreach (priv->operations, (GFunc) batch_operation_free, NULL);
+	g_list_free (priv->operations);
+	priv->operations = NULL;
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_batch_operation_parent_class)->dispose (object);
+}
+
+static void
+gdata_batch_operation_finalize (GObject *object)
+{
+	GDataBatchOperationPrivate *priv = GDATA_BATCH_OPERATION_GET_PRIVATE (object);
+
+	g_free (priv->feed_uri);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_batch_operation_parent_class)->finalize (object);
+}
+
+static void
+gdata_batch_operation_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataBatchOperationPrivate *priv = GDATA_BATCH_OPERATION_GET_PRIVATE (object);
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			g_value_set_object (value, priv->service);
+			break;
+		case PROP_FEED_URI:
+			g_value_set_string (value, priv->feed_uri);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_batch_operation_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataBatchOperationPrivate *priv = GDATA_BATCH_OPERATION_GET_PRIVATE (object);
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			priv->service = g_value_dup_object (value);
+			break;
+		case PROP_FEED_URI:
+			priv->feed_uri = g_value_dup_string (value);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+/**
+ * gdata_batch_operation_new:
+ * @service: the #GDataService to send the batch operation to
+ * @feed_uri: the batch processing URI of the feed
+ *
+ * Creates a new, empty #GDataBatchOperation which will send its operations to @feed_uri, the batch processing URI of the feed to be
+ * modified. This is typically the URI of the feed's #GDATA_LINK_BATCH link, as returned by gdata_feed_look_up_link().
+ *
+ * Return value: a new #GDataBatchOperation; unref with g_object_unref()
+ *
+ * Since: 0.4.0
+ **/
+GDataBatchOperation *
+gdata_batch_operation_new (GDataService *service, const gchar *feed_uri)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), NULL);
+	g_return_val_if_fail (feed_uri != NULL, NULL);
+
+	return g_object_new (GDATA_TYPE_BATCH_OPERATION, "service", service, "feed-uri", feed_uri, NULL);
+}
+
+/**
+ * gdata_batch_operation_get_service:
+ * @self: a #GDataBatchOperation
+ *
+ * Gets the #GDataBatchOperation:service property.
+ *
+ * Return value: the batch operation's service
+ *
+ * Since: 0.4.0
+ **/
+GDataService *
+gdata_batch_operation_get_service (GDataBatchOperation *self)
+{
+	g_return_val_if_fail (GDATA_IS_BATCH_OPERATION (self), NULL);
+	return self->priv->service;
+}
+
+/**
+ * gdata_batch_operation_get_feed_uri:
+ * @self: a #GDataBatchOperation
+ *
+ * Gets the #GDataBatchOperation:feed-uri property.
+ *
+ * Return value: the batch processing URI of the feed
+ *
+ * Since: 0.4.0
+ **/
+const gchar *
+gdata_batch_operation_get_feed_uri (GDataBatchOperation *self)
+{
+	g_return_val_if_fail (GDATA_IS_BATCH_OPERATION (self), NULL);
+	return self->priv->feed_uri;
+}
+
+static guint
+add_operation (GDataBatchOperation *self, GDataBatchOperationType type, GType entry_type, const gchar *query_id, GDataEntry *entry,
+	       GDataBatchOperationCallback callback, gpointer user_data)
+{
+	BatchOperation *operation;
+
+	operation = g_slice_new0 (BatchOperation);
+	operation->id = self->priv->next_id++;
+	operation->type = type;
+	operation->entry_type = entry_type;
+	operation->query_id = g_strdup (query_id);
+	operation->entry = (entry != NULL) ? g_object_ref (entry) : NULL;
+	operation->callback = callback;
+	operation->user_data = user_data;
+
+	/* The list is reversed before the operations are run */
+	self->priv->operations = g_list_prepend (self->priv->operations, operation);
+
+	return operation->id;
+}
+
+/**
+ * gdata_batch_operation_add_query:
+ * @self: a #GDataBatchOperation
+ * @id: the ID of the entry to query for
+ * @entry_type: the #GType of the entry to build from the response
+ * @callback: a #GDataBatchOperationCallback to call when the query is finished, or %NULL
+ * @user_data: data to pass to the @callback function
+ *
+ * Adds an operation to @self to query for the entry with the given @id, which will be returned to @callback as a new entry of type @entry_type
+ * once the batch has been run.
+ *
+ * Return value: the operation's ID
+ *
+ * Since: 0.4.0
+ **/
+guint
+gdata_batch_operation_add_query (GDataBatchOperation *self, const gchar *id, GType entry_type,
+				 GDataBatchOperationCallback callback, gpointer user_data)
+{
+	g_return_val_if_fail (GDATA_IS_BATCH_OPERATION (self), 0);
+	g_return_val_if_fail (id != NULL, 0);
+	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY) == TRUE, 0);
+
+	return add_operation (self, GDATA_BATCH_OPERATION_QUERY, entry_type, id, NULL, callback, user_data);
+}
+
+/**
+ * gdata_batch_operation_add_insertion:
+ * @self: a #GDataBatchOperation
+ * @entry: the #GDataEntry to insert
+ * @callback: a #GDataBatchOperationCallback to call when the insertion is finished, or %NULL
+ * @user_data: data to pass to the @callback function
+ *
+ * Adds an operation to @self to insert @entry into the feed. The updated version of @entry returned by the server will be passed to @callback
+ * once the batch has been run. @entry is reffed, so can safely be unreffed after this function returns.
+ *
+ * Return value: the operation's ID
+ *
+ * Since: 0.4.0
+ **/
+guint
+gdata_batch_operation_add_insertion (GDataBatchOperation *self, GDataEntry *entry, GDataBatchOperationCallback callback, gpointer user_data)
+{
+	g_return_val_if_fail (GDATA_IS_BATCH_OPERATION (self), 0);
+	g_return_val_if_fail (GDATA_IS_ENTRY (entry), 0);
+	g_return_val_if_fail (gdata_entry_is_inserted (entry) == FALSE, 0);
+
+	return add_operation (self, GDATA_BATCH_OPERATION_INSERTION, G_OBJECT_TYPE (entry), NULL, entry, callback, user_data);
+}
+
+/**
+ * gdata_batch_operation_add_update:
+ * @self: a #GDataBatchOperation
+ * @entry: the #GDataEntry to update
+ * @callback: a #GDataBatchOperationCallback to call when the update is finished, or %NULL
+ * @user_data: data to pass to the @callback function
+ *
+ * Adds an operation to @self to update @entry, which must already have been inserted. The updated version of @entry returned by the server
+ * will be passed to @callback once the batch has been run. @entry is reffed, so can safely be unreffed after this function returns.
+ *
+ * Return value: the operation's ID
+ *
+ * Since: 0.4.0
+ **/
+guint
+gdata_batch_operation_add_update (GDataBatchOperation *self, GDataEntry *entry, GDataBatchOperationCallback callback, gpointer user_data)
+{
+	g_return_val_if_fail (GDATA_IS_BATCH_OPERATION (self), 0);
+	g_return_val_if_fail (GDATA_IS_ENTRY (entry), 0);
+	g_return_val_if_fail (gdata_entry_is_inserted (entry) == TRUE, 0);
+
+	return add_operation (self, GDATA_BATCH_OPERATION_UPDATE, G_OBJECT_TYPE (entry), NULL, entry, callback, user_data);
+}
+
+/**
+ * gdata_batch_operation_add_deletion:
+ * @self: a #GDataBatchOperation
+ * @entry: the #GDataEntry to delete
+ * @callback: a #GDataBatchOperationCallback to call when the deletion is finished, or %NULL
+ * @user_data: data to pass to the @callback function
+ *
+ * Adds an operation to @self to delete @entry, which must already have been inserted. @entry is reffed, so can safely be unreffed after
+ * this function returns.
+ *
+ * Return value: the operation's ID
+ *
+ * Since: 0.4.0
+ **/
+guint
+gdata_batch_operation_add_deletion (GDataBatchOperation *self, GDataEntry *entry, GDataBatchOperationCallback callback, gpointer user_data)
+{
+	g_return_val_if_fail (GDATA_IS_BATCH_OPERATION (self), 0);
+	g_return_val_if_fail (GDATA_IS_ENTRY (entry), 0);
+	g_return_val_if_fail (gdata_entry_is_inserted (entry) == TRUE, 0);
+
+	return add_operation (self, GDATA_BATCH_OPERATION_DELETION, G_OBJECT_TYPE (entry), NULL, entry, callback, user_data);
+}
+
+static void
+append_batch_elements (GString *xml_string, BatchOperation *operation)
+{
+	const gchar *operation_types[] = { "query", "insert", "update", "delete" };
+
+	g_string_append_printf (xml_string, "<batch:id>%u</batch:id><batch:operation type='%s'/>", operation->id, operation_types[operation->type]);
+}
+
+static gchar *
+build_batch_feed (GList *operations, guint n_operations)
+{
+	GString *xml_string;
+	gchar *entry_xml, *tag_end;
+
+	xml_string = g_string_new ("<?xml version='1.0' encoding='UTF-8'?>"
+				   "<feed xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' "
+				   "xmlns:batch='" BATCH_NAMESPACE "'>");
+
+	for (; operations != NULL && n_operations > 0; operations = operations->next, n_operations--) {
+		BatchOperation *operation = operations->data;
+
+		switch (operation->type) {
+			case GDATA_BATCH_OPERATION_QUERY:
+			case GDATA_BATCH_OPERATION_DELETION:
+				/* Queries and deletions only need the entry's ID (and its ETag, for deletions) */
+				if (operation->type == GDATA_BATCH_OPERATION_DELETION && gdata_entry_get_etag (operation->entry) != NULL) {
+					entry_xml = g_markup_printf_escaped ("<entry gd:etag='%s'><id>%s</id>", gdata_entry_get_etag (operation->entry),
+									     gdata_entry_get_id (operation->entry));
+				} else {
+					entry_xml = g_markup_printf_escaped ("<entry><id>%s</id>",
+									     (operation->entry != NULL) ? gdata_entry_get_id (operation->entry)
+												        : operation->query_id);
+				}
+
+				g_string_append (xml_string, entry_xml);
+				append_batch_elements (xml_string, operation);
+				g_string_append (xml_string, "</entry>");
+				g_free (entry_xml);
+				break;
+			case GDATA_BATCH_OPERATION_INSERTION:
+			case GDATA_BATCH_OPERATION_UPDATE:
+				/* Insert the batch elements just after the entry's opening tag */
+				entry_xml = gdata_entry_get_xml (operation->entry);
+				tag_end = strchr (entry_xml, '>');
+				g_assert (tag_end != NULL);
+
+				g_string_append_len (xml_string, entry_xml, tag_end - entry_xml + 1);
+				append_batch_elements (xml_string, operation);
+				g_string_append (xml_string, tag_end + 1);
+				g_free (entry_xml);
+				break;
+			default:
+				g_assert_not_reached ();
+		}
+	}
+
+	g_string_append (xml_string, "</feed>");
+
+	return g_string_free (xml_string, FALSE);
+}
+
+static GDataServiceError
+get_service_error_type (GDataBatchOperationType type)
+{
+	const GDataServiceError error_types[] = {
+		GDATA_SERVICE_ERROR_WITH_QUERY,
+		GDATA_SERVICE_ERROR_WITH_INSERTION,
+		GDATA_SERVICE_ERROR_WITH_UPDATE,
+		GDATA_SERVICE_ERROR_WITH_DELETION
+	};
+
+	g_assert (type <= GDATA_BATCH_OPERATION_DELETION);
+	return error_types[type];
+}
+
+static void
+run_callback (BatchOperation *operation, GDataEntry *entry, GError *error)
+{
+	operation->has_result = TRUE;
+	if (operation->callback != NULL)
+		operation->callback (operation->id, operation->type, entry, error, operation->user_data);
+}
+
+static BatchOperation *
+find_operation (GList *operations, guint n_operations, guint id)
+{
+	for (; operations != NULL && n_operations > 0; operations = operations->next, n_operations--) {
+		BatchOperation *operation = operations->data;
+		if (operation->id == id)
+			return operation;
+	}
+
+	return NULL;
+}
+
+static void
+process_result_entry (GDataBatchOperation *self, xmlDoc *doc, xmlNode *entry_node, GList *operations, guint n_operations)
+{
+	GDataServiceClass *klass = GDATA_SERVICE_GET_CLASS (self->priv->service);
+	BatchOperation *operation = NULL;
+	GDataEntry *entry = NULL;
+	GError *error = NULL;
+	xmlNode *node, *next_node;
+	xmlChar *code = NULL, *reason = NULL;
+	guint status;
+
+	/* Extract and remove the batch elements, so they don't get treated as unhandled XML when the entry's parsed */
+	for (node = entry_node->children; node != NULL; node = next_node) {
+		next_node = node->next;
+
+		if (node->type != XML_ELEMENT_NODE || node->ns == NULL || xmlStrcmp (node->ns->href, (xmlChar*) BATCH_NAMESPACE) != 0)
+			continue;
+
+		if (xmlStrcmp (node->name, (xmlChar*) "id") == 0) {
+			/* batch:id */
+			xmlChar *id = xmlNodeListGetString (doc, node->children, TRUE);
+			if (id != NULL)
+				operation = find_operation (operations, n_operations, strtoul ((gchar*) id, NULL, 10));
+			xmlFree (id);
+		} else if (xmlStrcmp (node->name, (xmlChar*) "status") == 0 && code == NULL) {
+			/* batch:status */
+			code = xmlGetProp (node, (xmlChar*) "code");
+			reason = xmlGetProp (node, (xmlChar*) "reason");
+		}
+
+		xmlUnlinkNode (node);
+		xmlFreeNode (node);
+	}
+
+	/* Ignore results we can't match up to an operation */
+	if (operation == NULL || operation->has_result == TRUE)
+		goto done;
+
+	status = (code != NULL) ? strtoul ((gchar*) code, NULL, 10) : 0;
+
+	if (status == 0) {
+		g_set_error_literal (&error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+				     _("The server returned a malformed response."));
+	} else if (status != ((operation->type == GDATA_BATCH_OPERATION_INSERTION) ? 201 : 200)) {
+		/* Error */
+		g_assert (klass->parse_error_response != NULL);
+		klass->parse_error_response (self->priv->service, get_service_error_type (operation->type), status, (gchar*) reason, NULL, 0, &error);
+	} else if (operation->type != GDATA_BATCH_OPERATION_DELETION) {
+		/* Build the resulting entry */
+		entry = GDATA_ENTRY (_gdata_parsable_new_from_xml_node (operation->entry_type, "entry", GDATA_PARSABLE_UNKNOWN_XML_SERIALISE, doc,
+										entry_node, NULL, &error));
+	}
+
+	run_callback (operation, entry, error);
+
+	if (entry != NULL)
+		g_object_unref (entry);
+	if (error != NULL)
+		g_error_free (error);
+
+done:
+	xmlFree (code);
+	xmlFree (reason);
+}
+
+typedef struct {
+	GDataBatchOperation *self;
+	GList *operations;
+	guint n_operations;
+	GDataParsableStream *stream;
+	GError *error;
+} BatchResponseData;
+
+static gboolean
+process_result_cb (xmlDoc *doc, xmlNode *node, BatchResponseData *data, GError **error)
+{
+	/* Each child of the response feed is passed here as soon as it's been received; anything other than an entry is ignored */
+	if (node->type == XML_ELEMENT_NODE && xmlStrcmp (node->name, (xmlChar*) "entry") == 0)
+		process_result_entry (data->self, doc, node, data->operations, data->n_operations);
+
+	return TRUE;
+}
+
+static void
+batch_got_headers_cb (SoupMessage *message, BatchResponseData *data)
+{
+	/* Only successful responses are parsed as they arrive; error responses are accumulated so they can be passed to parse_error_response */
+	soup_message_body_set_accumulate (message->response_body, (message->status_code == 200) ? FALSE : TRUE);
+}
+
+static void
+batch_got_chunk_cb (SoupMessage *message, SoupBuffer *chunk, BatchResponseData *data)
+{
+	if (message->status_code != 200 || data->error != NULL)
+		return;
+
+	_gdata_parsable_stream_push (data->stream, chunk->data, chunk->length, &(data->error));
+}
+
+static gboolean
+run_operations (GDataBatchOperation *self, GList *operations, guint n_operations, GCancellable *cancellable, GError **error)
+{
+	GDataServiceClass *klass;
+	SoupMessage *message;
+	BatchResponseData data;
+	gchar *upload_data;
+	guint status;
+	gboolean success = FALSE;
+	GError *child_error = NULL;
+
+	message = soup_message_new (SOUP_METHOD_POST, self->priv->feed_uri);
+
+	/* Make sure subclasses set their headers */
+	klass = GDATA_SERVICE_GET_CLASS (self->priv->service);
+	if (klass->append_query_headers != NULL)
+		klass->append_query_headers (self->priv->service, message);
+
+	/* Append the data */
+	upload_data = build_batch_feed (operations, n_operations);
+	soup_message_set_request (message, "application/atom+xml", SOUP_MEMORY_TAKE, upload_data, strlen (upload_data));
+
+	/* The results are handed to their callbacks as they arrive, and the response is never held in memory as a whole */
+	data.self = self;
+	data.operations = operations;
+	data.n_operations = n_operations;
+	data.stream = _gdata_parsable_stream_new_for_children ("feed", (GDataParsableStreamChildFunc) process_result_cb, &data, NULL);
+	data.error = NULL;
+
+	g_signal_connect (message, "got-headers", (GCallback) batch_got_headers_cb, &data);
+	g_signal_connect (message, "got-chunk", (GCallback) batch_got_chunk_cb, &data);
+
+	/* Send the message */
+	status = _gdata_service_send_message (self->priv->service, message, error);
+	if (status == SOUP_STATUS_NONE)
+		goto done;
+
+	/* Check for cancellation */
+	if (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE)
+		goto done;
+
+	if (status != 200) {
+		/* Error; report it as an error with the first operation in the request */
+		g_assert (klass->parse_error_response != NULL);
+		klass->parse_error_response (self->priv->service, get_service_error_type (((BatchOperation*) operations->data)->type), status,
+					     message->reason_phrase, message->response_body->data, message->response_body->length, error);
+		goto done;
+	}
+
+	/* Check for errors while parsing */
+	if (data.error != NULL) {
+		g_propagate_error (error, data.error);
+		data.error = NULL;
+		goto done;
+	}
+
+	if (_gdata_parsable_stream_end (data.stream, error) == FALSE)
+		goto done;
+
+	/* Any operations the server didn't return a result for (for example, because the batch was interrupted) have failed */
+	for (; operations != NULL && n_operations > 0; operations = operations->next, n_operations--) {
+		BatchOperation *operation = operations->data;
+
+		if (operation->has_result == TRUE)
+			continue;
+
+		g_set_error (&child_error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+			     _("The server didn't return a result for batch operation %u."), operation->id);
+		run_callback (operation, NULL, child_error);
+		g_clear_error (&child_error);
+	}
+
+	success = TRUE;
+
+done:
+	g_object_unref (message);
+	_gdata_parsable_stream_free (data.stream);
+	if (data.error != NULL)
+		g_error_free (data.error);
+
+	return success;
+}
+
+/**
+ * gdata_batch_operation_run:
+ * @self: a #GDataBatchOperation
+ * @cancellable: optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Runs all the operations which have been added to @self, sending them to the server as a batch feed (or as several batch feeds, if there are
+ * more operations than the server accepts in one request). The callback for each operation will be called with its result as soon as it's
+ * been received, before this function returns. All the operations are then removed from @self, so that it can be reused.
+ *
+ * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
+ * If the operation was cancelled, the error %G_IO_ERROR_CANCELLED will be returned.
+ *
+ * If a request fails as a whole (rather than individual operations in it failing), an error will be returned, and the callbacks for any
+ * later requests will not be called. Since each response is parsed as it arrives, the callbacks for the operations whose results were received
+ * before a request failed (for example, if the connection is lost part-way through the response) will already have been called; the callbacks
+ * for the rest of the operations in that request will not be. Errors from individual operations are passed to their callbacks, and don't
+ * cause this function to fail.
+ *
+ * Return value: %TRUE if all the requests were sent successfully, %FALSE otherwise
+ *
+ * Since: 0.4.0
+ **/
+gboolean
+gdata_batch_operation_run (GDataBatchOperation *self, GCancellable *cancellable, GError **error)
+{
+	GList *operations, *i;
+	guint n_operations, n_remaining, j;
+	gboolean success = TRUE;
+
+	g_return_val_if_fail (GDATA_IS_BATCH_OPERATION (self), FALSE);
+
+	operations = g_list_reverse (self->priv->operations);
+	self->priv->operations = NULL;
+
+	/* Send the operations in chunks no bigger than the server will accept */
+	n_remaining = g_list_length (operations);
+	for (i = operations; i != NULL && success == TRUE;) {
+		n_operations = MIN (n_remaining, MAX_OPERATIONS_PER_REQUEST);
+		success = run_operations (self, i, n_operations, cancellable, error);
+
+		/* Move on to the first operation of the next chunk */
+		n_remaining -= n_operations;
+		for (j = 0; j < n_operations; j++)
+			i = i->next;
+	}
+
+	g_list_foreach (operations, (GFunc) batch_operation_free, NULL);
+	g_list_free (operations);
+
+	return success;
+}
@@ -0,0 +1,126 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2009 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_BATCH_OPERATION_H
+#define GDATA_BATCH_OPERATION_H
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <gdata/gdata-entry.h>
+#include <gdata/gdata-service.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GDATA_LINK_BATCH:
+ *
+ * The relation type of the link to a feed's batch processing URI, for use with gdata_feed_look_up_link().
+ *
+ * Since: 0.4.0
+ **/
+#define GDATA_LINK_BATCH "http://schemas.google.com/g/2005#batch"
+
+/**
+ * GDataBatchOperationType:
+ * @GDATA_BATCH_OPERATION_QUERY: a query operation
+ * @GDATA_BATCH_OPERATION_INSERTION: an insertion operation
+ * @GDATA_BATCH_OPERATION_UPDATE: an update operation
+ * @GDATA_BATCH_OPERATION_DELETION: a deletion operation
+ *
+ * The type of an operation in a #GDataBatchOperation.
+ *
+ * Since: 0.4.0
+ **/
+typedef enum {
+	GDATA_BATCH_OPERATION_QUERY = 0,
+	GDATA_BATCH_OPERATION_INSERTION,
+	GDATA_BATCH_OPERATION_UPDATE,
+	GDATA_BATCH_OPERATION_DELETION
+} GDataBatchOperationType;
+
+/**
+ * GDataBatchOperationCallback:
+ * @operation_id: the ID of the operation, as returned when it was added to the #GDataBatchOperation
+ * @operation_type: the type of the operation
+ * @entry: the resulting #GDataEntry, or %NULL
+ * @error: a #GError describing why the operation failed, or %NULL
+ * @user_data: user data passed when the operation was added
+ *
+ * Callback function called once for each operation in a #GDataBatchOperation when the batch is run. If the operation was successful, @error will
+ * be %NULL, and @entry will be the entry returned by the server (except for deletions, where it will be %NULL). Otherwise, @entry will be %NULL
+ * and @error will be set. Neither @entry nor @error are owned by the callback; @entry should be reffed if it needs to be kept.
+ *
+ * Since: 0.4.0
+ **/
+typedef void (*GDataBatchOperationCallback) (guint operation_id, GDataBatchOperationType operation_type, GDataEntry *entry, GError *error,
+					     gpointer user_data);
+
+#define GDATA_TYPE_BATCH_OPERATION		(gdata_batch_operation_get_type ())
+#define GDATA_BATCH_OPERATION(o)		(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_BATCH_OPERATION, GDataBatchOperation))
+#define GDATA_BATCH_OPERATION_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_BATCH_OPERATION, GDataBatchOperationClass))
+#define GDATA_IS_BATCH_OPERATION(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_BATCH_OPERATION))
+#define GDATA_IS_BATCH_OPERATION_CLASS(k)	(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_BATCH_OPERATION))
+#define GDATA_BATCH_OPERATION_GET_CLASS(o)	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_BATCH_OPERATION, GDataBatchOperationClass))
+
+typedef struct _GDataBatchOperationPrivate	GDataBatchOperationPrivate;
+
+/**
+ * GDataBatchOperation:
+ *
+ * All the fields in the #GDataBatchOperation structure are private and should never be accessed directly.
+ *
+ * Since: 0.4.0
+ **/
+typedef struct {
+	GObject parent;
+	GDataBatchOperationPrivate *priv;
+} GDataBatchOperation;
+
+/**
+ * GDataBatchOperationClass:
+ *
+ * All the fields in the #GDataBatchOperationClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.4.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataBatchOperationClass;
+
+GType gdata_batch_operation_get_type (void) G_GNUC_CONST;
+
+GDataBatchOperation *gdata_batch_operation_new (GDataService *service, const gchar *feed_uri) G_GNUC_WARN_UNUSED_RESULT;
+
+GDataService *gdata_batch_operation_get_service (GDataBatchOperation *self);
+const gchar *gdata_batch_operation_get_feed_uri (GDataBatchOperation *self);
+
+guint gdata_batch_operation_add_query (GDataBatchOperation *self, const gchar *id, GType entry_type,
+				       GDataBatchOperationCallback callback, gpointer user_data);
+guint gdata_batch_operation_add_insertion (GDataBatchOperation *self, GDataEntry *entry, GDataBatchOperationCallback callback, gpointer user_data);
+guint gdata_batch_operation_add_update (GDataBatchOperation *self, GDataEntry *entry, GDataBatchOperationCallback callback, gpointer user_data);
+guint gdata_batch_operation_add_deletion (GDataBatchOperation *self, GDataEntry *entry, GDataBatchOperationCallback callback, gpointer user_data);
+
+gboolean gdata_batch_operation_run (GDataBatchOperation *self, GCancellable *cancellable, GError **error);
+
+G_END_DECLS
+
+#endif /* !GDATA_BATCH_OPERATION_H */
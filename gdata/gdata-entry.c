@@ -58,6 +58,7 @@ struct _GDataEntryPrivate {
 	GList *categories;
 	gchar *content;
 	GList *links;
+	GHashTable *link_index; /* rel to a GList of links; built on demand, and NULL if it's out of date */
 	GList *authors;
 };
 
@@ -148,6 +149,8 @@ gdata_entry_finalize (GObject *object)
 	g_list_foreach (priv->categories, (GFunc) gdata_category_free, NULL);
 	g_list_free (priv->categories);
 	g_free (priv->content);
+	if (priv->link_index != NULL)
+		g_hash_table_destroy (priv->link_index);
 	g_list_foreach (priv->links, (GFunc) gdata_link_free, NULL);
 	g_list_free (priv->links);
 	g_list_foreach (priv->authors, (GFunc) gdata_author_free, NULL);
@@ -244,14 +247,11 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 
 	if (xmlStrcmp (node->name, (xmlChar*) "title") == 0) {
 		/* atom:title */
-		xmlChar *title = xmlNodeListGetString (doc, node->children, TRUE);
+		gchar *title = gdata_parser_get_content (node);
 
 		/* Title can be empty */
-		if (title == NULL)
-			gdata_entry_set_title (self, "");
-		else
-			gdata_entry_set_title (self, (gchar*) title);
-		xmlFree (title);
+		g_free (self->priv->title);
+		self->priv->title = (title == NULL) ? g_strdup ("") : title;
 	} else if (xmlStrcmp (node->name, (xmlChar*) "id") == 0) {
 		/* atom:id */
 		xmlFree (self->priv->id);
@@ -261,7 +261,7 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 		xmlChar *updated;
 
 		updated = xmlNodeListGetString (doc, node->children, TRUE);
-		if (g_time_val_from_iso8601 ((gchar*) updated, &(self->priv->updated)) == FALSE) {
+		if (gdata_parser_time_val_from_iso8601 ((gchar*) updated, &(self->priv->updated)) == FALSE) {
 			/* Error */
 			gdata_parser_error_not_iso8601_format (node, (gchar*) updated, error);
 			xmlFree (updated);
@@ -273,7 +273,7 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 		xmlChar *published;
 
 		published = xmlNodeListGetString (doc, node->children, TRUE);
-		if (g_time_val_from_iso8601 ((gchar*) published, &(self->priv->published)) == FALSE) {
+		if (gdata_parser_time_val_from_iso8601 ((gchar*) published, &(self->priv->published)) == FALSE) {
 			/* Error */
 			gdata_parser_error_not_iso8601_format (node, (gchar*) published, error);
 			xmlFree (published);
@@ -282,84 +282,66 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 		xmlFree (published);
 	} else if (xmlStrcmp (node->name, (xmlChar*) "category") == 0) {
 		/* atom:category */
-		xmlChar *scheme, *term, *label;
 		GDataCategory *category;
 
-		scheme = xmlGetProp (node, (xmlChar*) "scheme");
-		term = xmlGetProp (node, (xmlChar*) "term");
-		label = xmlGetProp (node, (xmlChar*) "label");
-
-		category = gdata_category_new ((gchar*) term, (gchar*) scheme, (gchar*) label);
+		/* The category takes ownership of the strings */
+		category = _gdata_category_new_take (gdata_parser_get_property (node, "term"), gdata_parser_get_property (node, "scheme"),
+						     gdata_parser_get_property (node, "label"));
 		self->priv->categories = g_list_prepend (self->priv->categories, category);
-
-		xmlFree (scheme);
-		xmlFree (term);
-		xmlFree (label);
 	} else if (xmlStrcmp (node->name, (xmlChar*) "content") == 0) {
 		/* atom:content */
-		xmlChar *content = xmlNodeListGetString (doc, node->children, TRUE);
+		gchar *content = gdata_parser_get_content (node);
 		if (content == NULL)
-			content = xmlGetProp (node, (xmlChar*) "src");
-		gdata_entry_set_content (self, (gchar*) content);
-		xmlFree (content);
+			content = gdata_parser_get_property (node, "src");
+
+		g_free (self->priv->content);
+		self->priv->content = content;
 	} else if (xmlStrcmp (node->name, (xmlChar*) "link") == 0) {
 		/* atom:link */
-		xmlChar *href, *rel, *type, *hreflang, *title, *length;
+		gchar *length;
 		gint length_int;
 		GDataLink *link;
 
-		href = xmlGetProp (node, (xmlChar*) "href");
-		rel = xmlGetProp (node, (xmlChar*) "rel");
-		type = xmlGetProp (node, (xmlChar*) "type");
-		hreflang = xmlGetProp (node, (xmlChar*) "hreflang");
-		title = xmlGetProp (node, (xmlChar*) "title");
-		length = xmlGetProp (node, (xmlChar*) "length");
-
+		length = gdata_parser_get_property (node, "length");
 		if (length == NULL)
 			length_int = -1;
 		else
-			length_int = strtoul ((gchar*) length, NULL, 10);
+			length_int = strtoul (length, NULL, 10);
+		g_free (length);
 
-		link = gdata_link_new ((gchar*) href, (gchar*) rel, (gchar*) type, (gchar*) hreflang, (gchar*) title, length_int);
+		/* The link takes ownership of the strings */
+		link = _gdata_link_new_take (gdata_parser_get_property (node, "href"), gdata_parser_get_property (node, "rel"),
+					     gdata_parser_get_property (node, "type"), gdata_parser_get_property (node, "hreflang"),
+					     gdata_parser_get_property (node, "title"), length_int);
 		self->priv->links = g_list_prepend (self->priv->links, link);
-
-		xmlFree (href);
-		xmlFree (rel);
-		xmlFree (type);
-		xmlFree (hreflang);
-		xmlFree (title);
-		xmlFree (length);
 	} else if (xmlStrcmp (node->name, (xmlChar*) "author") == 0) {
 		/* atom:author */
 		GDataAuthor *author;
 		xmlNode *author_node;
-		xmlChar *name = NULL, *uri = NULL, *email = NULL;
+		gchar *name = NULL, *uri = NULL, *email = NULL;
 
 		author_node = node->children;
 		while (author_node != NULL) {
 			if (xmlStrcmp (author_node->name, (xmlChar*) "name") == 0) {
-				name = xmlNodeListGetString (doc, author_node->children, TRUE);
+				name = gdata_parser_get_content (author_node);
 			} else if (xmlStrcmp (author_node->name, (xmlChar*) "uri") == 0) {
-				uri = xmlNodeListGetString (doc, author_node->children, TRUE);
+				uri = gdata_parser_get_content (author_node);
 			} else if (xmlStrcmp (author_node->name, (xmlChar*) "email") == 0) {
-				email = xmlNodeListGetString (doc, author_node->children, TRUE);
+				email = gdata_parser_get_content (author_node);
 			} else {
 				gdata_parser_error_unhandled_element (author_node, error);
-				xmlFree (name);
-				xmlFree (uri);
-				xmlFree (email);
+				g_free (name);
+				g_free (uri);
+				g_free (email);
 				return FALSE;
 			}
 
 			author_node = author_node->next;
 		}
 
-		author = gdata_author_new ((gchar*) name, (gchar*) uri, (gchar*) email);
+		/* The author takes ownership of the strings */
+		author = _gdata_author_new_take (name, uri, email);
 		self->priv->authors = g_list_prepend (self->priv->authors, author);
-
-		xmlFree (name);
-		xmlFree (uri);
-		xmlFree (email);
 	} else if (GDATA_PARSABLE_CLASS (gdata_entry_parent_class)->parse_xml (parsable, doc, node, user_data, error) == FALSE) {
 		/* Error! */
 		return FALSE;
@@ -414,15 +396,14 @@ real_get_xml (GDataEntry *self, GString *xml_string)
 		g_string_append_printf (xml_string, "<id>%s</id>", priv->id);
 
 	if (priv->updated.tv_sec != 0 || priv->updated.tv_usec != 0) {
-		gchar *updated = g_time_val_to_iso8601 (&(priv->updated));
-		g_string_append_printf (xml_string, "<updated>%s</updated>", updated);
-		g_free (updated);
+		gchar updated[GDATA_PARSER_ISO8601_BUFFER_SIZE];
+		g_string_append_printf (xml_string, "<updated>%s</updated>", gdata_parser_iso8601_from_time_val (&(priv->updated), updated));
 	}
 
 	if (priv->published.tv_sec != 0 || priv->published.tv_usec != 0) {
-		gchar *published = g_time_val_to_iso8601 (&(priv->published));
-		g_string_append_printf (xml_string, "<published>%s</published>", published);
-		g_free (published);
+		gchar published[GDATA_PARSER_ISO8601_BUFFER_SIZE];
+		g_string_append_printf (xml_string, "<published>%s</published>",
+					gdata_parser_iso8601_from_time_val (&(priv->published), published));
 	}
 
 	if (priv->content != NULL) {
@@ -718,16 +699,24 @@ gdata_entry_add_link (GDataEntry *self, GDataLink *link)
 	g_return_if_fail (GDATA_IS_ENTRY (self));
 	g_return_if_fail (link != NULL);
 
-	if (g_list_find_custom (self->priv->links, link, (GCompareFunc) gdata_link_compare) == NULL)
-		self->priv->links = g_list_prepend (self->priv->links, link);
-	else
+	if (g_list_find_custom (self->priv->links, link, (GCompareFunc) gdata_link_compare) != NULL) {
 		gdata_link_free (link);
+		return;
+	}
+
+	self->priv->links = g_list_prepend (self->priv->links, link);
+
+	if (self->priv->link_index != NULL)
+		g_hash_table_destroy (self->priv->link_index);
+	self->priv->link_index = NULL;
 }
 
-static gint
-link_compare_cb (const GDataLink *link, const gchar *rel)
+static GHashTable *
+get_link_index (GDataEntryPrivate *priv)
 {
-	return strcmp (link->rel, rel);
+	if (priv->link_index == NULL)
+		priv->link_index = _gdata_link_index_new (priv->links);
+	return priv->link_index;
 }
 
 /**
@@ -744,15 +733,36 @@ link_compare_cb (const GDataLink *link, const gchar *rel)
 GDataLink *
 gdata_entry_look_up_link (GDataEntry *self, const gchar *rel)
 {
-	GList *element;
+	GList *links;
 
 	g_return_val_if_fail (GDATA_IS_ENTRY (self), NULL);
 	g_return_val_if_fail (rel != NULL, NULL);
 
-	element = g_list_find_custom (self->priv->links, rel, (GCompareFunc) link_compare_cb);
-	if (element == NULL)
+	links = g_hash_table_lookup (get_link_index (self->priv), rel);
+	if (links == NULL)
 		return NULL;
-	return (GDataLink*) (element->data);
+	return (GDataLink*) (links->data);
+}
+
+/**
+ * gdata_entry_look_up_links:
+ * @self: a #GDataEntry
+ * @rel: the value of the <structfield>rel</structfield> attribute of the desired links
+ *
+ * Looks up all the links with the given <structfield>rel</structfield> value from the list of links in the entry, in the same order as
+ * they appear in the entry. The first link in the list is the one returned by gdata_entry_look_up_link().
+ *
+ * Return value: a #GList of #GDataLink<!-- -->s, or %NULL if none were found; free the list with g_list_free(), but do not free the links
+ *
+ * Since: 0.4.0
+ **/
+GList *
+gdata_entry_look_up_links (GDataEntry *self, const gchar *rel)
+{
+	g_return_val_if_fail (GDATA_IS_ENTRY (self), NULL);
+	g_return_val_if_fail (rel != NULL, NULL);
+
+	return g_list_copy (g_hash_table_lookup (get_link_index (self->priv), rel));
 }
 
 /**
@@ -0,0 +1,733 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2009 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-feed-iterator
+ * @short_description: GData feed iterator object
+ * @stability: Unstable
+ * @include: gdata/gdata-feed-iterator.h
+ *
+ * #GDataFeedIterator returns the entries of a paginated feed one at a time, requesting each page of the feed from the server in turn by
+ * following the "next" link of the page before it. This saves running the query, calling gdata_query_next_page() and running it again for
+ * each page.
+ *
+ * Pages are requested before they're needed: as soon as the "next" link of the last page requested has been received (which is usually
+ * well before the rest of that page), the page after it is requested, until #GDataFeedIterator:prefetch-depth pages are waiting behind the
+ * page whose entries are currently being returned. This means the network isn't left idle while the entries of each page are processed.
+ *
+ * Entries are returned by gdata_feed_iterator_next(), or asynchronously by gdata_feed_iterator_next_async(). Each returns %NULL once
+ * all the entries in the feed have been returned.
+ *
+ * Since: 0.4.0
+ **/
+
+#include <config.h>
+#include <glib.h>
+
+#include "gdata-feed-iterator.h"
+#include "gdata-private.h"
+
+/* A page of the feed which has been requested. Each page which is still being received holds a reference to the iterator. */
+typedef struct {
+	GDataFeedIterator *iterator;
+	gboolean finished;
+	gboolean next_uri_known;
+
+	/* Only set once finished is TRUE */
+	GDataFeed *feed;
+	GError *error;
+} Page;
+
+/* A call to gdata_feed_iterator_next_async() which is waiting for its entry */
+typedef struct {
+	GSimpleAsyncResult *result;
+	GCancellable *cancellable;
+} Waiter;
+
+static void gdata_feed_iterator_dispose (GObject *object);
+static void gdata_feed_iterator_finalize (GObject *object);
+static void gdata_feed_iterator_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_feed_iterator_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+struct _GDataFeedIteratorPrivate {
+	GDataService *service;
+	gchar *feed_uri;
+	GDataQuery *query;
+	GType entry_type;
+	guint prefetch_depth;
+
+	/* Everything below is protected by the mutex, since pages are received in the I/O thread */
+	GMutex *mutex;
+	GCond *cond;
+
+	gboolean started;
+	GQueue *pages; /* the pages requested so far which haven't been used up yet, in order; the head is the one being returned from */
+	guint entry_i; /* index of the next entry to return from the head page */
+	gchar *next_uri; /* the URI of the page after the last one requested, if it's known and hasn't been requested yet */
+	GQueue *waiters;
+	GMainContext *context; /* the thread-default context of the thread which started the iteration, for progress callbacks */
+};
+
+enum {
+	PROP_SERVICE = 1,
+	PROP_FEED_URI,
+	PROP_QUERY,
+	PROP_ENTRY_TYPE,
+	PROP_PREFETCH_DEPTH
+};
+
+G_DEFINE_TYPE (GDataFeedIterator, gdata_feed_iterator, G_TYPE_OBJECT)
+#define GDATA_FEED_ITERATOR_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GDATA_TYPE_FEED_ITERATOR, GDataFeedIteratorPrivate))
+
+static void
+gdata_feed_iterator_class_init (GDataFeedIteratorClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataFeedIteratorPrivate));
+
+	gobject_class->get_property = gdata_feed_iterator_get_property;
+	gobject_class->set_property = gdata_feed_iterator_set_property;
+	gobject_class->dispose = gdata_feed_iterator_dispose;
+	gobject_class->finalize = gdata_feed_iterator_finalize;
+
+	/**
+	 * GDataFeedIterator:service:
+	 *
+	 * The #GDataService the feed's pages are requested from.
+	 *
+	 * Since: 0.4.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_SERVICE,
+				g_param_spec_object ("service",
+					"Service", "The service the feed's pages are requested from.",
+					GDATA_TYPE_SERVICE,
+					G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataFeedIterator:feed-uri:
+	 *
+	 * The URI of the feed to iterate over, including the host name and protocol.
+	 *
+	 * Since: 0.4.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_FEED_URI,
+				g_param_spec_string ("feed-uri",
+					"Feed URI", "The URI of the feed to iterate over.",
+					NULL,
+					G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataFeedIterator:query:
+	 *
+	 * The #GDataQuery used to build the URI of the feed's first page, or %NULL. Its flags and batch progress callback are used for every page,
+	 * but it isn't modified.
+	 *
+	 * Since: 0.4.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_QUERY,
+				g_param_spec_object ("query",
+					"Query", "The query used to build the URI of the feed's first page.",
+					GDATA_TYPE_QUERY,
+					G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataFeedIterator:entry-type:
+	 *
+	 * The #GType of the #GDataEntry<!-- -->s to build from the feed.
+	 *
+	 * Since: 0.4.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_ENTRY_TYPE,
+				g_param_spec_gtype ("entry-type",
+					"Entry type", "The type of the entries to build from the feed.",
+					GDATA_TYPE_ENTRY,
+					G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataFeedIterator:prefetch-depth:
+	 *
+	 * The number of pages to request ahead of the page whose entries are currently being returned. If it's %0, each page is only requested
+	 * once the entries of the page before it have all been returned.
+	 *
+	 * Since: 0.4.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_PREFETCH_DEPTH,
+				g_param_spec_uint ("prefetch-depth",
+					"Prefetch depth", "The number of pages to request ahead of the current one.",
+					0, G_MAXUINT, 1,
+					G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gdata_feed_iterator_init (GDataFeedIterator *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_FEED_ITERATOR, GDataFeedIteratorPrivate);
+	self->priv->pages = g_queue_new ();
+	self->priv->waiters = g_queue_new ();
+
+	/* Without threads, pages are received in the main thread, so there's nothing to protect against */
+	if (g_thread_supported () == TRUE) {
+		self->priv->mutex = g_mutex_new ();
+		self->priv->cond = g_cond_new ();
+	}
+}
+
+static void
+page_free (Page *page)
+{
+	if (page->feed != NULL)
+		g_object_unref (page->feed);
+	if (page->error != NULL)
+		g_error_free (page->error);
+
+	g_slice_free (Page, page);
+}
+
+static void
+gdata_feed_iterator_dispose (GObject *object)
+{
+	GDataFeedIteratorPrivate *priv = GDATA_FEED_ITERATOR_GET_PRIVATE (object);
+
+	if (priv->service != NULL)
+		g_object_unref (priv->service);
+	priv->service = NULL;
+
+	if (priv->query != NULL)
+		g_object_unref (priv->query);
+	priv->query = NULL;
+
+	/* Pages which are still being received, and waiting asynchronous calls, hold references to the iterator, so all the pages left by now
+	 * have finished */
+	g_queue_foreach (priv->pages, (GFunc) page_free, NULL);
+	g_queue_clear (priv->pages);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_feed_iterator_parent_class)->dispose (object);
+}
+
+static void
+gdata_feed_iterator_finalize (GObject *object)
+{
+	GDataFeedIteratorPrivate *priv = GDATA_FEED_ITERATOR_GET_PRIVATE (object);
+
+	g_free (priv->feed_uri);
+	g_free (priv->next_uri);
+	g_queue_free (priv->pages);
+	g_queue_free (priv->waiters);
+
+	if (priv->context != NULL)
+		g_main_context_unref (priv->context);
+
+	if (priv->mutex != NULL) {
+		g_mutex_free (priv->mutex);
+		g_cond_free (priv->cond);
+	}
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_feed_iterator_parent_class)->finalize (object);
+}
+
+static void
+gdata_feed_iterator_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataFeedIteratorPrivate *priv = GDATA_FEED_ITERATOR_GET_PRIVATE (object);
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			g_value_set_object (value, priv->service);
+			break;
+		case PROP_FEED_URI:
+			g_value_set_string (value, priv->feed_uri);
+			break;
+		case PROP_QUERY:
+			g_value_set_object (value, priv->query);
+			break;
+		case PROP_ENTRY_TYPE:
+			g_value_set_gtype (value, priv->entry_type);
+			break;
+		case PROP_PREFETCH_DEPTH:
+			g_value_set_uint (value, priv->prefetch_depth);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_feed_iterator_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataFeedIteratorPrivate *priv = GDATA_FEED_ITERATOR_GET_PRIVATE (object);
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			priv->service = g_value_dup_object (value);
+			break;
+		case PROP_FEED_URI:
+			priv->feed_uri = g_value_dup_string (value);
+			break;
+		case PROP_QUERY:
+			priv->query = g_value_dup_object (value);
+			break;
+		case PROP_ENTRY_TYPE:
+			priv->entry_type = g_value_get_gtype (value);
+			break;
+		case PROP_PREFETCH_DEPTH:
+			priv->prefetch_depth = g_value_get_uint (value);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+/**
+ * gdata_feed_iterator_new:
+ * @service: the #GDataService to request the feed's pages from
+ * @feed_uri: the feed URI to query, including the host name and protocol
+ * @query: a #GDataQuery with the query parameters, or %NULL
+ * @entry_type: a #GType for the #GDataEntry<!-- -->s to build from the XML
+ * @prefetch_depth: the number of pages to request ahead of the current one
+ *
+ * Creates a new #GDataFeedIterator which returns all the entries in the @feed_uri feed, as queried with @query. No requests are made until
+ * the first entry is asked for.
+ *
+ * @query is only used to build the URI of the first page, and for its #GDataQuery:flags and batch progress callback (see
+ * gdata_query_set_batch_progress_callback()); it isn't updated with the ETag or pagination URIs of the pages. If its flags include
+ * %GDATA_QUERY_FLAGS_DISCARD_ENTRIES and it has a batch progress callback, the entries are only passed to the callback, and the iterator
+ * returns none of them. The batch progress callback is called for every page in the thread-default main context of the thread which first
+ * asks for an entry, unless the flags include %GDATA_QUERY_FLAGS_SYNCHRONOUS_PROGRESS.
+ *
+ * A @prefetch_depth of %1 keeps the next page downloading while the entries of the current page are being processed.
+ *
+ * Return value: a new #GDataFeedIterator; unref with g_object_unref()
+ *
+ * Since: 0.4.0
+ **/
+GDataFeedIterator *
+gdata_feed_iterator_new (GDataService *service, const gchar *feed_uri, GDataQuery *query, GType entry_type, guint prefetch_depth)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), NULL);
+	g_return_val_if_fail (feed_uri != NULL, NULL);
+	g_return_val_if_fail (query == NULL || GDATA_IS_QUERY (query), NULL);
+	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY) == TRUE, NULL);
+
+	return g_object_new (GDATA_TYPE_FEED_ITERATOR,
+			     "service", service,
+			     "feed-uri", feed_uri,
+			     "query", query,
+			     "entry-type", entry_type,
+			     "prefetch-depth", prefetch_depth,
+			     NULL);
+}
+
+/**
+ * gdata_feed_iterator_get_service:
+ * @self: a #GDataFeedIterator
+ *
+ * Gets the #GDataFeedIterator:service property.
+ *
+ * Return value: the service the feed's pages are requested from
+ *
+ * Since: 0.4.0
+ **/
+GDataService *
+gdata_feed_iterator_get_service (GDataFeedIterator *self)
+{
+	g_return_val_if_fail (GDATA_IS_FEED_ITERATOR (self), NULL);
+	return self->priv->service;
+}
+
+/**
+ * gdata_feed_iterator_get_feed_uri:
+ * @self: a #GDataFeedIterator
+ *
+ * Gets the #GDataFeedIterator:feed-uri property.
+ *
+ * Return value: the URI of the feed
+ *
+ * Since: 0.4.0
+ **/
+const gchar *
+gdata_feed_iterator_get_feed_uri (GDataFeedIterator *self)
+{
+	g_return_val_if_fail (GDATA_IS_FEED_ITERATOR (self), NULL);
+	return self->priv->feed_uri;
+}
+
+/**
+ * gdata_feed_iterator_get_query:
+ * @self: a #GDataFeedIterator
+ *
+ * Gets the #GDataFeedIterator:query property.
+ *
+ * Return value: the iterator's query, or %NULL
+ *
+ * Since: 0.4.0
+ **/
+GDataQuery *
+gdata_feed_iterator_get_query (GDataFeedIterator *self)
+{
+	g_return_val_if_fail (GDATA_IS_FEED_ITERATOR (self), NULL);
+	return self->priv->query;
+}
+
+/**
+ * gdata_feed_iterator_get_entry_type:
+ * @self: a #GDataFeedIterator
+ *
+ * Gets the #GDataFeedIterator:entry-type property.
+ *
+ * Return value: the type of the entries built from the feed
+ *
+ * Since: 0.4.0
+ **/
+GType
+gdata_feed_iterator_get_entry_type (GDataFeedIterator *self)
+{
+	g_return_val_if_fail (GDATA_IS_FEED_ITERATOR (self), G_TYPE_INVALID);
+	return self->priv->entry_type;
+}
+
+/**
+ * gdata_feed_iterator_get_prefetch_depth:
+ * @self: a #GDataFeedIterator
+ *
+ * Gets the #GDataFeedIterator:prefetch-depth property.
+ *
+ * Return value: the number of pages requested ahead of the current one
+ *
+ * Since: 0.4.0
+ **/
+guint
+gdata_feed_iterator_get_prefetch_depth (GDataFeedIterator *self)
+{
+	g_return_val_if_fail (GDATA_IS_FEED_ITERATOR (self), 0);
+	return self->priv->prefetch_depth;
+}
+
+static void page_next_uri_cb (const gchar *next_uri, Page *page);
+static void page_finished_cb (GDataService *service, GDataFeed *feed, GError *error, Page *page);
+
+/* Requests the next page of the feed if its URI is known and there's room for it within the prefetch depth. Called with the mutex held. */
+static void
+request_pages (GDataFeedIterator *self)
+{
+	GDataFeedIteratorPrivate *priv = self->priv;
+	Page *page;
+	gchar *page_uri;
+
+	if (priv->next_uri == NULL || g_queue_get_length (priv->pages) > priv->prefetch_depth)
+		return;
+
+	page = g_slice_new0 (Page);
+	page->iterator = g_object_ref (self);
+	g_queue_push_tail (priv->pages, page);
+
+	page_uri = priv->next_uri;
+	priv->next_uri = NULL;
+
+	_gdata_service_query_page_async (priv->service, page_uri, priv->query, priv->entry_type, priv->context,
+					 (GDataFeedNextUriFunc) page_next_uri_cb, (GDataServiceQueryPageCallback) page_finished_cb, page);
+	g_free (page_uri);
+}
+
+/* Called with the mutex held */
+static void
+start (GDataFeedIterator *self)
+{
+	GDataFeedIteratorPrivate *priv = self->priv;
+
+	if (priv->started == TRUE)
+		return;
+
+	priv->started = TRUE;
+
+	/* Later pages are requested from the I/O thread, so the batch progress callback's context has to be remembered for them */
+	priv->context = g_main_context_get_thread_default ();
+	if (priv->context != NULL)
+		g_main_context_ref (priv->context);
+
+	priv->next_uri = (priv->query != NULL) ? gdata_query_get_query_uri (priv->query, priv->feed_uri) : g_strdup (priv->feed_uri);
+	request_pages (self);
+}
+
+/* Gets the next entry from the pages which have been received, if possible. If the iteration's finished, %TRUE is returned with @entry set to
+ * the next entry (or %NULL at the end of the feed) or @error set. If the page the entry is on hasn't been received yet, %FALSE is returned.
+ * Called with the mutex held. */
+static gboolean
+take_next_entry (GDataFeedIterator *self, GDataEntry **entry, GError **error)
+{
+	GDataFeedIteratorPrivate *priv = self->priv;
+	Page *page;
+
+	*entry = NULL;
+
+	while ((page = g_queue_peek_head (priv->pages)) != NULL) {
+		if (page->finished == FALSE)
+			return FALSE;
+
+		/* Once a page has failed, the iteration stops there */
+		if (page->error != NULL) {
+			g_propagate_error (error, g_error_copy (page->error));
+			return TRUE;
+		}
+
+		/* Entries which fail to be built are skipped */
+		while (page->feed != NULL && priv->entry_i < gdata_feed_get_n_entries (page->feed)) {
+			*entry = gdata_feed_get_entry_at (page->feed, priv->entry_i++);
+			if (*entry != NULL) {
+				g_object_ref (*entry);
+				return TRUE;
+			}
+		}
+
+		/* The page has been used up, which makes room for another to be requested */
+		page_free (g_queue_pop_head (priv->pages));
+		priv->entry_i = 0;
+		request_pages (self);
+	}
+
+	/* There are no more pages */
+	return TRUE;
+}
+
+/* Completes as many waiting asynchronous calls as possible, in order. Called with the mutex held. */
+static void
+complete_waiters (GDataFeedIterator *self)
+{
+	Waiter *waiter;
+
+	while ((waiter = g_queue_peek_head (self->priv->waiters)) != NULL) {
+		GDataEntry *entry = NULL;
+		GError *error = NULL;
+
+		if (g_cancellable_set_error_if_cancelled (waiter->cancellable, &error) == FALSE && take_next_entry (self, &entry, &error) == FALSE)
+			break;
+
+		g_queue_pop_head (self->priv->waiters);
+
+		if (error != NULL) {
+			g_simple_async_result_set_from_error (waiter->result, error);
+			g_error_free (error);
+		} else if (entry != NULL) {
+			g_simple_async_result_set_op_res_gpointer (waiter->result, entry, (GDestroyNotify) g_object_unref);
+		}
+
+		g_simple_async_result_complete_in_idle (waiter->result);
+
+		g_object_unref (waiter->result);
+		if (waiter->cancellable != NULL)
+			g_object_unref (waiter->cancellable);
+		g_slice_free (Waiter, waiter);
+	}
+}
+
+/* Called in the I/O thread as soon as the page's "next" link has been parsed */
+static void
+page_next_uri_cb (const gchar *next_uri, Page *page)
+{
+	GDataFeedIteratorPrivate *priv = page->iterator->priv;
+
+	g_mutex_lock (priv->mutex);
+
+	/* Only the last page requested can be missing its next URI, so the slot is free */
+	if (page->next_uri_known == FALSE) {
+		page->next_uri_known = TRUE;
+		g_free (priv->next_uri);
+		priv->next_uri = g_strdup (next_uri);
+		request_pages (page->iterator);
+	}
+
+	g_mutex_unlock (priv->mutex);
+}
+
+/* Called in the I/O thread once the page has been received */
+static void
+page_finished_cb (GDataService *service, GDataFeed *feed, GError *error, Page *page)
+{
+	GDataFeedIterator *self = page->iterator;
+	GDataFeedIteratorPrivate *priv = self->priv;
+
+	g_mutex_lock (priv->mutex);
+
+	page->feed = feed;
+	page->error = error;
+	page->finished = TRUE;
+
+	/* The "next" link would've been reported by now if the page had one, so if it didn't, it's the last page */
+	page->next_uri_known = TRUE;
+
+	complete_waiters (self);
+	g_cond_broadcast (priv->cond);
+
+	g_mutex_unlock (priv->mutex);
+
+	/* The page no longer needs the iterator */
+	g_object_unref (self);
+}
+
+static void
+cancelled_cb (GCancellable *cancellable, GDataFeedIterator *self)
+{
+	/* Wake up gdata_feed_iterator_next() so that it notices */
+	g_mutex_lock (self->priv->mutex);
+	g_cond_broadcast (self->priv->cond);
+	g_mutex_unlock (self->priv->mutex);
+}
+
+/**
+ * gdata_feed_iterator_next:
+ * @self: a #GDataFeedIterator
+ * @cancellable: optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Returns the next entry in the feed, blocking until the page it's on has been received if necessary. Once all the entries have been returned,
+ * %NULL is returned without @error being set.
+ *
+ * If a page of the feed can't be received or parsed, the error is returned as it would be from gdata_service_query(), and the iteration stops:
+ * subsequent calls return the same error.
+ *
+ * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
+ * If the operation was cancelled, the error %G_IO_ERROR_CANCELLED will be returned. The pages being received aren't affected, so iteration can
+ * be resumed by calling this function again.
+ *
+ * Return value: the next #GDataEntry, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.4.0
+ **/
+GDataEntry *
+gdata_feed_iterator_next (GDataFeedIterator *self, GCancellable *cancellable, GError **error)
+{
+	GDataFeedIteratorPrivate *priv;
+	GDataEntry *entry = NULL;
+	GError *child_error = NULL;
+	gulong cancelled_signal = 0;
+
+	g_return_val_if_fail (GDATA_IS_FEED_ITERATOR (self), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+
+	priv = self->priv;
+
+	if (cancellable != NULL)
+		cancelled_signal = g_cancellable_connect (cancellable, (GCallback) cancelled_cb, self, NULL);
+
+	g_mutex_lock (priv->mutex);
+
+	start (self);
+
+	while (g_cancellable_set_error_if_cancelled (cancellable, &child_error) == FALSE && take_next_entry (self, &entry, &child_error) == FALSE) {
+		if (g_thread_supported () == TRUE) {
+			g_cond_wait (priv->cond, priv->mutex);
+		} else {
+			/* The pages are received in the default main context */
+			g_main_context_iteration (NULL, TRUE);
+		}
+	}
+
+	g_mutex_unlock (priv->mutex);
+
+	/* This waits for cancelled_cb() to return if it's running in another thread */
+	if (cancelled_signal != 0)
+		g_cancellable_disconnect (cancellable, cancelled_signal);
+
+	if (child_error != NULL) {
+		g_propagate_error (error, child_error);
+		return NULL;
+	}
+
+	return entry;
+}
+
+/**
+ * gdata_feed_iterator_next_async:
+ * @self: a #GDataFeedIterator
+ * @cancellable: optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the entry is available
+ * @user_data: data to pass to the @callback function
+ *
+ * Gets the next entry in the feed asynchronously. If several calls are made before the first has finished, their callbacks are called in the
+ * same order with successive entries.
+ *
+ * For more details, see gdata_feed_iterator_next(), which is the synchronous version of this function. If @cancellable is triggered, the
+ * operation finishes with %G_IO_ERROR_CANCELLED once the entry's page has been received, without the entry being used up.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_feed_iterator_next_finish() to get the results of the
+ * operation.
+ *
+ * Since: 0.4.0
+ **/
+void
+gdata_feed_iterator_next_async (GDataFeedIterator *self, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+	Waiter *waiter;
+
+	g_return_if_fail (GDATA_IS_FEED_ITERATOR (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	/* The result holds a reference to the iterator until it's completed */
+	waiter = g_slice_new (Waiter);
+	waiter->result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_feed_iterator_next_async);
+	waiter->cancellable = (cancellable != NULL) ? g_object_ref (cancellable) : NULL;
+
+	g_mutex_lock (self->priv->mutex);
+
+	start (self);
+	g_queue_push_tail (self->priv->waiters, waiter);
+	complete_waiters (self);
+
+	g_mutex_unlock (self->priv->mutex);
+}
+
+/**
+ * gdata_feed_iterator_next_finish:
+ * @self: a #GDataFeedIterator
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous operation started with gdata_feed_iterator_next_async().
+ *
+ * Return value: the next #GDataEntry, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.4.0
+ **/
+GDataEntry *
+gdata_feed_iterator_next_finish (GDataFeedIterator *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+	GDataEntry *entry;
+
+	g_return_val_if_fail (GDATA_IS_FEED_ITERATOR (self), NULL);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), NULL);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_feed_iterator_next_async);
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return NULL;
+
+	/* The entry will be NULL at the end of the feed */
+	entry = g_simple_async_result_get_op_res_gpointer (result);
+	if (entry != NULL)
+		return g_object_ref (entry);
+
+	return NULL;
+}
@@ -36,6 +36,7 @@
 #include <glib/gi18n-lib.h>
 #include <libxml/parser.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "gdata-feed.h"
 #include "gdata-entry.h"
@@ -52,7 +53,10 @@ static gboolean parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node,
 static gboolean post_parse_xml (GDataParsable *parsable, gpointer user_data, GError **error);
 
 struct _GDataFeedPrivate {
-	GList *entries;
+	GPtrArray *entries;
+	GList *entries_list; /* cached for gdata_feed_get_entries(); NULL if it's out of date */
+	GHashTable *entry_index; /* entry ID to GUINT_TO_POINTER (position in entries + 1); built on demand, and NULL if it's out of date */
+	guint n_discarded_entries; /* entries passed to the progress callbacks and then dropped (see GDATA_QUERY_FLAGS_DISCARD_ENTRIES) */
 	gchar *title;
 	gchar *subtitle;
 	gchar *id;
@@ -61,11 +65,19 @@ struct _GDataFeedPrivate {
 	GList *categories;
 	gchar *logo;
 	GList *links;
+	GHashTable *link_index; /* rel to a GList of links; built on demand */
 	GList *authors;
 	GDataGenerator *generator;
 	guint items_per_page;
 	guint start_index;
 	guint total_results;
+
+	/* Lazily-built entries (see GDATA_QUERY_FLAGS_LAZY_ENTRIES). If lazy_nodes is non-NULL, it's the same length as entries, and each entry
+	 * which hasn't been built yet is NULL in entries, with its unparsed <entry> node in lazy_nodes. The nodes belong to the documents in
+	 * lazy_docs. Entries which couldn't be built are NULL in both, so that the indices of the others don't change. */
+	GPtrArray *lazy_nodes;
+	GSList *lazy_docs;
+	GType lazy_entry_type;
 };
 
 enum {
@@ -248,6 +260,7 @@ static void
 gdata_feed_init (GDataFeed *self)
 {
 	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_FEED, GDataFeedPrivate);
+	self->priv->entries = g_ptr_array_new ();
 }
 
 static void
@@ -256,20 +269,55 @@ gdata_feed_dispose (GObject *object)
 	GDataFeedPrivate *priv = GDATA_FEED_GET_PRIVATE (object);
 
 	if (priv->entries != NULL) {
-		g_list_foreach (priv->entries, (GFunc) g_object_unref, NULL);
-		g_list_free (priv->entries);
+		guint i;
+
+		/* Entries which were never built are NULL */
+		for (i = 0; i < priv->entries->len; i++) {
+			if (g_ptr_array_index (priv->entries, i) != NULL)
+				g_object_unref (g_ptr_array_index (priv->entries, i));
+		}
+		g_ptr_array_free (priv->entries, TRUE);
 	}
 	priv->entries = NULL;
 
+	g_list_free (priv->entries_list);
+	priv->entries_list = NULL;
+
+	if (priv->entry_index != NULL)
+		g_hash_table_destroy (priv->entry_index);
+	priv->entry_index = NULL;
+
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS (gdata_feed_parent_class)->dispose (object);
 }
 
+static void
+free_lazy_nodes (GDataFeedPrivate *priv)
+{
+	/* The nodes have to be freed before the documents they belong to */
+	if (priv->lazy_nodes != NULL) {
+		guint i;
+
+		for (i = 0; i < priv->lazy_nodes->len; i++) {
+			if (g_ptr_array_index (priv->lazy_nodes, i) != NULL)
+				xmlFreeNode (g_ptr_array_index (priv->lazy_nodes, i));
+		}
+		g_ptr_array_free (priv->lazy_nodes, TRUE);
+		priv->lazy_nodes = NULL;
+	}
+
+	g_slist_foreach (priv->lazy_docs, (GFunc) xmlFreeDoc, NULL);
+	g_slist_free (priv->lazy_docs);
+	priv->lazy_docs = NULL;
+}
+
 static void
 gdata_feed_finalize (GObject *object)
 {
 	GDataFeedPrivate *priv = GDATA_FEED_GET_PRIVATE (object);
 
+	free_lazy_nodes (priv);
+
 	xmlFree (priv->title);
 	xmlFree (priv->subtitle);
 	xmlFree (priv->id);
@@ -277,6 +325,8 @@ gdata_feed_finalize (GObject *object)
 	g_list_foreach (priv->categories, (GFunc) gdata_category_free, NULL);
 	g_list_free (priv->categories);
 	xmlFree (priv->logo);
+	if (priv->link_index != NULL)
+		g_hash_table_destroy (priv->link_index);
 	g_list_foreach (priv->links, (GFunc) gdata_link_free, NULL);
 	g_list_free (priv->links);
 	g_list_foreach (priv->authors, (GFunc) gdata_author_free, NULL);
@@ -330,13 +380,81 @@ gdata_feed_get_property (GObject *object, guint property_id, GValue *value, GPar
 	}
 }
 
+/* Progress callbacks for a feed's entries are queued here by whichever thread parsed them, and delivered in batches by a single source in the
+ * main context which was the thread default when the query was made, rather than each having its own idle source. In synchronous mode,
+ * they're instead called straight away by the parsing thread. */
 typedef struct {
-	GType entry_type;
+	volatile gint ref_count;
+
+	GMainContext *context; /* NULL for the global default context */
+	gboolean synchronous;
+
 	GDataQueryProgressCallback progress_callback;
 	gpointer progress_user_data;
+	GDataQueryBatchProgressCallback batch_progress_callback;
+	gpointer batch_progress_user_data;
+
+	/* Protects the fields below */
+	GStaticMutex mutex;
+	GArray *items; /* ProgressItem, from items_head onwards */
+	guint items_head;
+	gboolean source_pending;
+} ProgressQueue;
+
+typedef struct {
+	GDataEntry *entry;
+	guint entry_key;
+	guint entry_count;
+} ProgressItem;
+
+/* The most entries delivered by each dispatch of a ProgressQueue's source */
+#define MAX_PROGRESS_BATCH_SIZE 64
+
+typedef struct {
+	GType entry_type;
+	ProgressQueue *progress_queue; /* NULL if there are no progress callbacks */
 	guint entry_i;
+
+	/* The key of the first entry in the feed, and whether the progress callback's entry count should cover the whole feed (from
+	 * entry_offset == 0 onwards) rather than just this page of it */
+	guint entry_offset;
+	gboolean whole_feed;
+
+	/* Whether to keep each <entry> node to be parsed when it's first accessed, rather than parsing it straight away; and the stream which
+	 * owns the document the nodes belong to */
+	gboolean lazy;
+	GDataParsableStream *stream;
+
+	/* How unhandled elements in the feed and its entries are kept */
+	GDataParsableUnknownXml unknown_xml;
+
+	/* Whether to drop each entry once it's been queued for the progress callbacks, rather than adding it to the feed */
+	gboolean discard_entries;
+
+	/* Called as soon as the feed's "next" link has been parsed, so the next page can be requested before this one's finished */
+	GDataFeedNextUriFunc next_uri_func;
+	gpointer next_uri_user_data;
+
+	/* Parallel parsing (see GDATA_QUERY_FLAGS_PARALLEL_ENTRIES): the EntryJobs for the entries being parsed on the shared thread pool, in
+	 * feed order, and the number of them which haven't finished yet */
+	GThreadPool *thread_pool;
+	GPtrArray *jobs;
+	guint n_pending_jobs;
+	GMutex *jobs_mutex;
+	GCond *jobs_cond;
 } ParseData;
 
+typedef struct {
+	ParseData *data;
+	xmlNode *node;
+	guint entry_i;
+	guint total_results;
+
+	/* Output */
+	GDataEntry *entry;
+	GError *error;
+} EntryJob;
+
 static gboolean
 pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointer user_data, GError **error)
 {
@@ -347,24 +465,256 @@ pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointe
 	/* Extract the ETag */
 	GDATA_FEED (parsable)->priv->etag = (gchar*) xmlGetProp (root_node, (xmlChar*) "etag");
 
+	/* Lazily-built entries use the feed's policy */
+	_gdata_parsable_set_unknown_xml (parsable, ((ParseData*) user_data)->unknown_xml);
+
 	return TRUE;
 }
 
-typedef struct {
-	GDataQueryProgressCallback progress_callback;
-	gpointer progress_user_data;
-	GDataEntry *entry;
-	guint entry_i;
-	guint total_results;
-} ProgressCallbackData;
+static ProgressQueue *
+progress_queue_new (gboolean synchronous, GDataQueryProgressCallback progress_callback, gpointer progress_user_data,
+		    GDataQueryBatchProgressCallback batch_progress_callback, gpointer batch_progress_user_data)
+{
+	ProgressQueue *self;
+
+	self = g_slice_new0 (ProgressQueue);
+	self->ref_count = 1;
+	self->synchronous = synchronous;
+
+	/* Deliver the callbacks in the context of whichever thread made the query */
+	self->context = g_main_context_get_thread_default ();
+	if (self->context != NULL)
+		g_main_context_ref (self->context);
+
+	self->progress_callback = progress_callback;
+	self->progress_user_data = progress_user_data;
+	self->batch_progress_callback = batch_progress_callback;
+	self->batch_progress_user_data = batch_progress_user_data;
+	g_static_mutex_init (&(self->mutex));
+	self->items = g_array_new (FALSE, FALSE, sizeof (ProgressItem));
+
+	return self;
+}
+
+static ProgressQueue *
+progress_queue_ref (ProgressQueue *self)
+{
+	g_atomic_int_inc (&(self->ref_count));
+	return self;
+}
+
+static void
+progress_queue_unref (ProgressQueue *self)
+{
+	guint i;
+
+	if (g_atomic_int_dec_and_test (&(self->ref_count)) == FALSE)
+		return;
+
+	for (i = self->items_head; i < self->items->len; i++)
+		g_object_unref (g_array_index (self->items, ProgressItem, i).entry);
+	g_array_free (self->items, TRUE);
+	g_static_mutex_free (&(self->mutex));
+	if (self->context != NULL)
+		g_main_context_unref (self->context);
+
+	g_slice_free (ProgressQueue, self);
+}
+
+static void
+progress_queue_call (ProgressQueue *self, ProgressItem *items, guint n_items)
+{
+	guint i;
+
+	/* The items' references to their entries are released */
+	if (self->batch_progress_callback != NULL && n_items > 0) {
+		GDataEntry *entries[MAX_PROGRESS_BATCH_SIZE];
+		guint entry_keys[MAX_PROGRESS_BATCH_SIZE];
+		guint entry_count = 0;
+
+		for (i = 0; i < n_items; i++) {
+			entries[i] = items[i].entry;
+			entry_keys[i] = items[i].entry_key;
+			entry_count = MAX (entry_count, items[i].entry_count);
+		}
+
+		self->batch_progress_callback (entries, entry_keys, n_items, entry_count, self->batch_progress_user_data);
+	}
+
+	for (i = 0; i < n_items; i++) {
+		if (self->progress_callback != NULL)
+			self->progress_callback (items[i].entry, items[i].entry_key, items[i].entry_count, self->progress_user_data);
+		g_object_unref (items[i].entry);
+	}
+}
 
 static gboolean
-progress_callback_idle (ProgressCallbackData *data)
+progress_queue_dispatch_cb (ProgressQueue *self)
+{
+	ProgressItem batch[MAX_PROGRESS_BATCH_SIZE];
+	guint n_items;
+	gboolean more_items;
+
+	/* Take the next batch of items off the queue */
+	g_static_mutex_lock (&(self->mutex));
+
+	n_items = MIN (self->items->len - self->items_head, MAX_PROGRESS_BATCH_SIZE);
+	memcpy (batch, &g_array_index (self->items, ProgressItem, self->items_head), n_items * sizeof (ProgressItem));
+	self->items_head += n_items;
+
+	if (self->items_head == self->items->len) {
+		g_array_set_size (self->items, 0);
+		self->items_head = 0;
+	}
+
+	more_items = (self->items->len > 0) ? TRUE : FALSE;
+	self->source_pending = more_items;
+
+	g_static_mutex_unlock (&(self->mutex));
+
+	progress_queue_call (self, batch, n_items);
+
+	return more_items;
+}
+
+/* This may be called from any thread */
+static void
+progress_queue_push (ProgressQueue *self, GDataEntry *entry, guint entry_key, guint entry_count)
+{
+	ProgressItem item;
+
+	item.entry = g_object_ref (entry);
+	item.entry_key = entry_key;
+	item.entry_count = entry_count;
+
+	g_static_mutex_lock (&(self->mutex));
+
+	/* In synchronous mode, the mutex also stops the callbacks being called from several parsing threads at once */
+	if (self->synchronous == TRUE) {
+		progress_queue_call (self, &item, 1);
+		g_static_mutex_unlock (&(self->mutex));
+		return;
+	}
+
+	g_array_append_val (self->items, item);
+
+	if (self->source_pending == FALSE) {
+		GSource *source;
+
+		/* The source runs at a slightly higher priority than G_PRIORITY_DEFAULT so that, as long as it has entries left, it's dispatched
+		 * before the G_PRIORITY_DEFAULT idle which completes the asynchronous query; that guarantees all the callbacks are made before
+		 * the query's GAsyncReadyCallback */
+		source = g_idle_source_new ();
+		g_source_set_priority (source, G_PRIORITY_DEFAULT - 1);
+		g_source_set_callback (source, (GSourceFunc) progress_queue_dispatch_cb, progress_queue_ref (self),
+				       (GDestroyNotify) progress_queue_unref);
+		g_source_attach (source, self->context);
+		g_source_unref (source);
+
+		self->source_pending = TRUE;
+	}
+
+	g_static_mutex_unlock (&(self->mutex));
+}
+
+
+static guint
+get_progress_total_results (GDataFeed *self, ParseData *data)
+{
+	guint start_index;
+
+	if (data->whole_feed == FALSE)
+		return MIN (self->priv->items_per_page, self->priv->total_results);
+
+	/* total_results counts from start index 1, whereas entry_offset counts from the start of the first page */
+	start_index = MAX (self->priv->start_index, 1);
+	return data->entry_offset + MAX (self->priv->total_results + 1, start_index + data->entry_i + 1) - start_index;
+}
+
+static void
+detach_entry_node (xmlNode *node)
+{
+	xmlNs *ns;
+
+	/* Copy the namespace declarations from the <feed> element onto the <entry>, so that they can still be found (e.g. by xmlGetNsList())
+	 * once it's been unlinked. Any namespaces the entry's nodes use still point to the originals, which live as long as the document. */
+	for (ns = node->parent->nsDef; ns != NULL; ns = ns->next) {
+		if (xmlSearchNs (node->doc, node, ns->prefix) == ns)
+			xmlNewNs (node, ns->href, ns->prefix);
+	}
+
+	xmlUnlinkNode (node);
+}
+
+static void
+entry_job_cb (EntryJob *job, gpointer user_data)
+{
+	ParseData *data = job->data;
+
+	/* Only the job's own subtree of the document is touched here; the nodes are freed by the thread which parsed the feed, since freeing
+	 * them could race with it adding to the document's dictionary */
+	job->entry = GDATA_ENTRY (_gdata_parsable_new_from_xml_node (data->entry_type, "entry", data->unknown_xml, job->node->doc, job->node, NULL,
+									  &(job->error)));
+
+	if (job->entry != NULL && data->progress_queue != NULL)
+		progress_queue_push (data->progress_queue, job->entry, job->entry_i, job->total_results);
+
+	/* The progress queue holds its own reference */
+	if (job->entry != NULL && data->discard_entries == TRUE) {
+		g_object_unref (job->entry);
+		job->entry = NULL;
+	}
+
+	g_mutex_lock (data->jobs_mutex);
+	if (--data->n_pending_jobs == 0)
+		g_cond_broadcast (data->jobs_cond);
+	g_mutex_unlock (data->jobs_mutex);
+}
+
+static gpointer
+entry_thread_pool_init (gpointer user_data)
+{
+	gint max_threads = 4;
+
+	if (g_thread_supported () == FALSE)
+		return NULL;
+
+#ifdef _SC_NPROCESSORS_ONLN
+	max_threads = MAX (sysconf (_SC_NPROCESSORS_ONLN), 1);
+#endif
+
+	return g_thread_pool_new ((GFunc) entry_job_cb, NULL, max_threads, FALSE, NULL);
+}
+
+/* Returns the thread pool shared by all feeds for parallel entry parsing, with one thread per processor; or %NULL if threads aren't
+ * supported, in which case entries are parsed serially */
+static GThreadPool *
+get_entry_thread_pool (void)
+{
+	static GOnce thread_pool_once = G_ONCE_INIT;
+	g_once (&thread_pool_once, entry_thread_pool_init, NULL);
+	return thread_pool_once.retval;
+}
+
+static void
+wait_for_entry_jobs (ParseData *data)
 {
-	data->progress_callback (data->entry, data->entry_i, data->total_results, data->progress_user_data);
-	g_object_unref (data->entry);
-	g_slice_free (ProgressCallbackData, data);
-	return FALSE;
+	g_mutex_lock (data->jobs_mutex);
+	while (data->n_pending_jobs > 0)
+		g_cond_wait (data->jobs_cond, data->jobs_mutex);
+	g_mutex_unlock (data->jobs_mutex);
+}
+
+static void
+entry_job_free (EntryJob *job)
+{
+	xmlFreeNode (job->node);
+	if (job->entry != NULL)
+		g_object_unref (job->entry);
+	if (job->error != NULL)
+		g_error_free (job->error);
+
+	g_slice_free (EntryJob, job);
 }
 
 static gboolean
@@ -379,31 +729,50 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 
 	self = GDATA_FEED (parsable);
 
-	if (xmlStrcmp (node->name, (xmlChar*) "entry") == 0) {
+	if (xmlStrcmp (node->name, (xmlChar*) "entry") == 0 && data->lazy == TRUE) {
+		/* atom:entry; unlinking the node stops it being freed, so it can be parsed later */
+		detach_entry_node (node);
+		if (self->priv->lazy_nodes == NULL)
+			self->priv->lazy_nodes = g_ptr_array_sized_new (MAX (self->priv->items_per_page, 1));
+		g_ptr_array_add (self->priv->lazy_nodes, node);
+		g_ptr_array_add (self->priv->entries, NULL);
+		self->priv->lazy_entry_type = data->entry_type;
+		data->entry_i++;
+	} else if (xmlStrcmp (node->name, (xmlChar*) "entry") == 0 && data->thread_pool != NULL) {
+		/* atom:entry; parse it on the thread pool, and collect it (in order) in post_parse_xml() */
+		EntryJob *job = g_slice_new0 (EntryJob);
+		job->data = data;
+		job->node = node;
+		job->entry_i = data->entry_offset + data->entry_i;
+		job->total_results = get_progress_total_results (self, data);
+
+		detach_entry_node (node);
+		g_ptr_array_add (data->jobs, job);
+
+		g_mutex_lock (data->jobs_mutex);
+		data->n_pending_jobs++;
+		g_mutex_unlock (data->jobs_mutex);
+
+		g_thread_pool_push (data->thread_pool, job, NULL);
+		data->entry_i++;
+	} else if (xmlStrcmp (node->name, (xmlChar*) "entry") == 0) {
 		/* atom:entry */
-		GDataEntry *entry = GDATA_ENTRY (_gdata_parsable_new_from_xml_node (data->entry_type, "entry", doc, node, NULL, error));
+		GDataEntry *entry = GDATA_ENTRY (_gdata_parsable_new_from_xml_node (data->entry_type, "entry", data->unknown_xml, doc, node, NULL, error));
 		if (entry == NULL)
 			return FALSE;
 
-		/* Call the progress callback in the main thread */
-		if (data->progress_callback != NULL) {
-			ProgressCallbackData *progress_data;
-
-			/* Build the data for the callback */
-			progress_data = g_slice_new (ProgressCallbackData);
-			progress_data->progress_callback = data->progress_callback;
-			progress_data->progress_user_data = data->progress_user_data;
-			progress_data->entry = g_object_ref (entry);
-			progress_data->entry_i = data->entry_i;
-			progress_data->total_results = MIN (self->priv->items_per_page, self->priv->total_results);
-
-			/* Send the callback; use G_PRIORITY_DEFAULT rather than G_PRIORITY_DEFAULT_IDLE
-			 * to contend with the priorities used by the callback functions in GAsyncResult */
-			g_idle_add_full (G_PRIORITY_DEFAULT, (GSourceFunc) progress_callback_idle, progress_data, NULL);
-		}
+		/* Queue the progress callback for the query's main context, or call it now if progress is synchronous */
+		if (data->progress_queue != NULL)
+			progress_queue_push (data->progress_queue, entry, data->entry_offset + data->entry_i, get_progress_total_results (self, data));
 
 		data->entry_i++;
-		self->priv->entries = g_list_prepend (self->priv->entries, entry);
+
+		if (data->discard_entries == TRUE) {
+			g_object_unref (entry);
+			self->priv->n_discarded_entries++;
+		} else {
+			g_ptr_array_add (self->priv->entries, entry);
+		}
 	} else if (xmlStrcmp (node->name, (xmlChar*) "title") == 0) {
 		/* atom:title */
 		if (self->priv->title != NULL)
@@ -432,7 +801,7 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 
 		/* Parse the string */
 		updated_string = xmlNodeListGetString (doc, node->children, TRUE);
-		if (g_time_val_from_iso8601 ((gchar*) updated_string, &(self->priv->updated)) == FALSE) {
+		if (gdata_parser_time_val_from_iso8601 ((gchar*) updated_string, &(self->priv->updated)) == FALSE) {
 			gdata_parser_error_not_iso8601_format (node, (gchar*) updated_string, error);
 			xmlFree (updated_string);
 			return FALSE;
@@ -441,19 +810,12 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 		xmlFree (updated_string);
 	} else if (xmlStrcmp (node->name, (xmlChar*) "category") == 0) {
 		/* atom:category */
-		xmlChar *scheme, *term, *label;
 		GDataCategory *category;
 
-		scheme = xmlGetProp (node, (xmlChar*) "scheme");
-		term = xmlGetProp (node, (xmlChar*) "term");
-		label = xmlGetProp (node, (xmlChar*) "label");
-
-		category = gdata_category_new ((gchar*) term, (gchar*) scheme, (gchar*) label);
+		/* The category takes ownership of the strings */
+		category = _gdata_category_new_take (gdata_parser_get_property (node, "term"), gdata_parser_get_property (node, "scheme"),
+						     gdata_parser_get_property (node, "label"));
 		self->priv->categories = g_list_prepend (self->priv->categories, category);
-
-		xmlFree (scheme);
-		xmlFree (term);
-		xmlFree (label);
 	} else if (xmlStrcmp (node->name, (xmlChar*) "logo") == 0) {
 		/* atom:logo */
 		if (self->priv->logo != NULL)
@@ -462,62 +824,53 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 		self->priv->logo = (gchar*) xmlNodeListGetString (doc, node->children, TRUE);
 	} else if (xmlStrcmp (node->name, (xmlChar*) "link") == 0) {
 		/* atom:link */
-		xmlChar *href, *rel, *type, *hreflang, *link_title, *link_length;
+		gchar *link_length;
 		gint length_int;
 		GDataLink *link;
 
-		href = xmlGetProp (node, (xmlChar*) "href");
-		rel = xmlGetProp (node, (xmlChar*) "rel");
-		type = xmlGetProp (node, (xmlChar*) "type");
-		hreflang = xmlGetProp (node, (xmlChar*) "hreflang");
-		link_title = xmlGetProp (node, (xmlChar*) "title");
-		link_length = xmlGetProp (node, (xmlChar*) "length");
-
+		link_length = gdata_parser_get_property (node, "length");
 		if (link_length == NULL)
 			length_int = -1;
 		else
-			length_int = strtoul ((gchar*) link_length, NULL, 10);
+			length_int = strtoul (link_length, NULL, 10);
+		g_free (link_length);
 
-		link = gdata_link_new ((gchar*) href, (gchar*) rel, (gchar*) type, (gchar*) hreflang, (gchar*) link_title, length_int);
+		/* The link takes ownership of the strings */
+		link = _gdata_link_new_take (gdata_parser_get_property (node, "href"), gdata_parser_get_property (node, "rel"),
+					     gdata_parser_get_property (node, "type"), gdata_parser_get_property (node, "hreflang"),
+					     gdata_parser_get_property (node, "title"), length_int);
 		self->priv->links = g_list_prepend (self->priv->links, link);
 
-		xmlFree (href);
-		xmlFree (rel);
-		xmlFree (type);
-		xmlFree (hreflang);
-		xmlFree (link_title);
-		xmlFree (link_length);
+		if (link != NULL && data->next_uri_func != NULL && strcmp (link->rel, "next") == 0)
+			data->next_uri_func (link->href, data->next_uri_user_data);
 	} else if (xmlStrcmp (node->name, (xmlChar*) "author") == 0) {
 		/* atom:author */
 		GDataAuthor *author;
 		xmlNode *author_node;
-		xmlChar *name = NULL, *uri = NULL, *email = NULL;
+		gchar *name = NULL, *uri = NULL, *email = NULL;
 
 		author_node = node->children;
 		while (author_node != NULL) {
 			if (xmlStrcmp (author_node->name, (xmlChar*) "name") == 0) {
-				name = xmlNodeListGetString (doc, author_node->children, TRUE);
+				name = gdata_parser_get_content (author_node);
 			} else if (xmlStrcmp (author_node->name, (xmlChar*) "uri") == 0) {
-				uri = xmlNodeListGetString (doc, author_node->children, TRUE);
+				uri = gdata_parser_get_content (author_node);
 			} else if (xmlStrcmp (author_node->name, (xmlChar*) "email") == 0) {
-				email = xmlNodeListGetString (doc, author_node->children, TRUE);
+				email = gdata_parser_get_content (author_node);
 			} else {
 				gdata_parser_error_unhandled_element (author_node, error);
-				xmlFree (name);
-				xmlFree (uri);
-				xmlFree (email);
+				g_free (name);
+				g_free (uri);
+				g_free (email);
 				return FALSE;
 			}
 
 			author_node = author_node->next;
 		}
 
-		author = gdata_author_new ((gchar*) name, (gchar*) uri, (gchar*) email);
+		/* The author takes ownership of the strings */
+		author = _gdata_author_new_take (name, uri, email);
 		self->priv->authors = g_list_prepend (self->priv->authors, author);
-
-		xmlFree (name);
-		xmlFree (uri);
-		xmlFree (email);
 	} else if (xmlStrcmp (node->name, (xmlChar*) "generator") == 0) {
 		/* atom:generator */
 		xmlChar *name, *uri, *version;
@@ -581,6 +934,12 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 
 		self->priv->items_per_page = strtoul ((gchar*) items_per_page_string, NULL, 10);
 		xmlFree (items_per_page_string);
+
+		/* The entries usually come afterwards, so make room for them all at once */
+		if (self->priv->entries->len == 0 && self->priv->items_per_page > 0 && ((ParseData*) user_data)->discard_entries == FALSE) {
+			g_ptr_array_free (self->priv->entries, TRUE);
+			self->priv->entries = g_ptr_array_sized_new (self->priv->items_per_page);
+		}
 	} else if (GDATA_PARSABLE_CLASS (gdata_feed_parent_class)->parse_xml (parsable, doc, node, user_data, error) == FALSE) {
 		/* Error! */
 		return FALSE;
@@ -593,6 +952,7 @@ static gboolean
 post_parse_xml (GDataParsable *parsable, gpointer user_data, GError **error)
 {
 	GDataFeedPrivate *priv = GDATA_FEED (parsable)->priv;
+	ParseData *data = user_data;
 
 	/* Check for missing required elements */
 	if (priv->title == NULL)
@@ -602,12 +962,40 @@ post_parse_xml (GDataParsable *parsable, gpointer user_data, GError **error)
 	if (priv->updated.tv_sec == 0 && priv->updated.tv_usec == 0)
 		return gdata_parser_error_required_element_missing ("updated", "feed", error);
 
+	/* Collect the entries which were parsed on the thread pool, in the order they appeared in the feed */
+	if (data != NULL && data->jobs != NULL) {
+		guint i;
+
+		wait_for_entry_jobs (data);
+
+		for (i = 0; i < data->jobs->len; i++) {
+			EntryJob *job = g_ptr_array_index (data->jobs, i);
+
+			if (job->error != NULL) {
+				g_propagate_error (error, job->error);
+				job->error = NULL;
+				return FALSE;
+			}
+
+			if (data->discard_entries == TRUE) {
+				priv->n_discarded_entries++;
+				continue;
+			}
+
+			g_ptr_array_add (priv->entries, job->entry);
+			job->entry = NULL;
+		}
+	}
+
 	/* Reverse our lists of stuff */
-	priv->entries = g_list_reverse (priv->entries);
 	priv->categories = g_list_reverse (priv->categories);
 	priv->links = g_list_reverse (priv->links);
 	priv->authors = g_list_reverse (priv->authors);
 
+	/* Keep the document the unparsed entries belong to */
+	if (priv->lazy_nodes != NULL)
+		priv->lazy_docs = g_slist_prepend (priv->lazy_docs, _gdata_parsable_stream_steal_document (data->stream));
+
 	return TRUE;
 }
 
@@ -624,36 +1012,374 @@ _gdata_feed_new_from_xml (GType feed_type, const gchar *xml, gint length, GType
 
 	data = g_slice_new (ParseData);
 	data->entry_type = entry_type;
-	data->progress_callback = progress_callback;
-	data->progress_user_data = progress_user_data;
+	data->progress_queue = (progress_callback != NULL) ? progress_queue_new (FALSE, progress_callback, progress_user_data, NULL, NULL) : NULL;
 	data->entry_i = 0;
+	data->entry_offset = 0;
+	data->whole_feed = FALSE;
+	data->lazy = FALSE;
+	data->stream = NULL;
+	data->unknown_xml = GDATA_PARSABLE_UNKNOWN_XML_SERIALISE;
+	data->discard_entries = FALSE;
+	data->next_uri_func = NULL;
+	data->thread_pool = NULL;
+	data->jobs = NULL;
 
 	feed = GDATA_FEED (_gdata_parsable_new_from_xml (feed_type, "feed", xml, length, data, error));
 
+	if (data->progress_queue != NULL)
+		progress_queue_unref (data->progress_queue);
 	g_slice_free (ParseData, data);
 
 	return feed;
 }
 
+static void
+parse_data_free (ParseData *data)
+{
+	if (data->jobs != NULL) {
+		/* The stream may be freed part-way through a parse, so the jobs mightn't have been collected yet */
+		wait_for_entry_jobs (data);
+		g_ptr_array_foreach (data->jobs, (GFunc) entry_job_free, NULL);
+		g_ptr_array_free (data->jobs, TRUE);
+		g_mutex_free (data->jobs_mutex);
+		g_cond_free (data->jobs_cond);
+	}
+
+	if (data->progress_queue != NULL)
+		progress_queue_unref (data->progress_queue);
+
+	g_slice_free (ParseData, data);
+}
+
+/* If @whole_feed is %TRUE, the stream is for one of several pages of the same feed, and the progress callback's entry keys and count will
+ * be relative to the first of those pages, with @entry_offset being the key of this page's first entry. */
+GDataParsableStream *
+_gdata_feed_stream_new (GType feed_type, GType entry_type, GDataQuery *query, guint entry_offset, gboolean whole_feed,
+			GDataQueryProgressCallback progress_callback, gpointer progress_user_data)
+{
+	ParseData *data;
+	GDataQueryFlags flags = GDATA_QUERY_FLAGS_NONE;
+	GDataQueryBatchProgressCallback batch_progress_callback = NULL;
+	gpointer batch_progress_user_data = NULL;
+
+	g_return_val_if_fail (g_type_is_a (feed_type, GDATA_TYPE_FEED) == TRUE, NULL);
+	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY) == TRUE, NULL);
+
+	if (query != NULL) {
+		flags = gdata_query_get_flags (query);
+		batch_progress_callback = _gdata_query_get_batch_progress_callback (query, &batch_progress_user_data);
+	}
+
+	data = g_slice_new (ParseData);
+	data->entry_type = entry_type;
+	data->progress_queue = NULL;
+	data->entry_i = 0;
+	data->entry_offset = entry_offset;
+	data->whole_feed = whole_feed;
+
+	if (progress_callback != NULL || batch_progress_callback != NULL)
+		data->progress_queue = progress_queue_new ((flags & GDATA_QUERY_FLAGS_SYNCHRONOUS_PROGRESS) ? TRUE : FALSE,
+							   progress_callback, progress_user_data, batch_progress_callback, batch_progress_user_data);
+
+	/* Entries have to be built straight away if they're to be passed to the progress callbacks; and they can only be discarded if they're
+	 * passed to them */
+	data->lazy = (flags & GDATA_QUERY_FLAGS_LAZY_ENTRIES && data->progress_queue == NULL) ? TRUE : FALSE;
+	data->discard_entries = (flags & GDATA_QUERY_FLAGS_DISCARD_ENTRIES && data->progress_queue != NULL) ? TRUE : FALSE;
+	data->next_uri_func = NULL;
+	data->next_uri_user_data = NULL;
+
+	if (flags & GDATA_QUERY_FLAGS_DROP_UNKNOWN_XML)
+		data->unknown_xml = GDATA_PARSABLE_UNKNOWN_XML_DROP;
+	else if (flags & GDATA_QUERY_FLAGS_DEFER_UNKNOWN_XML)
+		data->unknown_xml = GDATA_PARSABLE_UNKNOWN_XML_DEFER;
+	else
+		data->unknown_xml = GDATA_PARSABLE_UNKNOWN_XML_SERIALISE;
+
+	/* Parsing entries in parallel is pointless if they're not going to be parsed until they're accessed */
+	data->thread_pool = (flags & GDATA_QUERY_FLAGS_PARALLEL_ENTRIES && data->lazy == FALSE) ? get_entry_thread_pool () : NULL;
+	data->jobs = NULL;
+
+	if (data->thread_pool != NULL) {
+		data->jobs = g_ptr_array_new ();
+		data->n_pending_jobs = 0;
+		data->jobs_mutex = g_mutex_new ();
+		data->jobs_cond = g_cond_new ();
+	}
+
+	/* Each entry is parsed (and the progress callback scheduled for it) as soon as its closing tag has been pushed into the stream */
+	data->stream = _gdata_parsable_stream_new (feed_type, "feed", data, (GDestroyNotify) parse_data_free);
+
+	return data->stream;
+}
+
+/* Sets a function to be called with the URI of the feed's "next" link as soon as it's been parsed, which is usually well before the feed's
+ * entries have been received. It's called from whichever thread pushes data into @stream. */
+void
+_gdata_feed_stream_set_next_uri_func (GDataParsableStream *stream, GDataFeedNextUriFunc next_uri_func, gpointer user_data)
+{
+	ParseData *data = _gdata_parsable_stream_get_user_data (stream);
+
+	data->next_uri_func = next_uri_func;
+	data->next_uri_user_data = user_data;
+}
+
+/* Sets the main context the progress callbacks are delivered in (unless they're synchronous), in place of the thread-default context of the
+ * thread which created @stream. This must be called before any data's pushed into @stream. */
+void
+_gdata_feed_stream_set_progress_context (GDataParsableStream *stream, GMainContext *context)
+{
+	ParseData *data = _gdata_parsable_stream_get_user_data (stream);
+
+	if (data->progress_queue == NULL)
+		return;
+
+	if (context != NULL)
+		g_main_context_ref (context);
+	if (data->progress_queue->context != NULL)
+		g_main_context_unref (data->progress_queue->context);
+	data->progress_queue->context = context;
+}
+
+/* Called whenever entries are added to or removed from the feed */
+static void
+entries_changed (GDataFeedPrivate *priv)
+{
+	g_list_free (priv->entries_list);
+	priv->entries_list = NULL;
+
+	if (priv->entry_index != NULL)
+		g_hash_table_destroy (priv->entry_index);
+	priv->entry_index = NULL;
+}
+
+static GPtrArray *
+get_lazy_nodes (GDataFeedPrivate *priv)
+{
+	/* Make sure lazy_nodes lines up with entries, even if none of the entries were built lazily */
+	if (priv->lazy_nodes == NULL) {
+		priv->lazy_nodes = g_ptr_array_sized_new (priv->entries->len);
+		g_ptr_array_set_size (priv->lazy_nodes, priv->entries->len);
+	}
+
+	return priv->lazy_nodes;
+}
+
+/* Moves all the entries from @other onto the end of @self's list of entries */
+void
+_gdata_feed_append_entries (GDataFeed *self, GDataFeed *other)
+{
+	guint i;
+
+	g_return_if_fail (GDATA_IS_FEED (self));
+	g_return_if_fail (GDATA_IS_FEED (other));
+
+	/* Take the unbuilt entries from the other feed too */
+	if (self->priv->lazy_nodes != NULL || other->priv->lazy_nodes != NULL) {
+		GPtrArray *lazy_nodes = get_lazy_nodes (self->priv), *other_lazy_nodes = get_lazy_nodes (other->priv);
+
+		for (i = 0; i < other_lazy_nodes->len; i++)
+			g_ptr_array_add (lazy_nodes, g_ptr_array_index (other_lazy_nodes, i));
+		g_ptr_array_free (other_lazy_nodes, TRUE);
+		other->priv->lazy_nodes = NULL;
+
+		self->priv->lazy_docs = g_slist_concat (self->priv->lazy_docs, other->priv->lazy_docs);
+		other->priv->lazy_docs = NULL;
+
+		if (other->priv->lazy_entry_type != G_TYPE_INVALID)
+			self->priv->lazy_entry_type = other->priv->lazy_entry_type;
+	}
+
+	for (i = 0; i < other->priv->entries->len; i++)
+		g_ptr_array_add (self->priv->entries, g_ptr_array_index (other->priv->entries, i));
+	g_ptr_array_set_size (other->priv->entries, 0);
+
+	self->priv->n_discarded_entries += other->priv->n_discarded_entries;
+	other->priv->n_discarded_entries = 0;
+
+	entries_changed (self->priv);
+	entries_changed (other->priv);
+}
+
+/* Returns the number of entries which were in the feed's XML, including any which were discarded after being passed to the progress
+ * callbacks, and so aren't counted by gdata_feed_get_n_entries() */
+guint
+_gdata_feed_get_n_parsed_entries (GDataFeed *self)
+{
+	g_return_val_if_fail (GDATA_IS_FEED (self), 0);
+	return self->priv->entries->len + self->priv->n_discarded_entries;
+}
+
+/* Builds the entry for the unparsed node at @index, and stores it in the list of entries. If the entry can't be parsed (now or when it was
+ * first accessed), %NULL is returned; its slot is kept empty, so the indices of the other entries don't change. */
+static GDataEntry *
+build_lazy_entry (GDataFeed *self, guint index)
+{
+	GDataFeedPrivate *priv = self->priv;
+	xmlNode *node;
+	GDataEntry *entry;
+	GError *error = NULL;
+
+	/* Entries which have already failed to be built have no node left */
+	if (priv->lazy_nodes == NULL || (node = g_ptr_array_index (priv->lazy_nodes, index)) == NULL)
+		return NULL;
+
+	entry = GDATA_ENTRY (_gdata_parsable_new_from_xml_node (priv->lazy_entry_type, "entry", _gdata_parsable_get_unknown_xml (GDATA_PARSABLE (self)),
+								 node->doc, node, NULL, &error));
+
+	xmlFreeNode (node);
+	g_ptr_array_index (priv->lazy_nodes, index) = NULL;
+
+	if (entry == NULL) {
+		/* The entry came from the server, so this isn't a programming error; the caller finds out from the %NULL return value */
+		g_debug ("Error parsing entry in %s: %s", G_OBJECT_TYPE_NAME (self), error->message);
+		g_error_free (error);
+		return NULL;
+	}
+
+	g_ptr_array_index (priv->entries, index) = entry;
+
+	return entry;
+}
+
+static void
+build_lazy_entries (GDataFeed *self)
+{
+	guint i;
+
+	for (i = 0; i < self->priv->entries->len; i++) {
+		if (g_ptr_array_index (self->priv->entries, i) == NULL)
+			build_lazy_entry (self, i);
+	}
+
+	/* All the entries have been built, so the documents they were built from aren't needed any more */
+	free_lazy_nodes (self->priv);
+}
+
+/* Returns the atom:id of an unbuilt entry's node, without building the entry */
+static gchar *
+lazy_node_get_id (xmlNode *node)
+{
+	for (node = node->children; node != NULL; node = node->next) {
+		if (node->type == XML_ELEMENT_NODE && xmlStrcmp (node->name, (xmlChar*) "id") == 0)
+			return gdata_parser_get_content (node);
+	}
+
+	return NULL;
+}
+
+static GHashTable *
+get_entry_index (GDataFeedPrivate *priv)
+{
+	guint i;
+
+	if (priv->entry_index != NULL)
+		return priv->entry_index;
+
+	priv->entry_index = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	for (i = 0; i < priv->entries->len; i++) {
+		GDataEntry *entry = g_ptr_array_index (priv->entries, i);
+		gchar *id;
+
+		if (entry != NULL)
+			id = g_strdup (gdata_entry_get_id (entry));
+		else if (priv->lazy_nodes != NULL && g_ptr_array_index (priv->lazy_nodes, i) != NULL)
+			id = lazy_node_get_id (g_ptr_array_index (priv->lazy_nodes, i));
+		else
+			id = NULL; /* the entry couldn't be built */
+
+		/* If several entries have the same ID, the first one is found, as before */
+		if (id == NULL || g_hash_table_lookup (priv->entry_index, id) != NULL)
+			g_free (id);
+		else
+			g_hash_table_insert (priv->entry_index, id, GUINT_TO_POINTER (i + 1));
+	}
+
+	return priv->entry_index;
+}
+
 /**
  * gdata_feed_get_entries:
  * @self: a #GDataFeed
  *
- * Returns a list of the entries contained in this feed.
+ * Returns a list of the entries contained in this feed. If the feed was the result of a query with %GDATA_QUERY_FLAGS_LAZY_ENTRIES set, all
+ * the entries are built, and any which can't be are left out of the list.
+ *
+ * gdata_feed_get_n_entries() and gdata_feed_get_entry_at() are more efficient ways to access the entries, as they don't need a list to be built.
  *
- * Return value: a #GList of #GDataEntry<!-- -->s; free the list with g_list_free(), but do not unref the entries
+ * Return value: a #GList of #GDataEntry<!-- -->s; the list is owned by the feed, and must not be freed
  **/
 GList *
 gdata_feed_get_entries (GDataFeed *self)
 {
+	GDataFeedPrivate *priv;
+	guint i;
+
 	g_return_val_if_fail (GDATA_IS_FEED (self), NULL);
-	return self->priv->entries;
+
+	priv = self->priv;
+
+	if (priv->lazy_nodes != NULL)
+		build_lazy_entries (self);
+
+	/* The list is kept until the entries change; entries which couldn't be built are left out */
+	if (priv->entries_list == NULL) {
+		for (i = priv->entries->len; i > 0; i--) {
+			if (g_ptr_array_index (priv->entries, i - 1) != NULL)
+				priv->entries_list = g_list_prepend (priv->entries_list, g_ptr_array_index (priv->entries, i - 1));
+		}
+	}
+
+	return priv->entries_list;
+}
+
+/**
+ * gdata_feed_get_n_entries:
+ * @self: a #GDataFeed
+ *
+ * Returns the number of entries contained in this feed. If the feed was the result of a query with %GDATA_QUERY_FLAGS_LAZY_ENTRIES set, this
+ * includes any entries which can't be parsed once they're accessed, for which gdata_feed_get_entry_at() returns %NULL; it doesn't change as the
+ * entries are built.
+ *
+ * Return value: the number of entries
+ *
+ * Since: 0.4.0
+ **/
+guint
+gdata_feed_get_n_entries (GDataFeed *self)
+{
+	g_return_val_if_fail (GDATA_IS_FEED (self), 0);
+	return self->priv->entries->len;
 }
 
-static gint
-entry_compare_cb (const GDataEntry *entry, const gchar *id)
+/**
+ * gdata_feed_get_entry_at:
+ * @self: a #GDataFeed
+ * @index: the zero-based index of the entry, which must be less than gdata_feed_get_n_entries()
+ *
+ * Returns the entry at position @index in the feed. If the feed was the result of a query with %GDATA_QUERY_FLAGS_LAZY_ENTRIES set, only this
+ * entry is built, if it hasn't been already. If it can't be parsed, %NULL is returned (now and on every later call), and the indices of the
+ * other entries are unaffected.
+ *
+ * Building an entry modifies the feed, so a feed with lazily-built entries must only be accessed from one thread at a time.
+ *
+ * Return value: the #GDataEntry, or %NULL if it couldn't be built
+ *
+ * Since: 0.4.0
+ **/
+GDataEntry *
+gdata_feed_get_entry_at (GDataFeed *self, guint index)
 {
-	return strcmp (gdata_entry_get_id (GDATA_ENTRY (entry)), id);
+	GDataEntry *entry;
+
+	g_return_val_if_fail (GDATA_IS_FEED (self), NULL);
+	g_return_val_if_fail (index < self->priv->entries->len, NULL);
+
+	entry = g_ptr_array_index (self->priv->entries, index);
+	if (entry == NULL)
+		entry = build_lazy_entry (self, index);
+
+	return entry;
 }
 
 /**
@@ -663,6 +1389,8 @@ entry_compare_cb (const GDataEntry *entry, const gchar *id)
  *
  * Returns the entry in the feed with the given @id, if found.
  *
+ * The feed's entries are indexed by ID the first time this is called, so subsequent look-ups take constant time.
+ *
  * Return value: the #GDataEntry, or %NULL
  *
  * Since: 0.2.0
@@ -670,15 +1398,22 @@ entry_compare_cb (const GDataEntry *entry, const gchar *id)
 GDataEntry *
 gdata_feed_look_up_entry (GDataFeed *self, const gchar *id)
 {
-	GList *element;
+	GDataEntry *entry;
+	guint index;
 
 	g_return_val_if_fail (GDATA_IS_FEED (self), NULL);
 	g_return_val_if_fail (id != NULL, NULL);
 
-	element = g_list_find_custom (self->priv->entries, id, (GCompareFunc) entry_compare_cb);
-	if (element == NULL)
+	index = GPOINTER_TO_UINT (g_hash_table_lookup (get_entry_index (self->priv), id));
+	if (index == 0)
 		return NULL;
-	return GDATA_ENTRY (element->data);
+
+	/* Only build the entry we're looking for, if it hasn't been built yet */
+	entry = g_ptr_array_index (self->priv->entries, index - 1);
+	if (entry == NULL)
+		entry = build_lazy_entry (self, index - 1);
+
+	return entry;
 }
 
 /**
@@ -711,10 +1446,12 @@ gdata_feed_get_links (GDataFeed *self)
 	return self->priv->links;
 }
 
-static gint
-link_compare_cb (const GDataLink *link, const gchar *rel)
+static GHashTable *
+get_link_index (GDataFeedPrivate *priv)
 {
-	return strcmp (link->rel, rel);
+	if (priv->link_index == NULL)
+		priv->link_index = _gdata_link_index_new (priv->links);
+	return priv->link_index;
 }
 
 /**
@@ -731,15 +1468,36 @@ link_compare_cb (const GDataLink *link, const gchar *rel)
 GDataLink *
 gdata_feed_look_up_link (GDataFeed *self, const gchar *rel)
 {
-	GList *element;
+	GList *links;
 
 	g_return_val_if_fail (GDATA_IS_FEED (self), NULL);
 	g_return_val_if_fail (rel != NULL, NULL);
 
-	element = g_list_find_custom (self->priv->links, rel, (GCompareFunc) link_compare_cb);
-	if (element == NULL)
+	links = g_hash_table_lookup (get_link_index (self->priv), rel);
+	if (links == NULL)
 		return NULL;
-	return (GDataLink*) (element->data);
+	return (GDataLink*) (links->data);
+}
+
+/**
+ * gdata_feed_look_up_links:
+ * @self: a #GDataFeed
+ * @rel: the value of the <structfield>rel</structfield> attribute of the desired links
+ *
+ * Looks up all the links with the given <structfield>rel</structfield> value from the list of links in the feed, in the same order as
+ * they appear in the feed. The first link in the list is the one returned by gdata_feed_look_up_link().
+ *
+ * Return value: a #GList of #GDataLink<!-- -->s, or %NULL if none were found; free the list with g_list_free(), but do not free the links
+ *
+ * Since: 0.4.0
+ **/
+GList *
+gdata_feed_look_up_links (GDataFeed *self, const gchar *rel)
+{
+	g_return_val_if_fail (GDATA_IS_FEED (self), NULL);
+	g_return_val_if_fail (rel != NULL, NULL);
+
+	return g_list_copy (g_hash_table_lookup (get_link_index (self->priv), rel));
 }
 
 /**
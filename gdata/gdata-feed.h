@@ -62,10 +62,13 @@ typedef struct {
 GType gdata_feed_get_type (void) G_GNUC_CONST;
 
 GList *gdata_feed_get_entries (GDataFeed *self);
+guint gdata_feed_get_n_entries (GDataFeed *self);
+GDataEntry *gdata_feed_get_entry_at (GDataFeed *self, guint index);
 GDataEntry *gdata_feed_look_up_entry (GDataFeed *self, const gchar *id);
 GList *gdata_feed_get_categories (GDataFeed *self);
 GList *gdata_feed_get_links (GDataFeed *self);
 GDataLink *gdata_feed_look_up_link (GDataFeed *self, const gchar *rel);
+GList *gdata_feed_look_up_links (GDataFeed *self, const gchar *rel) G_GNUC_WARN_UNUSED_RESULT;
 GList *gdata_feed_get_authors (GDataFeed *self);
 
 const gchar *gdata_feed_get_title (GDataFeed *self);
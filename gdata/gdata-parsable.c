@@ -27,6 +27,10 @@
  * both of which require XML parsing which can be extended by subclassing.
  *
  * It allows methods to be defined for handling the root XML node, each of its child nodes, and a method to be called after parsing is complete.
+ *
+ * Documents are parsed incrementally: each child node of the root node is passed to the @parse_xml method as soon as its closing tag has been
+ * received, and is freed once the method returns. Only the child node currently being received is ever held in memory, rather than the tree
+ * for the whole document.
  **/
 
 #include <config.h>
@@ -34,6 +38,7 @@
 #include <glib/gi18n-lib.h>
 #include <string.h>
 #include <libxml/parser.h>
+#include <libxml/SAX2.h>
 
 #include "gdata-parsable.h"
 #include "gdata-private.h"
@@ -45,6 +50,12 @@ static gboolean real_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *n
 struct _GDataParsablePrivate {
 	GString *extra_xml;
 	GHashTable *extra_namespaces;
+
+	/* How unhandled elements are kept; with GDATA_PARSABLE_UNKNOWN_XML_DEFER, they're kept as standalone copies in extra_nodes (in
+	 * reverse order) until extra_xml or extra_namespaces are needed */
+	GDataParsableUnknownXml unknown_xml;
+	GSList *extra_nodes;
+	guint n_unknown_elements;
 };
 
 G_DEFINE_ABSTRACT_TYPE (GDataParsable, gdata_parsable, G_TYPE_OBJECT)
@@ -75,26 +86,29 @@ gdata_parsable_finalize (GObject *object)
 
 	g_string_free (priv->extra_xml, TRUE);
 	g_hash_table_destroy (priv->extra_namespaces);
+	g_slist_foreach (priv->extra_nodes, (GFunc) xmlFreeNode, NULL);
+	g_slist_free (priv->extra_nodes);
 
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS (gdata_parsable_parent_class)->finalize (object);
 }
 
-static gboolean
-real_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+static void
+add_extra_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node)
 {
 	xmlBuffer *buffer;
 	xmlNs **namespaces, **namespace;
 
-	/* Unhandled XML */
 	buffer = xmlBufferCreate ();
 	xmlNodeDump (buffer, doc, node, 0, 0);
 	g_string_append (parsable->priv->extra_xml, (gchar*) xmlBufferContent (buffer));
-	g_message ("Unhandled XML in %s: %s", G_OBJECT_TYPE_NAME (parsable), (gchar*) xmlBufferContent (buffer));
 	xmlBufferFree (buffer);
 
 	/* Get the namespaces */
 	namespaces = xmlGetNsList (doc, node);
+	if (namespaces == NULL)
+		return;
+
 	for (namespace = namespaces; *namespace != NULL; namespace++) {
 		if ((*namespace)->prefix != NULL) {
 			g_hash_table_insert (parsable->priv->extra_namespaces,
@@ -103,58 +117,370 @@ real_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer us
 		}
 	}
 	xmlFree (namespaces);
+}
+
+static void
+flush_extra_nodes (GDataParsable *parsable)
+{
+	GDataParsablePrivate *priv = parsable->priv;
+	GSList *i;
+
+	if (priv->extra_nodes == NULL)
+		return;
+
+	priv->extra_nodes = g_slist_reverse (priv->extra_nodes);
+	for (i = priv->extra_nodes; i != NULL; i = i->next) {
+		add_extra_xml (parsable, NULL, i->data);
+		xmlFreeNode (i->data);
+	}
+
+	g_slist_free (priv->extra_nodes);
+	priv->extra_nodes = NULL;
+}
+
+static gboolean
+real_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	/* Unhandled XML */
+	parsable->priv->n_unknown_elements++;
+
+	switch (parsable->priv->unknown_xml) {
+		case GDATA_PARSABLE_UNKNOWN_XML_SERIALISE:
+			add_extra_xml (parsable, doc, node);
+			break;
+		case GDATA_PARSABLE_UNKNOWN_XML_DEFER:
+			/* Copying the node without a document gives it its own strings and namespace declarations, so it doesn't depend on the
+			 * document (or its dictionary) once parsing's finished */
+			parsable->priv->extra_nodes = g_slist_prepend (parsable->priv->extra_nodes, xmlDocCopyNode (node, NULL, 1));
+			break;
+		case GDATA_PARSABLE_UNKNOWN_XML_DROP:
+		default:
+			break;
+	}
 
 	return TRUE;
 }
 
-GDataParsable *
-_gdata_parsable_new_from_xml (GType parsable_type, const gchar *first_element, const gchar *xml, gint length, gpointer user_data, GError **error)
+static void
+log_unknown_elements (GDataParsable *parsable)
 {
-	xmlDoc *doc;
-	xmlNode *node;
+	/* Report the count once per object, rather than logging every element */
+	if (parsable->priv->n_unknown_elements > 0)
+		g_debug ("%u unhandled XML elements in %s", parsable->priv->n_unknown_elements, G_OBJECT_TYPE_NAME (parsable));
+}
 
-	g_return_val_if_fail (g_type_is_a (parsable_type, GDATA_TYPE_PARSABLE) == TRUE, FALSE);
+struct _GDataParsableStream {
+	xmlParserCtxt *context;
+	GType parsable_type;
+	gchar *first_element;
+	gpointer user_data;
+	GDestroyNotify user_data_destroy;
+
+	/* If this is set, the children of the root element are passed to it, rather than a GDataParsable being built from the document */
+	GDataParsableStreamChildFunc child_func;
+
+	GDataParsable *parsable;
+	xmlNode *root_node;
+	guint depth;
+	GError *error;
+};
+
+static void
+stream_parse_children (GDataParsableStream *self, xmlNode *last_node)
+{
+	GDataParsableClass *klass = (self->parsable != NULL) ? GDATA_PARSABLE_GET_CLASS (self->parsable) : NULL;
+	xmlNode *node, *next_node;
+	gboolean success;
+
+	/* Parse each unparsed child of the root node up to and including last_node (or all of them if it's NULL). Each node is freed as soon as
+	 * it's been parsed, so the document never holds more than the child element currently being received. If the parse function wants to keep
+	 * the node, it can unlink it from the document, and it then becomes responsible for freeing it. */
+	for (node = self->root_node->children; node != NULL; node = next_node) {
+		gboolean is_last = (node == last_node) ? TRUE : FALSE;
+
+		next_node = node->next;
+
+		if (self->child_func != NULL)
+			success = self->child_func (self->context->myDoc, node, self->user_data, &(self->error));
+		else
+			success = klass->parse_xml (self->parsable, self->context->myDoc, node, self->user_data, &(self->error));
+
+		if (success == FALSE) {
+			xmlStopParser (self->context);
+			return;
+		}
+
+		if (node->parent != NULL) {
+			xmlUnlinkNode (node);
+			xmlFreeNode (node);
+		}
+
+		if (is_last == TRUE)
+			break;
+	}
+}
+
+static void
+stream_start_element_cb (void *ctx, const xmlChar *localname, const xmlChar *prefix, const xmlChar *uri, int nb_namespaces,
+			 const xmlChar **namespaces, int nb_attributes, int nb_defaulted, const xmlChar **attributes)
+{
+	xmlParserCtxt *context = ctx;
+	GDataParsableStream *self = context->_private;
+	GDataParsableClass *klass;
+
+	/* Let libxml2 build the node as usual */
+	xmlSAX2StartElementNs (ctx, localname, prefix, uri, nb_namespaces, namespaces, nb_attributes, nb_defaulted, attributes);
+
+	if (self->error != NULL || self->depth++ != 0)
+		return;
+
+	/* We've got the root element */
+	self->root_node = context->node;
+
+	if (xmlStrcmp (localname, (xmlChar*) self->first_element) != 0) {
+		/* No <entry> element (required) */
+		gdata_parser_error_required_element_missing (self->first_element, "root", &(self->error));
+		xmlStopParser (context);
+		return;
+	}
+
+	if (self->child_func != NULL)
+		return;
+
+	self->parsable = g_object_new (self->parsable_type, NULL);
+	klass = GDATA_PARSABLE_GET_CLASS (self->parsable);
+	g_assert (klass->parse_xml != NULL);
+
+	/* Call the pre-parse function; only the root node's attributes are available at this point */
+	if (klass->pre_parse_xml != NULL &&
+	    klass->pre_parse_xml (self->parsable, context->myDoc, self->root_node, self->user_data, &(self->error)) == FALSE) {
+		xmlStopParser (context);
+	}
+}
+
+static void
+stream_end_element_cb (void *ctx, const xmlChar *localname, const xmlChar *prefix, const xmlChar *uri)
+{
+	xmlParserCtxt *context = ctx;
+	GDataParsableStream *self = context->_private;
+	xmlNode *node = context->node;
+
+	xmlSAX2EndElementNs (ctx, localname, prefix, uri);
+
+	if (self->error != NULL)
+		return;
+
+	self->depth--;
+	if (self->depth == 1) {
+		/* A child of the root element has been closed, so parse it */
+		stream_parse_children (self, node);
+	} else if (self->depth == 0) {
+		/* The root element has been closed; parse any trailing text nodes */
+		stream_parse_children (self, NULL);
+	}
+}
+
+GDataParsableStream *
+_gdata_parsable_stream_new (GType parsable_type, const gchar *first_element, gpointer user_data, GDestroyNotify user_data_destroy)
+{
+	GDataParsableStream *self;
+	xmlSAXHandler sax_handler;
+
+	g_return_val_if_fail (g_type_is_a (parsable_type, GDATA_TYPE_PARSABLE) == TRUE, NULL);
 	g_return_val_if_fail (first_element != NULL, NULL);
-	g_return_val_if_fail (xml != NULL, NULL);
 
-	if (length == -1)
-		length = strlen (xml);
+	self = g_slice_new0 (GDataParsableStream);
+	self->parsable_type = parsable_type;
+	self->first_element = g_strdup (first_element);
+	self->user_data = user_data;
+	self->user_data_destroy = user_data_destroy;
+
+	/* Use libxml2's normal tree-building SAX handlers, but hook into the element handlers so we can parse and free each child of the root
+	 * element as soon as it's complete */
+	memset (&sax_handler, 0, sizeof (sax_handler));
+	xmlSAXVersion (&sax_handler, 2);
+	sax_handler.startElementNs = stream_start_element_cb;
+	sax_handler.endElementNs = stream_end_element_cb;
+
+	self->context = xmlCreatePushParserCtxt (&sax_handler, NULL, NULL, 0, "/dev/null");
+	self->context->_private = self;
+
+	return self;
+}
+
+/* Creates a stream which checks the root element is @first_element, then passes each of its children to @child_func as soon as it's been
+ * received, and frees it. No #GDataParsable is built, so the stream should be ended with _gdata_parsable_stream_end(), rather than
+ * _gdata_parsable_stream_finish(). */
+GDataParsableStream *
+_gdata_parsable_stream_new_for_children (const gchar *first_element, GDataParsableStreamChildFunc child_func, gpointer user_data,
+					 GDestroyNotify user_data_destroy)
+{
+	GDataParsableStream *self;
+
+	g_return_val_if_fail (child_func != NULL, NULL);
+
+	self = _gdata_parsable_stream_new (GDATA_TYPE_PARSABLE, first_element, user_data, user_data_destroy);
+	self->child_func = child_func;
+
+	return self;
+}
 
-	/* Parse the XML */
-	doc = xmlReadMemory (xml, length, "/dev/null", NULL, 0);
-	if (doc == NULL) {
-		xmlError *xml_error = xmlGetLastError ();
+static gboolean
+stream_check_error (GDataParsableStream *self, gint xml_status, GError **error)
+{
+	if (self->error != NULL) {
+		g_propagate_error (error, g_error_copy (self->error));
+		return FALSE;
+	} else if (xml_status != 0) {
+		xmlError *xml_error = xmlCtxtGetLastError (self->context);
 		g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING,
 			     /* Translators: the parameter is an error message */
 			     _("Error parsing XML: %s"),
-			     xml_error->message);
-		return NULL;
+			     (xml_error != NULL) ? xml_error->message : "");
+		return FALSE;
 	}
 
-	/* Get the root element */
-	node = xmlDocGetRootElement (doc);
-	if (node == NULL) {
+	return TRUE;
+}
+
+gboolean
+_gdata_parsable_stream_push (GDataParsableStream *self, const gchar *data, gsize length, GError **error)
+{
+	g_return_val_if_fail (self != NULL, FALSE);
+	g_return_val_if_fail (data != NULL || length == 0, FALSE);
+
+	/* Don't feed libxml2 any more data once parsing's failed */
+	if (self->error != NULL)
+		return stream_check_error (self, 0, error);
+
+	return stream_check_error (self, xmlParseChunk (self->context, data, length, 0), error);
+}
+
+gboolean
+_gdata_parsable_stream_end (GDataParsableStream *self, GError **error)
+{
+	gint xml_status = 0;
+
+	g_return_val_if_fail (self != NULL, FALSE);
+
+	/* Tell libxml2 there's no more data */
+	if (self->error == NULL)
+		xml_status = xmlParseChunk (self->context, NULL, 0, 1);
+	if (stream_check_error (self, xml_status, error) == FALSE)
+		return FALSE;
+
+	if (self->root_node == NULL) {
 		/* XML document's empty */
-		xmlFreeDoc (doc);
 		g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_EMPTY_DOCUMENT,
 			     _("Error parsing XML: %s"),
 			     /* Translators: this is a dummy error message to be substituted into "Error parsing XML: %s". */
 			     _("Empty document."));
-		return NULL;
+		return FALSE;
 	}
 
-	if (xmlStrcmp (node->name, (xmlChar*) first_element) != 0) {
-		/* No <entry> element (required) */
-		xmlFreeDoc (doc);
-		gdata_parser_error_required_element_missing (first_element, "root", error);
+	return TRUE;
+}
+
+GDataParsable *
+_gdata_parsable_stream_finish (GDataParsableStream *self, GError **error)
+{
+	GDataParsableClass *klass;
+	GDataParsable *parsable;
+
+	g_return_val_if_fail (self != NULL, NULL);
+	g_return_val_if_fail (self->child_func == NULL, NULL);
+
+	if (_gdata_parsable_stream_end (self, error) == FALSE)
+		return NULL;
+
+	g_assert (self->parsable != NULL);
+
+	/* Call the post-parse function */
+	parsable = self->parsable;
+	self->parsable = NULL;
+
+	klass = GDATA_PARSABLE_GET_CLASS (parsable);
+	if (klass->post_parse_xml != NULL &&
+	    klass->post_parse_xml (parsable, self->user_data, error) == FALSE) {
+		g_object_unref (parsable);
 		return NULL;
 	}
 
-	return _gdata_parsable_new_from_xml_node (parsable_type, first_element, doc, node, user_data, error);
+	log_unknown_elements (parsable);
+
+	return parsable;
+}
+
+/* Returns the user data the stream was created with */
+gpointer
+_gdata_parsable_stream_get_user_data (GDataParsableStream *self)
+{
+	g_return_val_if_fail (self != NULL, NULL);
+	return self->user_data;
+}
+
+/* Takes ownership of the stream's document, so that nodes which were kept by a parse function (see stream_parse_children()) remain valid
+ * after the stream is freed. The document must be freed with xmlFreeDoc() after any such nodes have been freed. */
+xmlDoc *
+_gdata_parsable_stream_steal_document (GDataParsableStream *self)
+{
+	xmlDoc *doc;
+
+	g_return_val_if_fail (self != NULL, NULL);
+
+	doc = self->context->myDoc;
+	self->context->myDoc = NULL;
+
+	return doc;
+}
+
+void
+_gdata_parsable_stream_free (GDataParsableStream *self)
+{
+	if (self == NULL)
+		return;
+
+	/* The parsable and user data may still hold nodes from the document, so have to be freed first */
+	if (self->parsable != NULL)
+		g_object_unref (self->parsable);
+	if (self->user_data_destroy != NULL)
+		self->user_data_destroy (self->user_data);
+
+	if (self->context->myDoc != NULL)
+		xmlFreeDoc (self->context->myDoc);
+	xmlFreeParserCtxt (self->context);
+	if (self->error != NULL)
+		g_error_free (self->error);
+	g_free (self->first_element);
+
+	g_slice_free (GDataParsableStream, self);
+}
+
+GDataParsable *
+_gdata_parsable_new_from_xml (GType parsable_type, const gchar *first_element, const gchar *xml, gint length, gpointer user_data, GError **error)
+{
+	GDataParsableStream *stream;
+	GDataParsable *parsable = NULL;
+
+	g_return_val_if_fail (g_type_is_a (parsable_type, GDATA_TYPE_PARSABLE) == TRUE, FALSE);
+	g_return_val_if_fail (first_element != NULL, NULL);
+	g_return_val_if_fail (xml != NULL, NULL);
+
+	if (length == -1)
+		length = strlen (xml);
+
+	/* Parse the XML in one go */
+	stream = _gdata_parsable_stream_new (parsable_type, first_element, user_data, NULL);
+	if (_gdata_parsable_stream_push (stream, xml, length, error) == TRUE)
+		parsable = _gdata_parsable_stream_finish (stream, error);
+	_gdata_parsable_stream_free (stream);
+
+	return parsable;
 }
 
 GDataParsable *
-_gdata_parsable_new_from_xml_node (GType parsable_type, const gchar *first_element, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+_gdata_parsable_new_from_xml_node (GType parsable_type, const gchar *first_element, GDataParsableUnknownXml unknown_xml, xmlDoc *doc, xmlNode *node,
+				   gpointer user_data, GError **error)
 {
 	GDataParsable *parsable;
 	GDataParsableClass *klass;
@@ -165,6 +491,7 @@ _gdata_parsable_new_from_xml_node (GType parsable_type, const gchar *first_eleme
 	g_return_val_if_fail (xmlStrcmp (node->name, (xmlChar*) first_element) == 0, FALSE);
 
 	parsable = g_object_new (parsable_type, NULL);
+	parsable->priv->unknown_xml = unknown_xml;
 
 	klass = GDATA_PARSABLE_GET_CLASS (parsable);
 	if (klass->parse_xml == NULL)
@@ -177,14 +504,16 @@ _gdata_parsable_new_from_xml_node (GType parsable_type, const gchar *first_eleme
 		return NULL;
 	}	
 
-	/* Parse each child element */
+	/* Parse each child element; the parse function may unlink the node it's given, so get the next one first */
 	node = node->children;
 	while (node != NULL) {
+		xmlNode *next_node = node->next;
+
 		if (klass->parse_xml (parsable, doc, node, user_data, error) == FALSE) {
 			g_object_unref (parsable);
 			return NULL;
 		}
-		node = node->next;
+		node = next_node;
 	}
 
 	/* Call the post-parse function */
@@ -194,6 +523,8 @@ _gdata_parsable_new_from_xml_node (GType parsable_type, const gchar *first_eleme
 		return NULL;
 	}
 
+	log_unknown_elements (parsable);
+
 	return parsable;
 }
 
@@ -201,6 +532,7 @@ const gchar *
 _gdata_parsable_get_extra_xml (GDataParsable *self)
 {
 	g_return_val_if_fail (GDATA_IS_PARSABLE (self), NULL);
+	flush_extra_nodes (self);
 	return self->priv->extra_xml->str;
 }
 
@@ -208,5 +540,22 @@ GHashTable *
 _gdata_parsable_get_extra_namespaces (GDataParsable *self)
 {
 	g_return_val_if_fail (GDATA_IS_PARSABLE (self), NULL);
+	flush_extra_nodes (self);
 	return self->priv->extra_namespaces;
 }
+
+/* Sets how elements which aren't handled by the parsable's class are kept; this must be called before parsing starts, e.g. from the
+ * pre_parse_xml function of the root element */
+void
+_gdata_parsable_set_unknown_xml (GDataParsable *self, GDataParsableUnknownXml unknown_xml)
+{
+	g_return_if_fail (GDATA_IS_PARSABLE (self));
+	self->priv->unknown_xml = unknown_xml;
+}
+
+GDataParsableUnknownXml
+_gdata_parsable_get_unknown_xml (GDataParsable *self)
+{
+	g_return_val_if_fail (GDATA_IS_PARSABLE (self), GDATA_PARSABLE_UNKNOWN_XML_SERIALISE);
+	return self->priv->unknown_xml;
+}
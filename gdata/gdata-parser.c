@@ -20,8 +20,7 @@
 #include <config.h>
 #include <glib.h>
 #include <glib/gi18n-lib.h>
-#include <sys/time.h>
-#include <time.h>
+#include <string.h>
 #include <libxml/parser.h>
 
 #include "gdata-service.h"
@@ -179,32 +178,426 @@ gdata_parser_error_duplicate_element (xmlNode *element, GError **error)
 	return FALSE;
 }
 
+/* Days since the epoch of the given date in the proleptic Gregorian calendar; see http://howardhinnant.github.io/date_algorithms.html */
+static glong
+days_from_civil (glong year, guint month, guint day)
+{
+	glong era;
+	guint year_of_era, day_of_year, day_of_era;
+
+	year -= (month <= 2) ? 1 : 0;
+	era = ((year >= 0) ? year : year - 399) / 400;
+	year_of_era = year - era * 400;
+	day_of_year = (153 * (month + ((month > 2) ? -3 : 9)) + 2) / 5 + day - 1;
+	day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+
+	return era * 146097 + (glong) day_of_era - 719468;
+}
+
+static void
+civil_from_days (glong days, glong *year, guint *month, guint *day)
+{
+	glong era;
+	guint day_of_era, year_of_era, day_of_year, mp;
+
+	days += 719468;
+	era = ((days >= 0) ? days : days - 146096) / 146097;
+	day_of_era = days - era * 146097;
+	year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+	day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+	mp = (5 * day_of_year + 2) / 153;
+
+	*day = day_of_year - (153 * mp + 2) / 5 + 1;
+	*month = (mp < 10) ? mp + 3 : mp - 9;
+	*year = (glong) year_of_era + era * 400 + ((*month <= 2) ? 1 : 0);
+}
+
+/* Parses @n_digits decimal digits from @string, returning -1 if any of them aren't digits */
+static gint
+parse_digits (const gchar *string, guint n_digits)
+{
+	gint value = 0;
+
+	for (; n_digits > 0; n_digits--, string++) {
+		if (*string < '0' || *string > '9')
+			return -1;
+		value = value * 10 + (*string - '0');
+	}
+
+	return value;
+}
+
+static guint
+days_in_month (gint year, guint month)
+{
+	const guint8 month_lengths[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+	if (month == 2 && ((year % 4 == 0 && year % 100 != 0) || year % 400 == 0))
+		return 29;
+	return month_lengths[month - 1];
+}
+
+/* Parses a "YYYY-MM-DD" or "YYYYMMDD" date from the start of @string, returning the number of characters used, or 0 on error */
+static guint
+parse_date (const gchar *string, gsize length, glong *days)
+{
+	gint year, month, day;
+	guint offset;
+
+	if (length >= 10 && string[4] == '-' && string[7] == '-') {
+		year = parse_digits (string, 4);
+		month = parse_digits (string + 5, 2);
+		day = parse_digits (string + 8, 2);
+		offset = 10;
+	} else if (length >= 8) {
+		year = parse_digits (string, 4);
+		month = parse_digits (string + 4, 2);
+		day = parse_digits (string + 6, 2);
+		offset = 8;
+	} else {
+		return 0;
+	}
+
+	if (year < 0 || month < 1 || month > 12 || day < 1 || (guint) day > days_in_month (year, month))
+		return 0;
+
+	*days = days_from_civil (year, month, day);
+	return offset;
+}
+
+/* Parses a date and time in the fixed format of RFC 3339, returning FALSE if @string isn't in that format */
+static gboolean
+parse_rfc3339 (const gchar *string, gsize length, GTimeVal *_time)
+{
+	const gchar *i, *end = string + length;
+	glong days, usec = 0;
+	gint hour, minute, second, offset = 0;
+	guint date_length;
+
+	date_length = parse_date (string, length, &days);
+	i = string + date_length;
+
+	if (date_length == 0 || end - i < 9 || (*i != 'T' && *i != 't' && *i != ' ') || i[3] != ':' || i[6] != ':')
+		return FALSE;
+
+	hour = parse_digits (i + 1, 2);
+	minute = parse_digits (i + 4, 2);
+	second = parse_digits (i + 7, 2);
+	if (hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 60)
+		return FALSE;
+	i += 9;
+
+	/* Fractional seconds; anything beyond microseconds is truncated */
+	if (i < end && (*i == '.' || *i == ',')) {
+		glong scale = 100000;
+
+		for (i++; i < end && *i >= '0' && *i <= '9'; i++) {
+			usec += (*i - '0') * scale;
+			scale /= 10;
+		}
+	}
+
+	/* Time zone, as "Z", "+HH:MM" or "+HHMM"; a time without one is local, which is left to GLib */
+	if (i < end && (*i == 'Z' || *i == 'z')) {
+		i++;
+	} else if (i < end && (*i == '+' || *i == '-')) {
+		gint offset_hours, offset_minutes;
+		gchar sign = *i;
+
+		if (end - i >= 6 && i[3] == ':') {
+			offset_hours = parse_digits (i + 1, 2);
+			offset_minutes = parse_digits (i + 4, 2);
+			i += 6;
+		} else if (end - i >= 5) {
+			offset_hours = parse_digits (i + 1, 2);
+			offset_minutes = parse_digits (i + 3, 2);
+			i += 5;
+		} else {
+			return FALSE;
+		}
+
+		if (offset_hours < 0 || offset_minutes < 0)
+			return FALSE;
+
+		offset = (offset_hours * 60 + offset_minutes) * 60;
+		if (sign == '-')
+			offset = -offset;
+	} else {
+		return FALSE;
+	}
+
+	if (i != end)
+		return FALSE;
+
+	_time->tv_sec = days * 86400 + hour * 3600 + minute * 60 + second - offset;
+	_time->tv_usec = usec;
+
+	return TRUE;
+}
+
+/* The last string parsed by gdata_parser_time_val_from_iso8601_len() in each thread, and its result. Entries in a feed often share
+ * timestamps (e.g. an entry's <published> and <updated> times), so the last one is kept to save parsing it again. */
+#define TIME_VAL_CACHE_SIZE 64
+
+typedef struct {
+	gchar string[TIME_VAL_CACHE_SIZE];
+	gsize length;
+	GTimeVal time_val;
+} TimeValCache;
+
+static GStaticPrivate time_val_cache = G_STATIC_PRIVATE_INIT;
+
+/*
+ * gdata_parser_time_val_from_iso8601:
+ * @string: an RFC 3339 date and time
+ * @_time: return location for the parsed time
+ *
+ * Parses a nul-terminated RFC 3339 date and time. See gdata_parser_time_val_from_iso8601_len().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ */
+gboolean
+gdata_parser_time_val_from_iso8601 (const gchar *string, GTimeVal *_time)
+{
+	return gdata_parser_time_val_from_iso8601_len (string, -1, _time);
+}
+
+/*
+ * gdata_parser_time_val_from_iso8601_len:
+ * @string: an RFC 3339 date and time
+ * @length: the length of @string, or -1 if it's nul-terminated
+ * @_time: return location for the parsed time
+ *
+ * Parses an RFC 3339 date and time (e.g. "2009-04-05T12:34:56.789Z" or "2009-04-05T12:34:56+01:00") without allocating any memory. Strings
+ * which aren't in that fixed format are passed to g_time_val_from_iso8601(), so any ISO 8601 string it accepts is still accepted.
+ *
+ * The last string successfully parsed in each thread is remembered, and its time returned straight away if it's parsed again.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ */
+gboolean
+gdata_parser_time_val_from_iso8601_len (const gchar *string, gssize length, GTimeVal *_time)
+{
+	TimeValCache *cache;
+	gboolean success, is_terminated = FALSE;
+
+	if (string == NULL)
+		return FALSE;
+
+	if (length < 0) {
+		length = strlen (string);
+		is_terminated = TRUE;
+	}
+
+	cache = g_static_private_get (&time_val_cache);
+	if (cache != NULL && cache->length == (gsize) length && memcmp (cache->string, string, length) == 0) {
+		*_time = cache->time_val;
+		return TRUE;
+	}
+
+	success = parse_rfc3339 (string, length, _time);
+
+	/* Leave anything unusual to GLib, which needs a nul-terminated string */
+	if (success == FALSE) {
+		if (is_terminated == TRUE) {
+			success = g_time_val_from_iso8601 (string, _time);
+		} else {
+			gchar *terminated_string = g_strndup (string, length);
+			success = g_time_val_from_iso8601 (terminated_string, _time);
+			g_free (terminated_string);
+		}
+	}
+
+	if (success == FALSE || length >= TIME_VAL_CACHE_SIZE)
+		return success;
+
+	if (cache == NULL) {
+		cache = g_new (TimeValCache, 1);
+		g_static_private_set (&time_val_cache, cache, g_free);
+	}
+
+	memcpy (cache->string, string, length);
+	cache->length = length;
+	cache->time_val = *_time;
+
+	return TRUE;
+}
+
 gboolean
 gdata_parser_time_val_from_date (const gchar *date, GTimeVal *_time)
 {
-	gchar *iso8601_date;
-	gboolean success;
+	gsize length;
+	glong days;
 
-	if (strlen (date) != 10 && strlen (date) != 8)
+	if (date == NULL)
 		return FALSE;
 
-	/* Note: This doesn't need translating, as it's outputting an ISO 8601 time string */
-	iso8601_date = g_strdup_printf ("%sT00:00:00Z", date);
-	success = g_time_val_from_iso8601 (iso8601_date, _time);
-	g_free (iso8601_date);
+	/* Only "YYYY-MM-DD" and "YYYYMMDD" are accepted */
+	length = strlen (date);
+	if (parse_date (date, length, &days) != length)
+		return FALSE;
+
+	_time->tv_sec = days * 86400;
+	_time->tv_usec = 0;
+
+	return TRUE;
+}
+
+static gchar *
+format_digits (gchar *buffer, glong value, guint n_digits)
+{
+	guint i;
+
+	for (i = n_digits; i > 0; i--) {
+		buffer[i - 1] = '0' + value % 10;
+		value /= 10;
+	}
 
-	return success;
+	return buffer + n_digits;
 }
 
+static gchar *
+format_date (gchar *buffer, glong days)
+{
+	glong year;
+	guint month, day;
+
+	civil_from_days (days, &year, &month, &day);
+
+	buffer = format_digits (buffer, year, 4);
+	*(buffer++) = '-';
+	buffer = format_digits (buffer, month, 2);
+	*(buffer++) = '-';
+	return format_digits (buffer, day, 2);
+}
+
+/* Splits the time into days since the epoch and seconds into the day, rounding towards the past */
+static glong
+split_time_val (const GTimeVal *_time, glong *seconds)
+{
+	glong days = _time->tv_sec / 86400;
+
+	*seconds = _time->tv_sec % 86400;
+	if (*seconds < 0) {
+		*seconds += 86400;
+		days--;
+	}
+
+	return days;
+}
+
+/*
+ * gdata_parser_date_from_time_val:
+ * @_time: the time to format
+ * @buffer: a buffer at least %GDATA_PARSER_ISO8601_BUFFER_SIZE bytes long
+ *
+ * Formats the date (in UTC) of @_time as "YYYY-MM-DD" into @buffer, without allocating any memory.
+ *
+ * Return value: @buffer
+ */
+const gchar *
+gdata_parser_date_from_time_val (const GTimeVal *_time, gchar *buffer)
+{
+	glong seconds;
+
+	*format_date (buffer, split_time_val (_time, &seconds)) = '\0';
+
+	return buffer;
+}
+
+/*
+ * gdata_parser_iso8601_from_time_val:
+ * @_time: the time to format
+ * @buffer: a buffer at least %GDATA_PARSER_ISO8601_BUFFER_SIZE bytes long
+ *
+ * Formats @_time as an RFC 3339 date and time in UTC into @buffer, without allocating any memory. The output is the same as that of
+ * g_time_val_to_iso8601().
+ *
+ * Return value: @buffer
+ */
+const gchar *
+gdata_parser_iso8601_from_time_val (const GTimeVal *_time, gchar *buffer)
+{
+	glong seconds;
+	gchar *i;
+
+	i = format_date (buffer, split_time_val (_time, &seconds));
+	*(i++) = 'T';
+	i = format_digits (i, seconds / 3600, 2);
+	*(i++) = ':';
+	i = format_digits (i, (seconds / 60) % 60, 2);
+	*(i++) = ':';
+	i = format_digits (i, seconds % 60, 2);
+
+	if (_time->tv_usec != 0) {
+		*(i++) = '.';
+		i = format_digits (i, _time->tv_usec, 6);
+	}
+
+	*(i++) = 'Z';
+	*i = '\0';
+
+	return buffer;
+}
+
+/*
+ * gdata_parser_get_property:
+ * @element: the element to get the attribute from
+ * @property_name: the name of the attribute
+ *
+ * Returns the value of the attribute as a newly-allocated string which can be freed with g_free(), or %NULL if the attribute isn't present.
+ * Unlike copying the result of xmlGetProp(), the value is only copied once in the common case that it's held in a single text node.
+ */
+gchar *
+gdata_parser_get_property (xmlNode *element, const gchar *property_name)
+{
+	xmlAttr *attr;
+
+	for (attr = element->properties; attr != NULL; attr = attr->next) {
+		xmlChar *value;
+		gchar *retval;
+
+		if (xmlStrcmp (attr->name, (xmlChar*) property_name) != 0)
+			continue;
+
+		if (attr->children == NULL)
+			return g_strdup ("");
+		if (attr->children->next == NULL && attr->children->type == XML_TEXT_NODE)
+			return g_strdup ((gchar*) attr->children->content);
+
+		/* The value contains entity references, so has to be built up */
+		value = xmlNodeListGetString (element->doc, attr->children, TRUE);
+		retval = g_strdup ((gchar*) value);
+		xmlFree (value);
+
+		return retval;
+	}
+
+	return NULL;
+}
+
+/*
+ * gdata_parser_get_content:
+ * @element: the element to get the content of
+ *
+ * Returns the text content of the element as a newly-allocated string which can be freed with g_free(), or %NULL if it's empty. As with
+ * gdata_parser_get_property(), the content is only copied once if it's held in a single text node.
+ */
 gchar *
-gdata_parser_date_from_time_val (GTimeVal *_time)
+gdata_parser_get_content (xmlNode *element)
 {
-	time_t secs;
-	struct tm *tm;
+	xmlNode *child = element->children;
+	xmlChar *content;
+	gchar *retval;
+
+	if (child == NULL)
+		return NULL;
+	if (child->next == NULL && (child->type == XML_TEXT_NODE || child->type == XML_CDATA_SECTION_NODE))
+		return g_strdup ((gchar*) child->content);
 
-	secs = _time->tv_sec;
-	tm = gmtime (&secs);
+	content = xmlNodeListGetString (element->doc, child, TRUE);
+	retval = g_strdup ((gchar*) content);
+	xmlFree (content);
 
-	/* Note: This doesn't need translating, as it's outputting an ISO 8601 date string */
-	return g_strdup_printf ("%4d-%02d-%02d", tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday);
+	return retval;
 }
@@ -31,22 +31,68 @@ G_BEGIN_DECLS
 #include "gdata-service.h"
 void _gdata_service_set_authenticated (GDataService *self, gboolean authenticated);
 guint _gdata_service_send_message (GDataService *self, SoupMessage *message, GError **error);
+void _gdata_service_cancel_message (GDataService *self, SoupMessage *message);
+typedef gboolean (*GDataServiceMessageCompleteFunc) (GDataService *self, SoupMessage *message, GSimpleAsyncResult *result,
+						     GCancellable *cancellable);
+void _gdata_service_queue_message (GDataService *self, SoupMessage *message, GSimpleAsyncResult *result, GCancellable *cancellable,
+				   GDataServiceMessageCompleteFunc complete_func);
+typedef void (*GDataServiceMessageResumeFunc) (SoupMessage *message, gpointer user_data);
+void _gdata_service_delay_message (GDataService *self, SoupMessage *message, guint delay, GDataServiceMessageResumeFunc resume_func,
+				   gpointer user_data);
+typedef void (*GDataServiceMessageReadFunc) (SoupMessage *message, gchar *buffer, gssize length, GError *error, gpointer user_data);
+void _gdata_service_read_message_chunk (GDataService *self, SoupMessage *message, GInputStream *stream, gsize count, GCancellable *cancellable,
+					GDataServiceMessageReadFunc read_func, gpointer user_data);
+SoupBuffer *_gdata_service_map_file (GFile *file) G_GNUC_WARN_UNUSED_RESULT;
+typedef void (*GDataFeedNextUriFunc) (const gchar *next_uri, gpointer user_data);
+typedef void (*GDataServiceQueryPageCallback) (GDataService *self, GDataFeed *feed, GError *error, gpointer user_data);
+void _gdata_service_query_page_async (GDataService *self, const gchar *page_uri, GDataQuery *query, GType entry_type, GMainContext *progress_context,
+				      GDataFeedNextUriFunc next_uri_func, GDataServiceQueryPageCallback callback, gpointer user_data);
 
 #include "gdata-query.h"
 void _gdata_query_set_next_uri (GDataQuery *self, const gchar *next_uri);
 void _gdata_query_set_previous_uri (GDataQuery *self, const gchar *previous_uri);
+gchar *_gdata_query_get_query_uri_for_page (GDataQuery *self, const gchar *feed_uri, gint start_index, gint max_results) G_GNUC_WARN_UNUSED_RESULT;
+GDataQueryBatchProgressCallback _gdata_query_get_batch_progress_callback (GDataQuery *self, gpointer *user_data);
 
 #include "gdata-parsable.h"
+/* How a GDataParsable keeps XML elements which its class doesn't handle, so that they can be included when it's serialised again */
+typedef enum {
+	GDATA_PARSABLE_UNKNOWN_XML_SERIALISE = 0, /* serialise each element straight away */
+	GDATA_PARSABLE_UNKNOWN_XML_DEFER, /* keep a copy of each element, and only serialise them when they're needed */
+	GDATA_PARSABLE_UNKNOWN_XML_DROP /* ignore the elements */
+} GDataParsableUnknownXml;
+
 GDataParsable *_gdata_parsable_new_from_xml (GType parsable_type, const gchar *first_element, const gchar *xml, gint length, gpointer user_data,
 					     GError **error) G_GNUC_WARN_UNUSED_RESULT;
-GDataParsable *_gdata_parsable_new_from_xml_node (GType parsable_type, const gchar *first_element, xmlDoc *doc, xmlNode *node, gpointer user_data,
-						  GError **error) G_GNUC_WARN_UNUSED_RESULT;
+GDataParsable *_gdata_parsable_new_from_xml_node (GType parsable_type, const gchar *first_element, GDataParsableUnknownXml unknown_xml,
+						  xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error) G_GNUC_WARN_UNUSED_RESULT;
 const gchar *_gdata_parsable_get_extra_xml (GDataParsable *self);
 GHashTable *_gdata_parsable_get_extra_namespaces (GDataParsable *self);
+void _gdata_parsable_set_unknown_xml (GDataParsable *self, GDataParsableUnknownXml unknown_xml);
+GDataParsableUnknownXml _gdata_parsable_get_unknown_xml (GDataParsable *self);
+
+typedef struct _GDataParsableStream GDataParsableStream;
+typedef gboolean (*GDataParsableStreamChildFunc) (xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error);
+GDataParsableStream *_gdata_parsable_stream_new (GType parsable_type, const gchar *first_element, gpointer user_data,
+						 GDestroyNotify user_data_destroy) G_GNUC_WARN_UNUSED_RESULT;
+GDataParsableStream *_gdata_parsable_stream_new_for_children (const gchar *first_element, GDataParsableStreamChildFunc child_func,
+							      gpointer user_data, GDestroyNotify user_data_destroy) G_GNUC_WARN_UNUSED_RESULT;
+gboolean _gdata_parsable_stream_push (GDataParsableStream *self, const gchar *data, gsize length, GError **error);
+GDataParsable *_gdata_parsable_stream_finish (GDataParsableStream *self, GError **error) G_GNUC_WARN_UNUSED_RESULT;
+gboolean _gdata_parsable_stream_end (GDataParsableStream *self, GError **error);
+gpointer _gdata_parsable_stream_get_user_data (GDataParsableStream *self);
+xmlDoc *_gdata_parsable_stream_steal_document (GDataParsableStream *self) G_GNUC_WARN_UNUSED_RESULT;
+void _gdata_parsable_stream_free (GDataParsableStream *self);
 
 #include "gdata-feed.h"
 GDataFeed *_gdata_feed_new_from_xml (GType feed_type, const gchar *xml, gint length, GType entry_type,
 				     GDataQueryProgressCallback progress_callback, gpointer progress_user_data, GError **error) G_GNUC_WARN_UNUSED_RESULT;
+GDataParsableStream *_gdata_feed_stream_new (GType feed_type, GType entry_type, GDataQuery *query, guint entry_offset, gboolean whole_feed,
+					     GDataQueryProgressCallback progress_callback, gpointer progress_user_data) G_GNUC_WARN_UNUSED_RESULT;
+void _gdata_feed_stream_set_next_uri_func (GDataParsableStream *stream, GDataFeedNextUriFunc next_uri_func, gpointer user_data);
+void _gdata_feed_stream_set_progress_context (GDataParsableStream *stream, GMainContext *context);
+void _gdata_feed_append_entries (GDataFeed *self, GDataFeed *other);
+guint _gdata_feed_get_n_parsed_entries (GDataFeed *self);
 
 #include "gdata-entry.h"
 GDataEntry *_gdata_entry_new_from_xml (GType entry_type, const gchar *xml, gint length, GError **error) G_GNUC_WARN_UNUSED_RESULT;
@@ -59,8 +105,26 @@ gboolean gdata_parser_error_unknown_property_value (xmlNode *element, const gcha
 gboolean gdata_parser_error_required_property_missing (xmlNode *element, const gchar *property_name, GError **error);
 gboolean gdata_parser_error_required_element_missing (const gchar *element_name, const gchar *parent_element_name, GError **error);
 gboolean gdata_parser_error_duplicate_element (xmlNode *element, GError **error);
+gboolean gdata_parser_time_val_from_iso8601 (const gchar *string, GTimeVal *_time);
+gboolean gdata_parser_time_val_from_iso8601_len (const gchar *string, gssize length, GTimeVal *_time);
 gboolean gdata_parser_time_val_from_date (const gchar *date, GTimeVal *_time);
-gchar *gdata_parser_date_from_time_val (GTimeVal *_time) G_GNUC_WARN_UNUSED_RESULT;
+#define GDATA_PARSER_ISO8601_BUFFER_SIZE 28 /* "YYYY-MM-DDTHH:MM:SS.uuuuuuZ" and a nul */
+const gchar *gdata_parser_date_from_time_val (const GTimeVal *_time, gchar *buffer);
+const gchar *gdata_parser_iso8601_from_time_val (const GTimeVal *_time, gchar *buffer);
+gchar *gdata_parser_get_property (xmlNode *element, const gchar *property_name) G_GNUC_WARN_UNUSED_RESULT;
+gchar *gdata_parser_get_content (xmlNode *element) G_GNUC_WARN_UNUSED_RESULT;
+
+#include "gdata-atom.h"
+GDataCategory *_gdata_category_new_take (gchar *term, gchar *scheme, gchar *label) G_GNUC_WARN_UNUSED_RESULT;
+GDataLink *_gdata_link_new_take (gchar *href, gchar *rel, gchar *type, gchar *hreflang, gchar *title, gint length) G_GNUC_WARN_UNUSED_RESULT;
+GHashTable *_gdata_link_index_new (GList *links) G_GNUC_WARN_UNUSED_RESULT;
+GDataAuthor *_gdata_author_new_take (gchar *name, gchar *uri, gchar *email) G_GNUC_WARN_UNUSED_RESULT;
+
+#include "services/youtube/gdata-youtube-service.h"
+typedef guint (*GDataYouTubeUploadThrottleFunc) (gsize length, gpointer user_data);
+void _gdata_youtube_service_upload_video_async (GDataYouTubeService *self, GDataYouTubeVideo *video, GFile *video_file,
+						GDataYouTubeUploadThrottleFunc throttle_func, gpointer throttle_data, GCancellable *cancellable,
+						GAsyncReadyCallback callback, gpointer user_data);
 
 G_END_DECLS
 
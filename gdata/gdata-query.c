@@ -37,6 +37,7 @@
 #include "gdata-query.h"
 #include "gdata-private.h"
 #include "gdata-types.h"
+#include "gdata-enums.h"
 
 typedef enum {
 	GDATA_QUERY_PARAM_Q = 1 << 0,
@@ -80,6 +81,10 @@ struct _GDataQueryPrivate {
 	gboolean use_previous_uri;
 
 	gchar *etag;
+	GDataQueryFlags flags;
+
+	GDataQueryBatchProgressCallback batch_progress_callback;
+	gpointer batch_progress_user_data;
 };
 
 enum {
@@ -94,7 +99,8 @@ enum {
 	PROP_IS_STRICT,
 	PROP_MAX_RESULTS,
 	PROP_ENTRY_ID,
-	PROP_ETAG
+	PROP_ETAG,
+	PROP_FLAGS
 };
 
 G_DEFINE_TYPE (GDataQuery, gdata_query, G_TYPE_OBJECT)
@@ -285,6 +291,20 @@ gdata_query_class_init (GDataQueryClass *klass)
 					"ETag", "An ETag against which to check.",
 					NULL,
 					G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataQuery:flags:
+	 *
+	 * Flags affecting how the results of the query are handled once they've been received, such as %GDATA_QUERY_FLAGS_LAZY_ENTRIES.
+	 * They aren't included in the query URI.
+	 *
+	 * Since: 0.4.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_FLAGS,
+				g_param_spec_flags ("flags",
+					"Flags", "Flags affecting how the results of the query are handled.",
+					GDATA_TYPE_QUERY_FLAGS, GDATA_QUERY_FLAGS_NONE,
+					G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -356,6 +376,9 @@ gdata_query_get_property (GObject *object, guint property_id, GValue *value, GPa
 		case PROP_ETAG:
 			g_value_set_string (value, priv->etag);
 			break;
+		case PROP_FLAGS:
+			g_value_set_flags (value, priv->flags);
+			break;
 		default:
 			/* We don't have any other property... */
 			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -405,6 +428,9 @@ gdata_query_set_property (GObject *object, guint property_id, const GValue *valu
 		case PROP_ETAG:
 			gdata_query_set_etag (self, g_value_get_string (value));
 			break;
+		case PROP_FLAGS:
+			gdata_query_set_flags (self, g_value_get_flags (value));
+			break;
 		default:
 			/* We don't have any other property... */
 			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -1086,6 +1112,71 @@ gdata_query_set_etag (GDataQuery *self, const gchar *etag)
 	g_object_notify (G_OBJECT (self), "etag");
 }
 
+/**
+ * gdata_query_get_flags:
+ * @self: a #GDataQuery
+ *
+ * Gets the #GDataQuery:flags property.
+ *
+ * Return value: the query's flags
+ *
+ * Since: 0.4.0
+ **/
+GDataQueryFlags
+gdata_query_get_flags (GDataQuery *self)
+{
+	g_return_val_if_fail (GDATA_IS_QUERY (self), GDATA_QUERY_FLAGS_NONE);
+	return self->priv->flags;
+}
+
+/**
+ * gdata_query_set_flags:
+ * @self: a #GDataQuery
+ * @flags: the new flags
+ *
+ * Sets the #GDataQuery:flags property of the #GDataQuery to @flags.
+ *
+ * Since: 0.4.0
+ **/
+void
+gdata_query_set_flags (GDataQuery *self, GDataQueryFlags flags)
+{
+	g_return_if_fail (GDATA_IS_QUERY (self));
+
+	self->priv->flags = flags;
+	g_object_notify (G_OBJECT (self), "flags");
+}
+
+/**
+ * gdata_query_set_batch_progress_callback:
+ * @self: a #GDataQuery
+ * @callback: a #GDataQueryBatchProgressCallback, or %NULL
+ * @user_data: data to pass to @callback
+ *
+ * Sets a callback to be called with batches of the entries as they're parsed when @self is used to query a service, in addition to any
+ * #GDataQueryProgressCallback passed to the query function. Each call is passed a bounded number of entries, so a large feed doesn't hold
+ * up the main loop. Passing %NULL for @callback removes the callback.
+ *
+ * Since: 0.4.0
+ **/
+void
+gdata_query_set_batch_progress_callback (GDataQuery *self, GDataQueryBatchProgressCallback callback, gpointer user_data)
+{
+	g_return_if_fail (GDATA_IS_QUERY (self));
+
+	self->priv->batch_progress_callback = callback;
+	self->priv->batch_progress_user_data = user_data;
+}
+
+GDataQueryBatchProgressCallback
+_gdata_query_get_batch_progress_callback (GDataQuery *self, gpointer *user_data)
+{
+	g_return_val_if_fail (GDATA_IS_QUERY (self), NULL);
+
+	*user_data = self->priv->batch_progress_user_data;
+	return self->priv->batch_progress_callback;
+}
+
 void
 _gdata_query_set_next_uri (GDataQuery *self, const gchar *next_uri)
 {
@@ -1106,6 +1197,34 @@ _gdata_query_set_previous_uri (GDataQuery *self, const gchar *previous_uri)
 	self->priv->use_previous_uri = FALSE;
 }
 
+/* Builds the query URI for the page of results starting at @start_index, with at most @max_results results, ignoring any pagination URIs.
+ * The query's own properties are left untouched (and no notifications are emitted). */
+gchar *
+_gdata_query_get_query_uri_for_page (GDataQuery *self, const gchar *feed_uri, gint start_index, gint max_results)
+{
+	GDataQueryPrivate *priv = self->priv;
+	guint parameter_mask = priv->parameter_mask;
+	gint old_start_index = priv->start_index, old_max_results = priv->max_results;
+	gboolean use_next_uri = priv->use_next_uri, use_previous_uri = priv->use_previous_uri;
+	gchar *query_uri;
+
+	priv->start_index = start_index;
+	priv->max_results = max_results;
+	priv->parameter_mask |= GDATA_QUERY_PARAM_START_INDEX | GDATA_QUERY_PARAM_MAX_RESULTS;
+	priv->use_next_uri = FALSE;
+	priv->use_previous_uri = FALSE;
+
+	query_uri = gdata_query_get_query_uri (self, feed_uri);
+
+	priv->start_index = old_start_index;
+	priv->max_results = old_max_results;
+	priv->parameter_mask = parameter_mask;
+	priv->use_next_uri = use_next_uri;
+	priv->use_previous_uri = use_previous_uri;
+
+	return query_uri;
+}
+
 /**
  * gdata_query_next_page:
  * @self: a #GDataQuery
@@ -23,8 +23,59 @@
 #include <glib.h>
 #include <glib-object.h>
 
+#include <gdata/gdata-entry.h>
+
 G_BEGIN_DECLS
 
+/**
+ * GDataQueryFlags:
+ * @GDATA_QUERY_FLAGS_NONE: no flags
+ * @GDATA_QUERY_FLAGS_LAZY_ENTRIES: only build each #GDataEntry in the resulting #GDataFeed when it's first accessed; entries which can't be
+ * parsed are then returned as %NULL by gdata_feed_get_entry_at() (keeping the indices of the other entries), and since accessing an entry
+ * modifies the feed, the feed must only be accessed from one thread at a time
+ * @GDATA_QUERY_FLAGS_PARALLEL_ENTRIES: build the entries in the resulting #GDataFeed on several threads at once; this has no effect if
+ * %GDATA_QUERY_FLAGS_LAZY_ENTRIES is also set
+ * @GDATA_QUERY_FLAGS_DEFER_UNKNOWN_XML: keep XML elements which libgdata doesn't understand without serialising them, until the object
+ * containing them is serialised
+ * @GDATA_QUERY_FLAGS_DROP_UNKNOWN_XML: ignore XML elements which libgdata doesn't understand; they won't be sent back to the server if
+ * the resulting entries are updated. This takes precedence over %GDATA_QUERY_FLAGS_DEFER_UNKNOWN_XML
+ * @GDATA_QUERY_FLAGS_SYNCHRONOUS_PROGRESS: call the query's progress callbacks straight away in the thread which parsed each entry, rather
+ * than from the thread-default main context of the thread which made the query; the callbacks are never called concurrently
+ * @GDATA_QUERY_FLAGS_DISCARD_ENTRIES: release each entry once it's been passed to the query's progress callbacks, rather than adding it to
+ * the resulting #GDataFeed, which will then only contain the feed's own properties and links; this has no effect if the query has no
+ * progress callbacks
+ *
+ * Flags affecting how the results of a query are handled once they've been received. They don't affect the query URI.
+ *
+ * Since: 0.4.0
+ **/
+typedef enum {
+	GDATA_QUERY_FLAGS_NONE = 0,
+	GDATA_QUERY_FLAGS_LAZY_ENTRIES = 1 << 0,
+	GDATA_QUERY_FLAGS_PARALLEL_ENTRIES = 1 << 1,
+	GDATA_QUERY_FLAGS_DEFER_UNKNOWN_XML = 1 << 2,
+	GDATA_QUERY_FLAGS_DROP_UNKNOWN_XML = 1 << 3,
+	GDATA_QUERY_FLAGS_SYNCHRONOUS_PROGRESS = 1 << 4,
+	GDATA_QUERY_FLAGS_DISCARD_ENTRIES = 1 << 5
+} GDataQueryFlags;
+
+/**
+ * GDataQueryBatchProgressCallback:
+ * @entries: an array of new #GDataEntry<!-- -->s
+ * @entry_keys: an array of the keys of the entries (zero-based indices of their positions in the feed)
+ * @n_entries: the number of entries in @entries and @entry_keys
+ * @entry_count: the total number of entries in the feed
+ * @user_data: user data passed to the callback
+ *
+ * Callback function called with batches of the #GDataEntry<!-- -->s parsed in a #GDataFeed when loading the results of a query. It's an
+ * alternative to #GDataQueryProgressCallback for use when there are many entries, and gives the same guarantees. The entries aren't
+ * necessarily in feed order. Neither array is owned by the callback, and the entries should be reffed if they need to be kept.
+ *
+ * Since: 0.4.0
+ **/
+typedef void (*GDataQueryBatchProgressCallback) (GDataEntry **entries, const guint *entry_keys, guint n_entries, guint entry_count,
+						 gpointer user_data);
+
 #define GDATA_TYPE_QUERY		(gdata_query_get_type ())
 #define GDATA_QUERY(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_QUERY, GDataQuery))
 #define GDATA_QUERY_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_QUERY, GDataQueryClass))
@@ -90,6 +141,9 @@ const gchar *gdata_query_get_entry_id (GDataQuery *self);
 void gdata_query_set_entry_id (GDataQuery *self, const gchar *entry_id);
 const gchar *gdata_query_get_etag (GDataQuery *self);
 void gdata_query_set_etag (GDataQuery *self, const gchar *etag);
+GDataQueryFlags gdata_query_get_flags (GDataQuery *self);
+void gdata_query_set_flags (GDataQuery *self, GDataQueryFlags flags);
+void gdata_query_set_batch_progress_callback (GDataQuery *self, GDataQueryBatchProgressCallback callback, gpointer user_data);
 
 G_END_DECLS
 
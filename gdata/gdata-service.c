@@ -31,8 +31,11 @@
 #include <config.h>
 #include <glib.h>
 #include <glib/gi18n-lib.h>
+#include <glib/gstdio.h>
 #include <libsoup/soup.h>
 #include <string.h>
+#include <stdio.h>
+#include <unistd.h>
 
 #ifdef HAVE_GNOME
 #include <libsoup/soup-gnome-features.h>
@@ -58,6 +61,65 @@ gdata_authentication_error_quark (void)
 	return g_quark_from_static_string ("gdata-authentication-error-quark");
 }
 
+/* Asynchronous operations are all run in a single I/O thread, shared between all services, which drives each service's asynchronous
+ * SoupSession. This means the number of threads doesn't grow with the number of operations in flight. */
+static gpointer
+io_thread_func (GMainLoop *loop)
+{
+	/* Asynchronous GIO operations started from the I/O thread (such as reading request bodies) complete in its thread-default context */
+	g_main_context_push_thread_default (g_main_loop_get_context (loop));
+	g_main_loop_run (loop);
+	return NULL;
+}
+
+static gpointer
+io_context_init (gpointer data)
+{
+	GMainContext *context;
+	GMainLoop *loop;
+
+	/* If threading isn't available, fall back to running the asynchronous operations in the default main context */
+	if (g_thread_supported () == FALSE)
+		return g_main_context_default ();
+
+	context = g_main_context_new ();
+	loop = g_main_loop_new (context, FALSE);
+	g_thread_create ((GThreadFunc) io_thread_func, loop, FALSE, NULL);
+
+	return context;
+}
+
+static GMainContext *
+get_io_context (void)
+{
+	static GOnce io_context_once = G_ONCE_INIT;
+	g_once (&io_context_once, io_context_init, NULL);
+	return io_context_once.retval;
+}
+
+static void
+io_invoke (GSourceFunc function, gpointer data)
+{
+	GSource *source;
+
+	/* Run the given function in the I/O thread */
+	source = g_idle_source_new ();
+	g_source_set_callback (source, function, data, NULL);
+	g_source_attach (source, get_io_context ());
+	g_source_unref (source);
+}
+
+/* The number of asynchronous operations which may be in flight at once across all services, if it hasn't been changed */
+#define DEFAULT_MAX_TOTAL_OPERATIONS 32
+
+/* Asynchronous operations wait in a single queue, shared between all services, until they're admitted to run. An operation is admitted once
+ * fewer than max_total_operations are running in total and fewer than its service's #GDataService:max-operations are running for that
+ * service. Operations are admitted in the order they were queued, except that one which is blocked by its service's limit doesn't hold up
+ * those from other services behind it. The queue and counts are only accessed from the I/O thread. */
+static GQueue pending_operations = G_QUEUE_INIT;
+static guint n_running_operations = 0;
+static volatile gint max_total_operations = DEFAULT_MAX_TOTAL_OPERATIONS;
+
 static void gdata_service_dispose (GObject *object);
 static void gdata_service_finalize (GObject *object);
 static void gdata_service_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
@@ -70,12 +132,18 @@ static void notify_proxy_uri_cb (GObject *gobject, GParamSpec *pspec, GObject *s
 
 struct _GDataServicePrivate {
 	SoupSession *session;
+	SoupSession *async_session;
 
 	gchar *username;
 	gchar *password;
 	gchar *auth_token;
 	gchar *client_id;
 	gboolean authenticated;
+	gchar *cache_directory;
+
+	/* The limit is set from any thread; the count is only accessed from the I/O thread */
+	volatile gint max_operations;
+	guint n_running_operations;
 };
 
 enum {
@@ -83,7 +151,9 @@ enum {
 	PROP_USERNAME,
 	PROP_PASSWORD,
 	PROP_AUTHENTICATED,
-	PROP_PROXY_URI
+	PROP_PROXY_URI,
+	PROP_CACHE_DIRECTORY,
+	PROP_MAX_OPERATIONS
 };
 
 enum {
@@ -174,6 +244,41 @@ gdata_service_class_init (GDataServiceClass *klass)
 					SOUP_TYPE_URI,
 					G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+	/**
+	 * GDataService:cache-directory:
+	 *
+	 * A directory in which to cache query responses, or %NULL to disable caching. If set, the response to each query is stored in the
+	 * directory along with its ETag, and is automatically revalidated with the server the next time the same query is run. If the server
+	 * indicates that the feed hasn't changed, the feed is built from the cached response rather than being downloaded again.
+	 *
+	 * The directory will be created if it doesn't exist. It may be shared between several services (and processes), but as it may
+	 * contain private feeds, it should not be readable by other users.
+	 *
+	 * Since: 0.4.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_CACHE_DIRECTORY,
+				g_param_spec_string ("cache-directory",
+					"Cache directory", "A directory in which to cache query responses.",
+					NULL,
+					G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:max-operations:
+	 *
+	 * The maximum number of the service's asynchronous operations which may be in flight at once, or %0 for no per-service limit.
+	 *
+	 * Asynchronous operations beyond this limit (or beyond the library-wide limit set with gdata_service_set_max_total_operations())
+	 * are queued, and are started in order as earlier operations finish. Operations which are cancelled while queued are completed
+	 * without ever being sent.
+	 *
+	 * Since: 0.4.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_MAX_OPERATIONS,
+				g_param_spec_uint ("max-operations",
+					"Maximum operations", "The maximum number of the service's asynchronous operations in flight at once.",
+					0, G_MAXUINT, 0,
+					G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
 	/**
 	 * GDataService::captcha-challenge:
 	 * @service: the #GDataService which received the challenge
@@ -200,8 +305,12 @@ gdata_service_init (GDataService *self)
 	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_SERVICE, GDataServicePrivate);
 	self->priv->session = soup_session_sync_new ();
 
+	/* Asynchronous operations are queued on a separate session, which runs in the I/O thread's main context */
+	self->priv->async_session = soup_session_async_new_with_options (SOUP_SESSION_ASYNC_CONTEXT, get_io_context (), NULL);
+
 #ifdef HAVE_GNOME
 	soup_session_add_feature_by_type (self->priv->session, SOUP_TYPE_GNOME_FEATURES_2_26);
+	soup_session_add_feature_by_type (self->priv->async_session, SOUP_TYPE_GNOME_FEATURES_2_26);
 #endif /* HAVE_GNOME */
 
 	/* Proxy the SoupSession's proxy-uri property */
@@ -217,6 +326,10 @@ gdata_service_dispose (GObject *object)
 		g_object_unref (priv->session);
 	priv->session = NULL;
 
+	if (priv->async_session != NULL)
+		g_object_unref (priv->async_session);
+	priv->async_session = NULL;
+
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS (gdata_service_parent_class)->dispose (object);
 }
@@ -230,6 +343,7 @@ gdata_service_finalize (GObject *object)
 	g_free (priv->password);
 	g_free (priv->auth_token);
 	g_free (priv->client_id);
+	g_free (priv->cache_directory);
 
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS (gdata_service_parent_class)->finalize (object);
@@ -256,6 +370,12 @@ gdata_service_get_property (GObject *object, guint property_id, GValue *value, G
 		case PROP_PROXY_URI:
 			g_value_set_boxed (value, gdata_service_get_proxy_uri (GDATA_SERVICE (object)));
 			break;
+		case PROP_CACHE_DIRECTORY:
+			g_value_set_string (value, priv->cache_directory);
+			break;
+		case PROP_MAX_OPERATIONS:
+			g_value_set_uint (value, (guint) g_atomic_int_get (&(priv->max_operations)));
+			break;
 		default:
 			/* We don't have any other property... */
 			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -275,6 +395,12 @@ gdata_service_set_property (GObject *object, guint property_id, const GValue *va
 		case PROP_PROXY_URI:
 			gdata_service_set_proxy_uri (GDATA_SERVICE (object), g_value_get_boxed (value));
 			break;
+		case PROP_CACHE_DIRECTORY:
+			gdata_service_set_cache_directory (GDATA_SERVICE (object), g_value_get_string (value));
+			break;
+		case PROP_MAX_OPERATIONS:
+			gdata_service_set_max_operations (GDATA_SERVICE (object), g_value_get_uint (value));
+			break;
 		default:
 			/* We don't have any other property... */
 			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -389,164 +515,293 @@ real_parse_error_response (GDataService *self, GDataServiceError error_type, gui
 	}
 }
 
+/* An operation's complete_func is called in the I/O thread once its message has finished. It should process the response and set the result of
+ * the operation. If it returns %TRUE, the operation will be completed; otherwise, the function takes responsibility for completing it. */
 typedef struct {
-	/* Input */
-	gchar *username;
-	gchar *password;
+	volatile gint ref_count;
 
-	/* Output */
 	GDataService *service;
-	gboolean success;
-} AuthenticateAsyncData;
+	SoupMessage *message;
+	GSimpleAsyncResult *result;
+	GCancellable *cancellable;
+	gulong cancelled_signal;
+	GDataServiceMessageCompleteFunc complete_func;
+
+	/* These are only accessed from the I/O thread */
+	gboolean pending;
+	gboolean running;
+	gboolean queued;
+	gboolean redirected;
+
+	/* Set while the message is paused by _gdata_service_delay_message() */
+	GSource *delay_source;
+	GDataServiceMessageResumeFunc resume_func;
+	gpointer resume_data;
+
+	/* Set while the message is paused by _gdata_service_read_message_chunk(); cleared if the message finishes in the meantime */
+	struct _MessageRead *pending_read;
+} MessageOperation;
+
+/* A chunk of a message's request body which is being read asynchronously by _gdata_service_read_message_chunk() */
+typedef struct _MessageRead {
+	MessageOperation *operation;
+	gchar *buffer;
+	GDataServiceMessageReadFunc read_func;
+	gpointer read_data;
+} MessageRead;
+
+static MessageOperation *
+message_operation_ref (MessageOperation *self)
+{
+	g_atomic_int_inc (&(self->ref_count));
+	return self;
+}
 
 static void
-authenticate_async_data_free (AuthenticateAsyncData *self)
+message_operation_unref (MessageOperation *self)
 {
-	g_free (self->username);
-	g_free (self->password);
+	if (g_atomic_int_dec_and_test (&(self->ref_count)) == FALSE)
+		return;
 
-	g_slice_free (AuthenticateAsyncData, self);
+	g_object_unref (self->service);
+	g_object_unref (self->message);
+	g_object_unref (self->result);
+	if (self->cancellable != NULL)
+		g_object_unref (self->cancellable);
+
+	g_slice_free (MessageOperation, self);
 }
 
 static gboolean
-set_authentication_details_cb (AuthenticateAsyncData *data)
+set_redirect_uri (SoupMessage *message, GError **error)
 {
-	GObject *service = G_OBJECT (data->service);
-	GDataServicePrivate *priv = data->service->priv;
+	SoupURI *new_uri;
+	const gchar *new_location;
+
+	new_location = soup_message_headers_get_one (message->response_headers, "Location");
+	new_uri = (new_location != NULL) ? soup_uri_new_with_base (soup_message_get_uri (message), new_location) : NULL;
+	if (new_uri == NULL) {
+		g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+			     /* Translators: the parameter is the URI which is invalid. */
+			     _("Invalid redirect URI: %s"), (new_location != NULL) ? new_location : "");
+		return FALSE;
+	}
 
-	g_free (priv->username);
-	/* Ensure the username is always a full e-mail address */
-	if (strchr (data->username, '@') == NULL)
-		priv->username = g_strdup_printf ("%s@" EMAIL_DOMAIN, data->username);
-	else
-		priv->username = g_strdup (data->username);
+	soup_message_set_uri (message, new_uri);
+	soup_uri_free (new_uri);
 
-	g_free (priv->password);
-	priv->password = g_strdup (data->password);
-	priv->authenticated = TRUE;
+	return TRUE;
+}
 
-	g_object_freeze_notify (service);
-	g_object_notify (service, "username");
-	g_object_notify (service, "password");
-	g_object_notify (service, "authenticated");
-	g_object_thaw_notify (service);
+static void message_finished_cb (SoupSession *session, SoupMessage *message, MessageOperation *self);
 
-	authenticate_async_data_free (data);
+/* Messages being sent by asynchronous operations point to their MessageOperation with this quark, so that they can be cancelled by
+ * _gdata_service_cancel_message() */
+static GQuark
+message_operation_quark (void)
+{
+	return g_quark_from_static_string ("gdata-message-operation");
+}
+
+/* Messages which have had SOUP_MESSAGE_NO_REDIRECT set by queue_message(), rather than by the caller, are marked with this quark, so that
+ * message_finished_cb() knows to follow their redirects */
+static GQuark
+follow_redirect_quark (void)
+{
+	return g_quark_from_static_string ("gdata-follow-redirect");
+}
+
+static gboolean
+send_message_idle (MessageOperation *self)
+{
+	/* Don't bother sending the message if the operation's already been cancelled */
+	if (g_cancellable_is_cancelled (self->cancellable) == TRUE) {
+		message_finished_cb (self->service->priv->async_session, self->message, self);
+		return FALSE;
+	}
+
+	self->queued = TRUE;
+	g_object_set_qdata (G_OBJECT (self->message), message_operation_quark (), self);
+	soup_session_queue_message (self->service->priv->async_session, g_object_ref (self->message), (SoupSessionCallback) message_finished_cb, self);
 
 	return FALSE;
 }
 
+static gboolean
+operation_can_run (MessageOperation *self)
+{
+	guint max_operations = (guint) g_atomic_int_get (&(self->service->priv->max_operations));
+	return (max_operations == 0 || self->service->priv->n_running_operations < max_operations) ? TRUE : FALSE;
+}
+
+/* Start as many of the pending operations as the limits allow. This must be called from the I/O thread. */
 static void
-authenticate_thread (GSimpleAsyncResult *result, GDataService *service, GCancellable *cancellable)
+run_pending_operations (void)
 {
-	GError *error = NULL;
-	AuthenticateAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GList *i, *next;
 
-	/* Check to see if it's been cancelled already */
-	if (g_cancellable_set_error_if_cancelled (cancellable, &error) == TRUE) {
-		g_simple_async_result_set_from_error (result, error);
-		g_error_free (error);
-		authenticate_async_data_free (data);
-		return;
-	}
+	for (i = pending_operations.head; i != NULL; i = next) {
+		MessageOperation *operation = i->data;
+		guint max_total = (guint) g_atomic_int_get (&max_total_operations);
 
-	/* Authenticate and return */
-	data->success = gdata_service_authenticate (service, data->username, data->password, cancellable, &error);
-	if (data->success == FALSE) {
-		g_simple_async_result_set_from_error (result, error);
-		g_error_free (error);
-		authenticate_async_data_free (data);
-		return;
+		if (max_total != 0 && n_running_operations >= max_total)
+			break;
+
+		next = i->next;
+		if (operation_can_run (operation) == FALSE)
+			continue;
+
+		g_queue_delete_link (&pending_operations, i);
+		operation->pending = FALSE;
+		operation->running = TRUE;
+		operation->service->priv->n_running_operations++;
+		n_running_operations++;
+
+		send_message_idle (operation);
 	}
+}
 
-	/* Update the authentication details held by the service */
-	data->service = service;
-	g_idle_add ((GSourceFunc) set_authentication_details_cb, data);
+static gboolean
+run_pending_operations_idle (gpointer data)
+{
+	run_pending_operations ();
+	return FALSE;
 }
 
-/**
- * gdata_service_authenticate_async:
- * @self: a #GDataService
- * @username: the user's username
- * @password: the user's password
- * @cancellable: optional #GCancellable object, or %NULL
- * @callback: a #GAsyncReadyCallback to call when authentication is finished
- * @user_data: data to pass to the @callback function
- *
- * Authenticates the #GDataService with the online service using the given @username and @password. @self, @username and
- * @password are all reffed/copied when this function is called, so can safely be freed after this function returns.
- *
- * For more details, see gdata_service_authenticate(), which is the synchronous version of this function.
- *
- * When the operation is finished, @callback will be called. You can then call gdata_service_authenticate_finish()
- * to get the results of the operation.
- **/
-void
-gdata_service_authenticate_async (GDataService *self, const gchar *username, const gchar *password,
-				  GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+static gboolean
+queue_message_idle (MessageOperation *self)
 {
-	GSimpleAsyncResult *result;
-	AuthenticateAsyncData *data;
+	/* Don't bother queueing the operation if it's already been cancelled */
+	if (g_cancellable_is_cancelled (self->cancellable) == TRUE) {
+		message_finished_cb (self->service->priv->async_session, self->message, self);
+		return FALSE;
+	}
 
-	g_return_if_fail (GDATA_IS_SERVICE (self));
-	g_return_if_fail (username != NULL);
-	g_return_if_fail (password != NULL);
+	/* Otherwise, wait in the shared queue until the operation can be admitted */
+	self->pending = TRUE;
+	g_queue_push_tail (&pending_operations, self);
+	run_pending_operations ();
 
-	data = g_slice_new (AuthenticateAsyncData);
-	data->username = g_strdup (username);
-	data->password = g_strdup (password);
+	return FALSE;
+}
 
-	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_authenticate_async);
-	g_simple_async_result_set_op_res_gpointer (result, data, NULL);
-	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) authenticate_thread, G_PRIORITY_DEFAULT, cancellable);
-	g_object_unref (result);
+static gboolean
+cancel_message_idle (MessageOperation *self)
+{
+	/* The message may have finished (or be waiting to be re-queued after a redirect) by now */
+	if (self->pending == TRUE) {
+		/* It's never been sent, so just take it out of the queue and complete it */
+		g_queue_remove (&pending_operations, self);
+		self->pending = FALSE;
+		message_finished_cb (self->service->priv->async_session, self->message, self);
+	} else if (self->queued == TRUE) {
+		soup_session_cancel_message (self->service->priv->async_session, self->message, SOUP_STATUS_CANCELLED);
+	}
+	message_operation_unref (self);
+
+	return FALSE;
 }
 
-/**
- * gdata_service_authenticate_finish:
- * @self: a #GDataService
- * @async_result: a #GAsyncResult
- * @error: a #GError, or %NULL
- *
- * Finishes an asynchronous authentication operation started with gdata_service_authenticate_async().
- *
- * Return value: %TRUE if authentication was successful, %FALSE otherwise
- **/
-gboolean
-gdata_service_authenticate_finish (GDataService *self, GAsyncResult *async_result, GError **error)
+static void
+cancelled_cb (GCancellable *cancellable, MessageOperation *self)
 {
-	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
-	AuthenticateAsyncData *data;
+	io_invoke ((GSourceFunc) cancel_message_idle, message_operation_ref (self));
+}
 
-	g_return_val_if_fail (GDATA_IS_SERVICE (self), FALSE);
-	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+static void
+message_finished_cb (SoupSession *session, SoupMessage *message, MessageOperation *self)
+{
+	GError *error = NULL;
 
-	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_service_authenticate_async);
+	self->queued = FALSE;
+	g_object_set_qdata (G_OBJECT (message), message_operation_quark (), NULL);
 
-	if (g_simple_async_result_propagate_error (result, error) == TRUE)
-		return FALSE;
+	/* Don't resume the message if it was paused when it finished */
+	if (self->delay_source != NULL) {
+		g_source_destroy (self->delay_source);
+		g_source_unref (self->delay_source);
+		self->delay_source = NULL;
+	}
 
-	data = g_simple_async_result_get_op_res_gpointer (result);
-	if (data->success == TRUE)
-		return TRUE;
+	/* Nor pass it any chunk which is still being read; message_read_cb() frees the chunk once it's finished */
+	self->pending_read = NULL;
 
-	g_assert_not_reached ();
+	/* Follow one redirect, as _gdata_service_send_message() does for synchronous operations. The operation keeps its place among the
+	 * running operations while the redirect's sent. */
+	if (SOUP_STATUS_IS_REDIRECTION (message->status_code) && self->redirected == FALSE &&
+	    g_object_get_qdata (G_OBJECT (message), follow_redirect_quark ()) != NULL &&
+	    g_cancellable_is_cancelled (self->cancellable) == FALSE && set_redirect_uri (message, &error) == TRUE) {
+		self->redirected = TRUE;
+		io_invoke ((GSourceFunc) send_message_idle, self);
+		return;
+	}
+
+	/* Free up the operation's slot for the next pending one; it's started once this one's been completed */
+	if (self->running == TRUE) {
+		self->running = FALSE;
+		self->service->priv->n_running_operations--;
+		n_running_operations--;
+		io_invoke ((GSourceFunc) run_pending_operations_idle, NULL);
+	}
+
+	/* This waits for cancelled_cb() to return if it's running in another thread, so that it can't take a reference to the operation once
+	 * it's been freed */
+	if (self->cancelled_signal != 0) {
+		g_cancellable_disconnect (self->cancellable, self->cancelled_signal);
+		self->cancelled_signal = 0;
+	}
+
+	/* Process the response */
+	if (error == NULL && g_cancellable_set_error_if_cancelled (self->cancellable, &error) == FALSE &&
+	    self->complete_func (self->service, message, self->result, self->cancellable) == FALSE) {
+		message_operation_unref (self);
+		return;
+	}
+
+	if (error != NULL) {
+		g_simple_async_result_set_from_error (self->result, error);
+		g_error_free (error);
+	}
+
+	g_simple_async_result_complete_in_idle (self->result);
+	message_operation_unref (self);
 }
 
-static gboolean
-authenticate (GDataService *self, const gchar *username, const gchar *password, gchar *captcha_token, gchar *captcha_answer,
-	      GCancellable *cancellable, GError **error)
+/* Queue @message (taking ownership of it) to be sent asynchronously, once the service's and the library's limits on the number of operations
+ * in flight allow. Once it's finished, @complete_func will be called in the I/O thread to process the response and set @result's result. */
+static void
+queue_message (GDataService *self, SoupMessage *message, GSimpleAsyncResult *result, GCancellable *cancellable,
+	       GDataServiceMessageCompleteFunc complete_func)
+{
+	MessageOperation *operation;
+
+	operation = g_slice_new0 (MessageOperation);
+	operation->ref_count = 1;
+	operation->service = g_object_ref (self);
+	operation->message = message;
+	operation->result = g_object_ref (result);
+	operation->cancellable = (cancellable != NULL) ? g_object_ref (cancellable) : NULL;
+	operation->complete_func = complete_func;
+
+	/* libsoup only follows redirects for GET requests, so handle the others ourselves, unless the caller's set SOUP_MESSAGE_NO_REDIRECT to
+	 * handle 3xx responses itself */
+	if (message->method != SOUP_METHOD_GET && (soup_message_get_flags (message) & SOUP_MESSAGE_NO_REDIRECT) == 0) {
+		soup_message_set_flags (message, soup_message_get_flags (message) | SOUP_MESSAGE_NO_REDIRECT);
+		g_object_set_qdata (G_OBJECT (message), follow_redirect_quark (), GUINT_TO_POINTER (TRUE));
+	}
+
+	if (cancellable != NULL)
+		operation->cancelled_signal = g_cancellable_connect (cancellable, (GCallback) cancelled_cb, operation, NULL);
+
+	io_invoke ((GSourceFunc) queue_message_idle, operation);
+}
+
+static SoupMessage *
+build_authentication_message (GDataService *self, const gchar *username, const gchar *password, gchar *captcha_token, gchar *captcha_answer)
 {
-	GDataServicePrivate *priv = self->priv;
 	GDataServiceClass *klass;
 	SoupMessage *message;
 	gchar *request_body;
-	guint status;
-	gboolean retval;
-
-	g_return_val_if_fail (GDATA_IS_SERVICE (self), FALSE);
-	g_return_val_if_fail (username != NULL, FALSE);
-	g_return_val_if_fail (password != NULL, FALSE);
 
 	/* Prepare the request */
 	klass = GDATA_SERVICE_GET_CLASS (self);
@@ -554,7 +809,7 @@ authenticate (GDataService *self, const gchar *username, const gchar *password,
 					 "Email", username,
 					 "Passwd", password,
 					 "service", klass->service_name,
-					 "source", priv->client_id,
+					 "source", self->priv->client_id,
 					 (captcha_token == NULL) ? NULL : "logintoken", captcha_token,
 					 "loginanswer", captcha_answer,
 					 NULL);
@@ -567,16 +822,20 @@ authenticate (GDataService *self, const gchar *username, const gchar *password,
 	message = soup_message_new (SOUP_METHOD_POST, klass->authentication_uri);
 	soup_message_set_request (message, "application/x-www-form-urlencoded", SOUP_MEMORY_TAKE, request_body, strlen (request_body));
 
-	/* Send the message */
-	status = soup_session_send_message (priv->session, message);
+	return message;
+}
 
-	/* Check for cancellation */
-	if (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE) {
-		g_object_unref (message);
-		return FALSE;
-	}
+/* If the server requires a CAPTCHA to be completed, this returns %FALSE without setting @error, and returns the CAPTCHA's URI and token
+ * in @captcha_uri and @captcha_token so that authentication can be retried once the user's answered the CAPTCHA. */
+static gboolean
+process_authentication_response (GDataService *self, SoupMessage *message, const gchar *username, const gchar *password,
+				 gchar **captcha_uri, gchar **captcha_token, GError **error)
+{
+	GDataServicePrivate *priv = self->priv;
+	GDataServiceClass *klass = GDATA_SERVICE_GET_CLASS (self);
+	gboolean retval;
 
-	if (status != 200) {
+	if (message->status_code != 200) {
 		const gchar *response_body = message->response_body->data;
 		gchar *error_start, *error_end, *uri_start, *uri_end, *uri = NULL;
 
@@ -596,7 +855,7 @@ authenticate (GDataService *self, const gchar *username, const gchar *password,
 
 		if (strncmp (error_start, "CaptchaRequired", error_end - error_start) == 0) {
 			const gchar *captcha_base_uri = "http://www.google.com/accounts/";
-			gchar *captcha_start, *captcha_end, *captcha_uri, *new_captcha_answer;
+			gchar *captcha_start, *captcha_end, *token_start, *token_end;
 			guint captcha_base_uri_length;
 
 			/* CAPTCHA required to log in */
@@ -609,39 +868,27 @@ authenticate (GDataService *self, const gchar *username, const gchar *password,
 			if (captcha_end == NULL)
 				goto protocol_error;
 
-			/* Do some fancy memory stuff to save ourselves another alloc */
-			captcha_base_uri_length = strlen (captcha_base_uri);
-			captcha_uri = g_malloc (captcha_base_uri_length + (captcha_end - captcha_start) + 1);
-			memcpy (captcha_uri, captcha_base_uri, captcha_base_uri_length);
-			memcpy (captcha_uri + captcha_base_uri_length, captcha_start, (captcha_end - captcha_start));
-			captcha_uri[captcha_base_uri_length + (captcha_end - captcha_start)] = '\0';
-
-			/* Request a CAPTCHA answer from the application */
-			g_signal_emit (self, service_signals[SIGNAL_CAPTCHA_CHALLENGE], 0, captcha_uri, &new_captcha_answer);
-			g_free (captcha_uri);
-
-			if (new_captcha_answer == NULL || *new_captcha_answer == '\0') {
-				/* Translators: see http://en.wikipedia.org/wiki/CAPTCHA for information about CAPTCHAs */
-				g_set_error_literal (error, GDATA_AUTHENTICATION_ERROR, GDATA_AUTHENTICATION_ERROR_CAPTCHA_REQUIRED,
-						     _("A CAPTCHA must be filled out to log in."));
-				goto login_error;
-			}
-
 			/* Get the CAPTCHA token */
-			captcha_start = strstr (response_body, "CaptchaToken=");
-			if (captcha_start == NULL)
+			token_start = strstr (response_body, "CaptchaToken=");
+			if (token_start == NULL)
 				goto protocol_error;
-			captcha_start += strlen ("CaptchaToken=");
+			token_start += strlen ("CaptchaToken=");
 
-			captcha_end = strstr (captcha_start, "\n");
-			if (captcha_end == NULL)
+			token_end = strstr (token_start, "\n");
+			if (token_end == NULL)
 				goto protocol_error;
 
-			/* Save the CAPTCHA token and answer, and attempt to log in with them */
-			g_object_unref (message);
+			/* Do some fancy memory stuff to save ourselves another alloc */
+			captcha_base_uri_length = strlen (captcha_base_uri);
+			*captcha_uri = g_malloc (captcha_base_uri_length + (captcha_end - captcha_start) + 1);
+			memcpy (*captcha_uri, captcha_base_uri, captcha_base_uri_length);
+			memcpy (*captcha_uri + captcha_base_uri_length, captcha_start, (captcha_end - captcha_start));
+			(*captcha_uri)[captcha_base_uri_length + (captcha_end - captcha_start)] = '\0';
 
-			return authenticate (self, username, password, g_strndup (captcha_start, captcha_end - captcha_start), new_captcha_answer,
-					     cancellable, error);
+			/* The caller will request a CAPTCHA answer from the application and attempt to log in with it */
+			*captcha_token = g_strndup (token_start, token_end - token_start);
+
+			return FALSE;
 		} else if (strncmp (error_start, "Unknown", error_end - error_start) == 0) {
 			goto protocol_error;
 		} else if (strncmp (error_start, "BadAuthentication", error_end - error_start) == 0) {
@@ -705,8 +952,8 @@ login_error:
 
 	g_assert (message->response_body->data != NULL);
 
-	retval = klass->parse_authentication_response (self, status, message->response_body->data, message->response_body->length, error);
-	g_object_unref (message);
+	retval = klass->parse_authentication_response (self, message->status_code, message->response_body->data, message->response_body->length,
+						       error);
 
 	g_object_freeze_notify (G_OBJECT (self));
 	priv->authenticated = retval;
@@ -738,131 +985,853 @@ protocol_error:
 			     _("The server returned a malformed response."));
 
 general_error:
-	g_object_unref (message);
 	priv->authenticated = FALSE;
 	g_object_notify (G_OBJECT (self), "authenticated");
 
 	return FALSE;
 }
 
-/**
- * gdata_service_authenticate:
- * @self: a #GDataService
- * @username: the user's username
- * @password: the user's password
- * @cancellable: optional #GCancellable object, or %NULL
- * @error: a #GError, or %NULL
- *
- * Authenticates the #GDataService with the online service using @username and @password; i.e. logs into the service with the given
- * user account. @username should be a full e-mail address (e.g. <literal>john.smith@gmail.com</literal>). If a full e-mail address is
- * not given, @username will have <literal>@gmail.com</literal> appended to create an e-mail address
- *
- * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
- * If the operation was cancelled, the error %G_IO_ERROR_CANCELLED will be returned.
- *
- * A %GDATA_AUTHENTICATION_ERROR_BAD_AUTHENTICATION will be returned if authentication failed due to an incorrect username or password.
- * Other #GDataAuthenticationError errors can be returned for other conditions.
- *
- * If the service requires a CAPTCHA to be completed, the #GDataService::captcha-challenge signal will be emitted. The return value from
- * a signal handler for the signal should be the text from the image. If the text is %NULL or empty, authentication will fail with a
- * %GDATA_AUTHENTICATION_ERROR_CAPTCHA_REQUIRED error. Otherwise, authentication will be automatically and transparently restarted with
- * the new CAPTCHA details.
- *
- * A %GDATA_SERVICE_ERROR_PROTOCOL_ERROR will be returned if the server's responses were invalid. Subclasses of #GDataService can override
- * parsing the authentication response, and may return their own error codes. See their documentation for more details.
- *
- * Return value: %TRUE if authentication was successful, %FALSE otherwise
- **/
-gboolean
-gdata_service_authenticate (GDataService *self, const gchar *username, const gchar *password, GCancellable *cancellable, GError **error)
+static gchar *
+request_captcha_answer (GDataService *self, const gchar *captcha_uri, GError **error)
 {
-	return authenticate (self, username, password, NULL, NULL, cancellable, error);
+	gchar *captcha_answer = NULL;
+
+	/* Request a CAPTCHA answer from the application */
+	g_signal_emit (self, service_signals[SIGNAL_CAPTCHA_CHALLENGE], 0, captcha_uri, &captcha_answer);
+
+	if (captcha_answer == NULL || *captcha_answer == '\0') {
+		g_free (captcha_answer);
+
+		/* Translators: see http://en.wikipedia.org/wiki/CAPTCHA for information about CAPTCHAs */
+		g_set_error_literal (error, GDATA_AUTHENTICATION_ERROR, GDATA_AUTHENTICATION_ERROR_CAPTCHA_REQUIRED,
+				     _("A CAPTCHA must be filled out to log in."));
+
+		self->priv->authenticated = FALSE;
+		g_object_notify (G_OBJECT (self), "authenticated");
+
+		return NULL;
+	}
+
+	return captcha_answer;
+}
+
+typedef struct {
+	/* Input */
+	gchar *username;
+	gchar *password;
+	GCancellable *cancellable;
+	GMainContext *context; /* the thread-default context of the thread which started the operation, or %NULL */
+
+	/* Output */
+	SoupMessage *message;
+	gboolean success;
+} AuthenticateAsyncData;
+
+static void
+authenticate_async_data_free (AuthenticateAsyncData *self)
+{
+	g_free (self->username);
+	g_free (self->password);
+	if (self->cancellable != NULL)
+		g_object_unref (self->cancellable);
+	if (self->context != NULL)
+		g_main_context_unref (self->context);
+	if (self->message != NULL)
+		g_object_unref (self->message);
+
+	g_slice_free (AuthenticateAsyncData, self);
+}
+
+static gboolean authenticate_complete_cb (GDataService *self, SoupMessage *message, GSimpleAsyncResult *result, GCancellable *cancellable);
+
+static gboolean
+authenticate_response_idle (GSimpleAsyncResult *result)
+{
+	GDataService *self;
+	AuthenticateAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	gchar *captcha_uri = NULL, *captcha_token = NULL, *captcha_answer;
+	GError *error = NULL;
+
+	self = GDATA_SERVICE (g_async_result_get_source_object (G_ASYNC_RESULT (result)));
+
+	data->success = process_authentication_response (self, data->message, data->username, data->password, &captcha_uri, &captcha_token, &error);
+	g_object_unref (data->message);
+	data->message = NULL;
+
+	if (captcha_uri != NULL) {
+		captcha_answer = request_captcha_answer (self, captcha_uri, &error);
+		g_free (captcha_uri);
+
+		if (captcha_answer != NULL) {
+			/* Attempt to log in again with the CAPTCHA token and answer */
+			queue_message (self, build_authentication_message (self, data->username, data->password, captcha_token, captcha_answer),
+				       result, data->cancellable, authenticate_complete_cb);
+			goto done;
+		}
+
+		g_free (captcha_token);
+	}
+
+	if (error != NULL) {
+		g_simple_async_result_set_from_error (result, error);
+		g_error_free (error);
+	}
+
+	g_simple_async_result_complete (result);
+
+done:
+	g_object_unref (self);
+	g_object_unref (result);
+
+	return FALSE;
+}
+
+static gboolean
+authenticate_complete_cb (GDataService *self, SoupMessage *message, GSimpleAsyncResult *result, GCancellable *cancellable)
+{
+	AuthenticateAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GSource *source;
+
+	/* Process the response in the thread which started the operation, as the result would be completed, since it updates the service's
+	 * properties and may have to emit GDataService::captcha-challenge */
+	data->message = g_object_ref (message);
+
+	source = g_idle_source_new ();
+	g_source_set_callback (source, (GSourceFunc) authenticate_response_idle, g_object_ref (result), NULL);
+	g_source_attach (source, data->context);
+	g_source_unref (source);
+
+	return FALSE;
+}
+
+/**
+ * gdata_service_authenticate_async:
+ * @self: a #GDataService
+ * @username: the user's username
+ * @password: the user's password
+ * @cancellable: optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when authentication is finished
+ * @user_data: data to pass to the @callback function
+ *
+ * Authenticates the #GDataService with the online service using the given @username and @password. @self, @username and
+ * @password are all reffed/copied when this function is called, so can safely be freed after this function returns.
+ *
+ * For more details, see gdata_service_authenticate(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_service_authenticate_finish()
+ * to get the results of the operation.
+ **/
+void
+gdata_service_authenticate_async (GDataService *self, const gchar *username, const gchar *password,
+				  GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	AuthenticateAsyncData *data;
+
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (username != NULL);
+	g_return_if_fail (password != NULL);
+
+	data = g_slice_new0 (AuthenticateAsyncData);
+	data->username = g_strdup (username);
+	data->password = g_strdup (password);
+	data->cancellable = (cancellable != NULL) ? g_object_ref (cancellable) : NULL;
+	data->context = g_main_context_get_thread_default ();
+	if (data->context != NULL)
+		g_main_context_ref (data->context);
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_authenticate_async);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) authenticate_async_data_free);
+	queue_message (self, build_authentication_message (self, username, password, NULL, NULL), result, cancellable, authenticate_complete_cb);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_service_authenticate_finish:
+ * @self: a #GDataService
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous authentication operation started with gdata_service_authenticate_async().
+ *
+ * Return value: %TRUE if authentication was successful, %FALSE otherwise
+ **/
+gboolean
+gdata_service_authenticate_finish (GDataService *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+	AuthenticateAsyncData *data;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_service_authenticate_async);
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return FALSE;
+
+	data = g_simple_async_result_get_op_res_gpointer (result);
+	if (data->success == TRUE)
+		return TRUE;
+
+	g_assert_not_reached ();
+}
+
+static gboolean
+authenticate (GDataService *self, const gchar *username, const gchar *password, gchar *captcha_token, gchar *captcha_answer,
+	      GCancellable *cancellable, GError **error)
+{
+	SoupMessage *message;
+	gchar *captcha_uri = NULL, *new_captcha_token = NULL, *new_captcha_answer;
+	gboolean retval;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), FALSE);
+	g_return_val_if_fail (username != NULL, FALSE);
+	g_return_val_if_fail (password != NULL, FALSE);
+
+	/* Send the message */
+	message = build_authentication_message (self, username, password, captcha_token, captcha_answer);
+	soup_session_send_message (self->priv->session, message);
+
+	/* Check for cancellation */
+	if (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE) {
+		g_object_unref (message);
+		return FALSE;
+	}
+
+	retval = process_authentication_response (self, message, username, password, &captcha_uri, &new_captcha_token, error);
+	g_object_unref (message);
+
+	if (captcha_uri != NULL) {
+		new_captcha_answer = request_captcha_answer (self, captcha_uri, error);
+		g_free (captcha_uri);
+
+		if (new_captcha_answer == NULL) {
+			g_free (new_captcha_token);
+			return FALSE;
+		}
+
+		/* Attempt to log in again with the CAPTCHA token and answer */
+		return authenticate (self, username, password, new_captcha_token, new_captcha_answer, cancellable, error);
+	}
+
+	return retval;
+}
+
+/**
+ * gdata_service_authenticate:
+ * @self: a #GDataService
+ * @username: the user's username
+ * @password: the user's password
+ * @cancellable: optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Authenticates the #GDataService with the online service using @username and @password; i.e. logs into the service with the given
+ * user account. @username should be a full e-mail address (e.g. <literal>john.smith@gmail.com</literal>). If a full e-mail address is
+ * not given, @username will have <literal>@gmail.com</literal> appended to create an e-mail address
+ *
+ * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
+ * If the operation was cancelled, the error %G_IO_ERROR_CANCELLED will be returned.
+ *
+ * A %GDATA_AUTHENTICATION_ERROR_BAD_AUTHENTICATION will be returned if authentication failed due to an incorrect username or password.
+ * Other #GDataAuthenticationError errors can be returned for other conditions.
+ *
+ * If the service requires a CAPTCHA to be completed, the #GDataService::captcha-challenge signal will be emitted. The return value from
+ * a signal handler for the signal should be the text from the image. If the text is %NULL or empty, authentication will fail with a
+ * %GDATA_AUTHENTICATION_ERROR_CAPTCHA_REQUIRED error. Otherwise, authentication will be automatically and transparently restarted with
+ * the new CAPTCHA details.
+ *
+ * A %GDATA_SERVICE_ERROR_PROTOCOL_ERROR will be returned if the server's responses were invalid. Subclasses of #GDataService can override
+ * parsing the authentication response, and may return their own error codes. See their documentation for more details.
+ *
+ * Return value: %TRUE if authentication was successful, %FALSE otherwise
+ **/
+gboolean
+gdata_service_authenticate (GDataService *self, const gchar *username, const gchar *password, GCancellable *cancellable, GError **error)
+{
+	return authenticate (self, username, password, NULL, NULL, cancellable, error);
 }
 
 guint
 _gdata_service_send_message (GDataService *self, SoupMessage *message, GError **error)
 {
-	/* Based on code from evolution-data-server's libgdata:
-	 *  Ebby Wiselyn <ebbywiselyn@gmail.com>
-	 *  Jason Willis <zenbrother@gmail.com>
-	 *
-	 * Copyright (C) 1999-2008 Novell, Inc. (www.novell.com)
-	 */
+	/* Based on code from evolution-data-server's libgdata:
+	 *  Ebby Wiselyn <ebbywiselyn@gmail.com>
+	 *  Jason Willis <zenbrother@gmail.com>
+	 *
+	 * Copyright (C) 1999-2008 Novell, Inc. (www.novell.com)
+	 */
+
+	SoupMessageFlags flags = soup_message_get_flags (message);
+
+	soup_message_set_flags (message, flags | SOUP_MESSAGE_NO_REDIRECT);
+	soup_session_send_message (self->priv->session, message);
+	soup_message_set_flags (message, flags);
+
+	/* Follow one redirect, unless the caller's set SOUP_MESSAGE_NO_REDIRECT to handle 3xx responses itself */
+	if (SOUP_STATUS_IS_REDIRECTION (message->status_code) && (flags & SOUP_MESSAGE_NO_REDIRECT) == 0) {
+		if (set_redirect_uri (message, error) == FALSE)
+			return SOUP_STATUS_NONE;
+
+		soup_session_send_message (self->priv->session, message);
+	}
+
+	return message->status_code;
+}
+
+static gboolean
+cancel_operation_message_idle (SoupMessage *message)
+{
+	MessageOperation *operation;
+
+	/* The message may have finished by now */
+	operation = g_object_get_qdata (G_OBJECT (message), message_operation_quark ());
+	if (operation != NULL && operation->queued == TRUE)
+		soup_session_cancel_message (operation->service->priv->async_session, message, SOUP_STATUS_CANCELLED);
+	g_object_unref (message);
+
+	return FALSE;
+}
+
+/* Cancel @message, which must be being sent by _gdata_service_send_message() or by an asynchronous operation; typically from one of its signal
+ * handlers. Asynchronous operations' messages are cancelled from an idle callback, rather than from within libsoup's I/O code. */
+void
+_gdata_service_cancel_message (GDataService *self, SoupMessage *message)
+{
+	if (g_object_get_qdata (G_OBJECT (message), message_operation_quark ()) != NULL)
+		io_invoke ((GSourceFunc) cancel_operation_message_idle, g_object_ref (message));
+	else
+		soup_session_cancel_message (self->priv->session, message, SOUP_STATUS_CANCELLED);
+}
+
+static gboolean
+resume_message_cb (MessageOperation *operation)
+{
+	g_source_unref (operation->delay_source);
+	operation->delay_source = NULL;
+
+	operation->resume_func (operation->message, operation->resume_data);
+
+	/* The resume function may have started reading the next chunk, in which case the message stays paused until it's been read */
+	if (operation->pending_read == NULL)
+		soup_session_unpause_message (operation->service->priv->async_session, operation->message);
+
+	return FALSE;
+}
+
+/* Stop writing @message's request body for @delay milliseconds, after which @resume_func is called to append the next chunk of the body
+ * and the message continues. This must be called from one of the message's "wrote-chunk" signal handlers, in place of appending the chunk.
+ * Asynchronous operations' messages are paused, so that the I/O thread can get on with others; if the message finishes in the meantime,
+ * @resume_func isn't called. Synchronous messages block the thread sending them for the delay. */
+void
+_gdata_service_delay_message (GDataService *self, SoupMessage *message, guint delay, GDataServiceMessageResumeFunc resume_func,
+			      gpointer user_data)
+{
+	MessageOperation *operation;
+
+	operation = g_object_get_qdata (G_OBJECT (message), message_operation_quark ());
+	if (operation == NULL) {
+		g_usleep ((gulong) delay * 1000);
+		resume_func (message, user_data);
+		return;
+	}
+
+	g_assert (operation->delay_source == NULL);
+
+	operation->resume_func = resume_func;
+	operation->resume_data = user_data;
+	soup_session_pause_message (self->priv->async_session, message);
+
+	operation->delay_source = g_timeout_source_new (delay);
+	g_source_set_callback (operation->delay_source, (GSourceFunc) resume_message_cb, operation, NULL);
+	g_source_attach (operation->delay_source, get_io_context ());
+}
+
+static void
+message_read_cb (GInputStream *stream, GAsyncResult *async_result, MessageRead *message_read)
+{
+	MessageOperation *operation = message_read->operation;
+	gssize length;
+	GError *error = NULL;
+
+	length = g_input_stream_read_finish (stream, async_result, &error);
+
+	if (operation->pending_read == message_read) {
+		operation->pending_read = NULL;
+		message_read->read_func (operation->message, message_read->buffer, length, error, message_read->read_data);
+		soup_session_unpause_message (operation->service->priv->async_session, operation->message);
+	} else {
+		/* The message finished while the chunk was being read, so it's no longer wanted */
+		g_free (message_read->buffer);
+		if (error != NULL)
+			g_error_free (error);
+	}
+
+	message_operation_unref (operation);
+	g_slice_free (MessageRead, message_read);
+}
+
+/* Read up to @count bytes from @stream to append to @message's request body, passing them to @read_func (which takes ownership of the buffer,
+ * and of the error if the read failed) to append. This must be called from one of the message's "wrote-chunk" signal handlers (or a
+ * #GDataServiceMessageResumeFunc), in place of appending the chunk. Asynchronous operations' messages are paused while @stream is read
+ * asynchronously, so that the I/O thread isn't blocked by it; @read_func is then called in the I/O thread, unless the message has finished in
+ * the meantime. Synchronous messages' request bodies are read straight away. */
+void
+_gdata_service_read_message_chunk (GDataService *self, SoupMessage *message, GInputStream *stream, gsize count, GCancellable *cancellable,
+				   GDataServiceMessageReadFunc read_func, gpointer user_data)
+{
+	MessageOperation *operation;
+	MessageRead *message_read;
+
+	operation = g_object_get_qdata (G_OBJECT (message), message_operation_quark ());
+	if (operation == NULL) {
+		gchar *buffer;
+		gssize length;
+		GError *error = NULL;
+
+		buffer = g_malloc (count);
+		length = g_input_stream_read (stream, buffer, count, cancellable, &error);
+		read_func (message, buffer, length, error, user_data);
+
+		return;
+	}
+
+	g_assert (operation->pending_read == NULL);
+
+	message_read = g_slice_new (MessageRead);
+	message_read->operation = message_operation_ref (operation);
+	message_read->buffer = g_malloc (count);
+	message_read->read_func = read_func;
+	message_read->read_data = user_data;
+
+	operation->pending_read = message_read;
+	soup_session_pause_message (self->priv->async_session, message);
+
+	g_input_stream_read_async (stream, message_read->buffer, count, G_PRIORITY_DEFAULT, cancellable, (GAsyncReadyCallback) message_read_cb,
+				   message_read);
+}
+
+/* Map @file into memory, returning a #SoupBuffer which points into the mapping (and keeps it alive), so that the file's data can be sent in a
+ * request body without being copied. %NULL is returned if the file isn't local or can't be mapped, in which case the caller should read the
+ * file as normal. The file mustn't be truncated while the buffer is in use, or reading the buffer will crash. */
+SoupBuffer *
+_gdata_service_map_file (GFile *file)
+{
+	GMappedFile *mapped_file;
+	gchar *path;
+
+	path = g_file_get_path (file);
+	if (path == NULL)
+		return NULL;
+
+	mapped_file = g_mapped_file_new (path, FALSE, NULL);
+	g_free (path);
+
+	if (mapped_file == NULL)
+		return NULL;
+
+	return soup_buffer_new_with_owner (g_mapped_file_get_contents (mapped_file), g_mapped_file_get_length (mapped_file), mapped_file,
+					   (GDestroyNotify) g_mapped_file_unref);
+}
+
+/* Queue @message to be sent asynchronously, as queue_message() does, for subclasses' own asynchronous operations */
+void
+_gdata_service_queue_message (GDataService *self, SoupMessage *message, GSimpleAsyncResult *result, GCancellable *cancellable,
+			      GDataServiceMessageCompleteFunc complete_func)
+{
+	queue_message (self, message, result, cancellable, complete_func);
+}
+
+/* Check that @message finished with the @expected_status, and if not, get the service to build an error for it */
+static gboolean
+check_response_status (GDataService *self, SoupMessage *message, guint expected_status, GDataServiceError error_type, GError **error)
+{
+	GDataServiceClass *klass;
+
+	if (message->status_code == expected_status)
+		return TRUE;
+
+	/* Error */
+	klass = GDATA_SERVICE_GET_CLASS (self);
+	g_assert (klass->parse_error_response != NULL);
+	klass->parse_error_response (self, error_type, message->status_code, message->reason_phrase, message->response_body->data,
+				     message->response_body->length, error);
+
+	return FALSE;
+}
+
+typedef struct {
+	SoupSession *session;
+	GCancellable *cancellable;
+	GDataParsableStream *stream;
+	GError *error;
+
+	/* Response cache; see the GDataService:cache-directory property. cache_etag is the ETag of the cached response, if it was sent to the
+	 * server for revalidation. */
+	gchar *cache_path;
+	gchar *cache_etag;
+	gchar *cache_temporary_path;
+	FILE *cache_file;
+} QueryStreamData;
+
+static void
+query_cache_abort (QueryStreamData *data)
+{
+	/* Throw away a partially-written response */
+	if (data->cache_file != NULL) {
+		fclose (data->cache_file);
+		g_unlink (data->cache_temporary_path);
+	}
+
+	data->cache_file = NULL;
+	g_free (data->cache_temporary_path);
+	data->cache_temporary_path = NULL;
+}
+
+static void
+query_got_headers_cb (SoupMessage *message, QueryStreamData *data)
+{
+	gint fd;
+
+	/* Only successful responses are parsed as they arrive; error responses are accumulated so they can be passed to parse_error_response */
+	soup_message_body_set_accumulate (message->response_body, (message->status_code == 200) ? FALSE : TRUE);
+
+	if (message->status_code != 200 || data->cache_path == NULL || data->cache_file != NULL)
+		return;
+
+	/* Write the response to a temporary file in the cache as it's received; it's moved into place once it's been parsed successfully */
+	data->cache_temporary_path = g_strconcat (data->cache_path, ".XXXXXX", NULL);
+	fd = g_mkstemp (data->cache_temporary_path);
+	if (fd != -1)
+		data->cache_file = fdopen (fd, "wb");
+
+	if (data->cache_file == NULL) {
+		if (fd != -1) {
+			close (fd);
+			g_unlink (data->cache_temporary_path);
+		}
+
+		g_free (data->cache_temporary_path);
+		data->cache_temporary_path = NULL;
+	}
+}
+
+static void
+query_got_chunk_cb (SoupMessage *message, SoupBuffer *chunk, QueryStreamData *data)
+{
+	if (message->status_code != 200 || data->error != NULL)
+		return;
+
+	/* Stop downloading if parsing's failed or the query's been cancelled */
+	if (g_cancellable_set_error_if_cancelled (data->cancellable, &(data->error)) == TRUE ||
+	    _gdata_parsable_stream_push (data->stream, chunk->data, chunk->length, &(data->error)) == FALSE) {
+		soup_session_cancel_message (data->session, message, SOUP_STATUS_CANCELLED);
+		return;
+	}
+
+	/* Failing to cache the response isn't fatal */
+	if (data->cache_file != NULL && fwrite (chunk->data, 1, chunk->length, data->cache_file) != chunk->length)
+		query_cache_abort (data);
+}
+
+static gchar *
+get_cache_path (GDataService *self, SoupMessage *message)
+{
+	gchar *uri, *key, *filename, *path;
+
+	if (self->priv->cache_directory == NULL)
+		return NULL;
+
+	if (g_mkdir_with_parents (self->priv->cache_directory, 0700) != 0)
+		return NULL;
+
+	/* Responses are keyed by the query URI and the user they were requested by, so that private feeds (such as those under "default")
+	 * aren't shared between users */
+	uri = soup_uri_to_string (soup_message_get_uri (message), FALSE);
+	key = g_strconcat (uri, " ", (self->priv->username != NULL) ? self->priv->username : "", NULL);
+	filename = g_compute_checksum_for_string (G_CHECKSUM_SHA1, key, -1);
+	path = g_build_filename (self->priv->cache_directory, filename, NULL);
+
+	g_free (filename);
+	g_free (key);
+	g_free (uri);
+
+	return path;
+}
+
+static void
+query_cache_store (QueryStreamData *data, SoupMessage *message, GDataFeed *feed)
+{
+	gchar *etag_path;
+	const gchar *etag;
+	gboolean success;
+
+	g_assert (data->cache_file != NULL);
+
+	success = (fclose (data->cache_file) == 0) ? TRUE : FALSE;
+	data->cache_file = NULL;
+
+	/* Prefer the ETag from the response headers, as that's what the server will check against; fall back to the feed's ETag */
+	etag = soup_message_headers_get_one (message->response_headers, "ETag");
+	if (etag == NULL)
+		etag = gdata_feed_get_etag (feed);
+
+	/* The response is moved into place before its ETag is updated, so a stale ETag can only ever cause an unnecessary download, rather than
+	 * an old response being used */
+	etag_path = g_strconcat (data->cache_path, ".etag", NULL);
+	if (success == TRUE && g_rename (data->cache_temporary_path, data->cache_path) == 0 && etag != NULL)
+		g_file_set_contents (etag_path, etag, -1, NULL);
+	else
+		g_unlink (etag_path);
+	g_free (etag_path);
+
+	g_unlink (data->cache_temporary_path);
+	g_free (data->cache_temporary_path);
+	data->cache_temporary_path = NULL;
+}
+
+/* Check that the cached response at @path hasn't been truncated or overwritten, by checking that it ends by closing the element it started with.
+ * This doesn't catch every kind of corruption, but it's cheap, and anything else is caught when the response is parsed. */
+static gboolean
+query_cache_is_complete (const gchar *path)
+{
+	GMappedFile *mapped_file;
+	const gchar *contents, *name, *name_end, *end;
+	gsize length, name_length;
+	gboolean complete = FALSE;
 
-	soup_message_set_flags (message, SOUP_MESSAGE_NO_REDIRECT);
-	soup_session_send_message (self->priv->session, message);
-	soup_message_set_flags (message, 0);
+	mapped_file = g_mapped_file_new (path, FALSE, NULL);
+	if (mapped_file == NULL)
+		return FALSE;
+
+	contents = g_mapped_file_get_contents (mapped_file);
+	length = g_mapped_file_get_length (mapped_file);
+	end = contents + length;
 
-	if (SOUP_STATUS_IS_REDIRECTION (message->status_code)) {
-		SoupURI *new_uri;
-		const gchar *new_location;
+	/* Find the root element's name, skipping the XML declaration and any comments */
+	for (name = contents; name < end; name++) {
+		if (*name == '<' && name + 1 < end && name[1] != '?' && name[1] != '!')
+			break;
+	}
 
-		new_location = soup_message_headers_get_one (message->response_headers, "Location");
-		g_return_val_if_fail (new_location != NULL, SOUP_STATUS_NONE);
+	if (name < end) {
+		name++;
+		for (name_end = name; name_end < end && g_ascii_isspace (*name_end) == FALSE && *name_end != '>' && *name_end != '/'; name_end++);
 
-		new_uri = soup_uri_new_with_base (soup_message_get_uri (message), new_location);
-		if (new_uri == NULL) {
-			gchar *uri_string = soup_uri_to_string (new_uri, FALSE);
-			g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
-				     /* Translators: the parameter is the URI which is invalid. */
-				     _("Invalid redirect URI: %s"), uri_string);
-			g_free (uri_string);
-			return SOUP_STATUS_NONE;
+		/* Check that the response ends with "</name>", ignoring trailing whitespace */
+		while (end > name_end && g_ascii_isspace (end[-1]) == TRUE)
+			end--;
+
+		name_length = name_end - name;
+		if (name_length > 0 && (gsize) (end - name_end) >= name_length + 3 && strncmp (end - name_length - 3, "</", 2) == 0 &&
+		    strncmp (end - name_length - 1, name, name_length) == 0 && end[-1] == '>') {
+			complete = TRUE;
 		}
+	}
 
-		soup_message_set_uri (message, new_uri);
-		soup_uri_free (new_uri);
+	g_mapped_file_unref (mapped_file);
 
-		soup_session_send_message (self->priv->session, message);
+	return complete;
+}
+
+static gboolean
+query_cache_load (QueryStreamData *data, GError **error)
+{
+	GMappedFile *mapped_file;
+	gchar *etag_path;
+	gboolean success = FALSE;
+
+	/* Parse the cached response; it's mapped in, rather than read, so it doesn't have to be copied onto the heap */
+	mapped_file = g_mapped_file_new (data->cache_path, FALSE, error);
+	if (mapped_file != NULL) {
+		success = _gdata_parsable_stream_push (data->stream, g_mapped_file_get_contents (mapped_file), g_mapped_file_get_length (mapped_file),
+						       error);
+		g_mapped_file_unref (mapped_file);
 	}
 
-	return message->status_code;
+	/* Don't try to use a broken cached response again */
+	if (success == FALSE) {
+		etag_path = g_strconcat (data->cache_path, ".etag", NULL);
+		g_unlink (etag_path);
+		g_free (etag_path);
+	}
+
+	return success;
+}
+
+static SoupMessage *
+build_query_message (GDataService *self, const gchar *feed_uri, GDataQuery *query)
+{
+	GDataServiceClass *klass;
+	SoupMessage *message;
+	gchar *query_uri;
+
+	if (query != NULL) {
+		query_uri = gdata_query_get_query_uri (query, feed_uri);
+		message = soup_message_new (SOUP_METHOD_GET, query_uri);
+		g_free (query_uri);
+	} else {
+		message = soup_message_new (SOUP_METHOD_GET, feed_uri);
+	}
+
+	/* Make sure subclasses set their headers */
+	klass = GDATA_SERVICE_GET_CLASS (self);
+	if (klass->append_query_headers != NULL)
+		klass->append_query_headers (self, message);
+
+	/* Append the ETag header if possible */
+	if (query != NULL && gdata_query_get_etag (query) != NULL)
+		soup_message_headers_append (message->request_headers, "If-None-Match", gdata_query_get_etag (query));
+
+	return message;
+}
+
+/* @stream is the GDataParsableStream (from _gdata_feed_stream_new()) to parse the response into; ownership of it is taken */
+static void
+query_stream_data_init (QueryStreamData *data, GDataService *self, SoupSession *session, SoupMessage *message, GDataQuery *query,
+			GDataParsableStream *stream, GCancellable *cancellable)
+{
+	gchar *etag_path, *cache_etag = NULL;
+
+	/* Parse the feed incrementally as it's received, so that entries (and their progress callbacks) become available before the whole
+	 * response has been downloaded, and the full response never has to be held in memory */
+	data->session = session;
+	data->cancellable = cancellable;
+	data->stream = stream;
+	data->error = NULL;
+
+	data->cache_path = get_cache_path (self, message);
+	data->cache_etag = NULL;
+	data->cache_temporary_path = NULL;
+	data->cache_file = NULL;
+
+	/* Revalidate the cached response (if any) with the server. If the query has an ETag of its own which doesn't match the cached response,
+	 * it's used instead, and the cached response is ignored. A cached response which has been truncated or overwritten is ignored too, so
+	 * that the feed's downloaded again rather than the query failing. */
+	if (data->cache_path != NULL) {
+		etag_path = g_strconcat (data->cache_path, ".etag", NULL);
+		if (g_file_get_contents (etag_path, &cache_etag, NULL, NULL) == TRUE && query_cache_is_complete (data->cache_path) == FALSE) {
+			g_free (cache_etag);
+			g_unlink (etag_path);
+		} else if (cache_etag != NULL) {
+			if (query == NULL || gdata_query_get_etag (query) == NULL) {
+				soup_message_headers_append (message->request_headers, "If-None-Match", cache_etag);
+				data->cache_etag = cache_etag;
+			} else if (strcmp (gdata_query_get_etag (query), cache_etag) == 0) {
+				data->cache_etag = cache_etag;
+			} else {
+				g_free (cache_etag);
+			}
+		}
+		g_free (etag_path);
+	}
+
+	g_signal_connect (message, "got-headers", (GCallback) query_got_headers_cb, data);
+	g_signal_connect (message, "got-chunk", (GCallback) query_got_chunk_cb, data);
+}
+
+static void
+query_stream_data_clear (QueryStreamData *data)
+{
+	_gdata_parsable_stream_free (data->stream);
+	data->stream = NULL;
+
+	if (data->error != NULL)
+		g_error_free (data->error);
+	data->error = NULL;
+
+	query_cache_abort (data);
+	g_free (data->cache_path);
+	data->cache_path = NULL;
+	g_free (data->cache_etag);
+	data->cache_etag = NULL;
+}
+
+static GDataFeed *
+process_query_response (GDataService *self, SoupMessage *message, GDataQuery *query, QueryStreamData *data, GCancellable *cancellable,
+			GError **error)
+{
+	GDataFeed *feed;
+	GDataLink *link;
+
+	/* Check for cancellation */
+	if (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE)
+		return NULL;
+
+	/* Check for errors while parsing */
+	if (data->error != NULL) {
+		g_propagate_error (error, data->error);
+		data->error = NULL;
+		return NULL;
+	}
+
+	if (message->status_code == 304) {
+		/* Not modified; ETag has worked. If the response was cached, build the feed from the cache; otherwise, the caller's expected to
+		 * still have the feed from last time. */
+		if (data->cache_etag == NULL || query_cache_load (data, error) == FALSE)
+			return NULL;
+	} else if (check_response_status (self, message, 200, GDATA_SERVICE_ERROR_WITH_QUERY, error) == FALSE) {
+		return NULL;
+	}
+
+	/* All the entries have been parsed by now; finish off the feed itself */
+	feed = GDATA_FEED (_gdata_parsable_stream_finish (data->stream, error));
+
+	/* Store the new response in the cache */
+	if (feed != NULL && data->cache_file != NULL)
+		query_cache_store (data, message, feed);
+
+	/* Update the query with the feed's ETag */
+	if (query != NULL && feed != NULL && gdata_feed_get_etag (feed) != NULL)
+		gdata_query_set_etag (query, gdata_feed_get_etag (feed));
+
+	/* Update the query with the next and previous URIs from the feed */
+	if (query != NULL && feed != NULL) {
+		link = gdata_feed_look_up_link (feed, "next");
+		if (link != NULL)
+			_gdata_query_set_next_uri (query, link->href);
+		link = gdata_feed_look_up_link (feed, "previous");
+		if (link != NULL)
+			_gdata_query_set_previous_uri (query, link->href);
+	}
+
+	return feed;
 }
 
 typedef struct {
 	/* Input */
-	gchar *feed_uri;
 	GDataQuery *query;
-	GType entry_type;
+	QueryStreamData stream_data;
 
 	/* Output */
 	GDataFeed *feed;
-	GDataQueryProgressCallback progress_callback;
-	gpointer progress_user_data;
 } QueryAsyncData;
 
 static void
 query_async_data_free (QueryAsyncData *self)
 {
-	g_free (self->feed_uri);
 	if (self->query)
 		g_object_unref (self->query);
+	query_stream_data_clear (&(self->stream_data));
 	if (self->feed)
 		g_object_unref (self->feed);
 
 	g_slice_free (QueryAsyncData, self);
 }
 
-static void
-query_thread (GSimpleAsyncResult *result, GDataService *service, GCancellable *cancellable)
+static gboolean
+query_complete_cb (GDataService *self, SoupMessage *message, GSimpleAsyncResult *result, GCancellable *cancellable)
 {
 	GError *error = NULL;
 	QueryAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
 
-	/* Check to see if it's been cancelled already */
-	if (g_cancellable_set_error_if_cancelled (cancellable, &error) == TRUE) {
+	data->feed = process_query_response (self, message, data->query, &(data->stream_data), cancellable, &error);
+	if (error != NULL) {
 		g_simple_async_result_set_from_error (result, error);
 		g_error_free (error);
-		return;
 	}
 
-	/* Execute the query and return */
-	data->feed = gdata_service_query (service, data->feed_uri, data->query, data->entry_type, cancellable,
-					  data->progress_callback, data->progress_user_data, &error);
-	if (data->feed == NULL) {
-		g_simple_async_result_set_from_error (result, error);
-		g_error_free (error);
-	}
+	return TRUE;
 }
 
 /**
@@ -880,7 +1849,9 @@ query_thread (GSimpleAsyncResult *result, GDataService *service, GCancellable *c
  * Queries the service's @feed_uri feed to build a #GDataFeed. @self, @feed_uri and
  * @query are all reffed/copied when this function is called, so can safely be freed after this function returns.
  *
- * For more details, see gdata_service_query(), which is the synchronous version of this function.
+ * For more details, see gdata_service_query(), which is the synchronous version of this function. As there, @progress_callback is called in
+ * the thread-default main context of the thread which called this function, or in the thread which parsed each entry if @query has
+ * %GDATA_QUERY_FLAGS_SYNCHRONOUS_PROGRESS set.
  *
  * When the operation is finished, @callback will be called. You can then call gdata_service_query_finish()
  * to get the results of the operation.
@@ -891,22 +1862,25 @@ gdata_service_query_async (GDataService *self, const gchar *feed_uri, GDataQuery
 			   GAsyncReadyCallback callback, gpointer user_data)
 {
 	GSimpleAsyncResult *result;
+	SoupMessage *message;
 	QueryAsyncData *data;
 
 	g_return_if_fail (GDATA_IS_SERVICE (self));
 	g_return_if_fail (feed_uri != NULL);
 	g_return_if_fail (entry_type != G_TYPE_INVALID);
 
-	data = g_slice_new (QueryAsyncData);
-	data->feed_uri = g_strdup (feed_uri);
+	message = build_query_message (self, feed_uri, query);
+
+	data = g_slice_new0 (QueryAsyncData);
 	data->query = (query != NULL) ? g_object_ref (query) : NULL;
-	data->entry_type = entry_type;
-	data->progress_callback = progress_callback;
-	data->progress_user_data = progress_user_data;
+	query_stream_data_init (&(data->stream_data), self, self->priv->async_session, message, query,
+				_gdata_feed_stream_new (GDATA_SERVICE_GET_CLASS (self)->feed_type, entry_type, query, 0, FALSE,
+							progress_callback, progress_user_data),
+				cancellable);
 
 	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_query_async);
 	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) query_async_data_free);
-	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) query_thread, G_PRIORITY_DEFAULT, cancellable);
+	queue_message (self, message, result, cancellable, query_complete_cb);
 	g_object_unref (result);
 }
 
@@ -934,118 +1908,499 @@ gdata_service_query_finish (GDataService *self, GAsyncResult *async_result, GErr
 	if (g_simple_async_result_propagate_error (result, error) == TRUE)
 		return NULL;
 
+	/* The feed will be NULL without an error being set if the query's ETag matched */
 	data = g_simple_async_result_get_op_res_gpointer (result);
 	if (data->feed != NULL)
 		return g_object_ref (data->feed);
 
-	g_assert_not_reached ();
+	return NULL;
+}
+
+/**
+ * gdata_service_query:
+ * @self: a #GDataService
+ * @feed_uri: the feed URI to query, including the host name and protocol
+ * @query: a #GDataQuery with the query parameters, or %NULL
+ * @entry_type: a #GType for the #GDataEntry<!-- -->s to build from the XML
+ * @cancellable: optional #GCancellable object, or %NULL
+ * @progress_callback: a #GDataQueryProgressCallback to call when an entry is loaded, or %NULL
+ * @progress_user_data: data to pass to the @progress_callback function
+ * @error: a #GError, or %NULL
+ *
+ * Queries the service's @feed_uri feed to build a #GDataFeed.
+ *
+ * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
+ * If the operation was cancelled, the error %G_IO_ERROR_CANCELLED will be returned.
+ *
+ * A %GDATA_SERVICE_ERROR_WITH_QUERY will be returned if the server indicates there is a problem with the query, but subclasses may override
+ * this and return their own errors. See their documentation for more details.
+ *
+ * For each entry in the response feed, @progress_callback will be called in the thread-default main context of the thread which called this
+ * function (which must be iterated for the callbacks to be made), or straight away in the thread which parsed the entry if @query has
+ * %GDATA_QUERY_FLAGS_SYNCHRONOUS_PROGRESS set. If there was an error parsing the XML response, a #GDataParserError will be returned.
+ *
+ * If the query is successful and the feed supports pagination, @query will be updated with the pagination URIs, and the next or previous page
+ * can then be loaded by calling gdata_query_next_page() or gdata_query_previous_page() before running the query again.
+ *
+ * If the #GDataQuery's ETag is set and it finds a match on the server, %FALSE will be returned, but @error will remain unset. Otherwise,
+ * @query's ETag will be updated with the ETag from the returned feed, if available.
+ *
+ * If the #GDataService:cache-directory property is set, the response is cached, and is revalidated with the server the next time the same
+ * query is run. If it hasn't changed, the feed is built from the cached response and returned as normal (even if the #GDataQuery's ETag
+ * matched), rather than %NULL being returned.
+ *
+ * Return value: a #GDataFeed of query results, or %NULL; unref with g_object_unref()
+ **/
+GDataFeed *
+gdata_service_query (GDataService *self, const gchar *feed_uri, GDataQuery *query, GType entry_type,
+		     GCancellable *cancellable, GDataQueryProgressCallback progress_callback, gpointer progress_user_data, GError **error)
+{
+	GDataFeed *feed;
+	QueryStreamData data;
+	SoupMessage *message;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (feed_uri != NULL, NULL);
+	g_return_val_if_fail (entry_type != G_TYPE_INVALID, NULL);
+
+	message = build_query_message (self, feed_uri, query);
+	query_stream_data_init (&data, self, self->priv->session, message, query,
+				_gdata_feed_stream_new (GDATA_SERVICE_GET_CLASS (self)->feed_type, entry_type, query, 0, FALSE,
+							progress_callback, progress_user_data),
+				cancellable);
+
+	/* Send the message */
+	soup_session_send_message (self->priv->session, message);
+
+	feed = process_query_response (self, message, query, &data, cancellable, error);
+	query_stream_data_clear (&data);
+	g_object_unref (message);
+
+	return feed;
+}
+
+typedef struct {
+	QueryStreamData stream_data;
+	GDataServiceQueryPageCallback callback;
+	gpointer user_data;
+} QueryPageData;
+
+static void
+query_page_data_free (QueryPageData *self)
+{
+	query_stream_data_clear (&(self->stream_data));
+	g_slice_free (QueryPageData, self);
+}
+
+static gboolean
+query_page_complete_cb (GDataService *self, SoupMessage *message, GSimpleAsyncResult *result, GCancellable *cancellable)
+{
+	QueryPageData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GDataFeed *feed;
+	GError *error = NULL;
+
+	feed = process_query_response (self, message, NULL, &(data->stream_data), NULL, &error);
+	data->callback (self, feed, error, data->user_data);
+
+	/* The callback's been given the result, so there's nothing to complete */
+	return FALSE;
+}
+
+typedef struct {
+	GDataService *service;
+	GError *error;
+	GDataServiceQueryPageCallback callback;
+	gpointer user_data;
+} QueryPageFailure;
+
+static gboolean
+query_page_failed_idle (QueryPageFailure *self)
+{
+	/* Ownership of the error passes to the callback */
+	self->callback (self->service, NULL, self->error, self->user_data);
+
+	g_object_unref (self->service);
+	g_slice_free (QueryPageFailure, self);
+
+	return FALSE;
+}
+
+/* Requests a single page of a feed, at @page_uri, for GDataFeedIterator. @query is only used for its flags and batch progress callback, and is
+ * never modified; the batch progress callback is delivered in @progress_context, since this may be called from the I/O thread. @next_uri_func
+ * (if non-%NULL) is called with the URI of the feed's "next" link as soon as it's been parsed. Once the page has been received, @callback is
+ * called with the resulting feed or error (ownership of both passes to it); if the server responds that the page hasn't been modified, both
+ * are %NULL. Both functions are called in the I/O thread. */
+void
+_gdata_service_query_page_async (GDataService *self, const gchar *page_uri, GDataQuery *query, GType entry_type, GMainContext *progress_context,
+				 GDataFeedNextUriFunc next_uri_func, GDataServiceQueryPageCallback callback, gpointer user_data)
+{
+	GDataServiceClass *klass = GDATA_SERVICE_GET_CLASS (self);
+	GSimpleAsyncResult *result;
+	SoupMessage *message;
+	QueryPageData *data;
+	GDataParsableStream *stream;
+
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (page_uri != NULL);
+	g_return_if_fail (callback != NULL);
+
+	/* The page's URI comes from the previous page's "next" link, so it may not be valid */
+	message = soup_message_new (SOUP_METHOD_GET, page_uri);
+	if (message == NULL) {
+		QueryPageFailure *failure = g_slice_new (QueryPageFailure);
+
+		failure->service = g_object_ref (self);
+		failure->callback = callback;
+		failure->user_data = user_data;
+		failure->error = g_error_new (GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+					      /* Translators: the parameter is the URI which is invalid. */
+					      _("Invalid feed page URI: %s"), page_uri);
+
+		/* The callback's always called in the I/O thread, and never before this returns */
+		io_invoke ((GSourceFunc) query_page_failed_idle, failure);
+		return;
+	}
+
+	/* Make sure subclasses set their headers */
+	if (klass->append_query_headers != NULL)
+		klass->append_query_headers (self, message);
+
+	stream = _gdata_feed_stream_new (klass->feed_type, entry_type, query, 0, FALSE, NULL, NULL);
+	_gdata_feed_stream_set_progress_context (stream, progress_context);
+	_gdata_feed_stream_set_next_uri_func (stream, next_uri_func, user_data);
+
+	data = g_slice_new0 (QueryPageData);
+	data->callback = callback;
+	data->user_data = user_data;
+	query_stream_data_init (&(data->stream_data), self, self->priv->async_session, message, NULL, stream, NULL);
+
+	/* No cancellable is passed, since the operation's only complete once the callback's been called */
+	result = g_simple_async_result_new (G_OBJECT (self), NULL, NULL, _gdata_service_query_page_async);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) query_page_data_free);
+	queue_message (self, message, result, NULL, query_page_complete_cb);
+	g_object_unref (result);
+}
+
+/* The number of pages gdata_service_query_all() downloads at once if it isn't told otherwise */
+#define DEFAULT_QUERY_ALL_CONNECTIONS 4
+
+typedef struct _QueryAllData QueryAllData;
+
+typedef struct {
+	QueryAllData *all;
+	QueryStreamData stream_data;
+	GDataFeed *feed;
+} QueryAllPage;
+
+struct _QueryAllData {
+	GDataService *service;
+	const gchar *feed_uri;
+	GDataQuery *query;
+	GType entry_type;
+	GDataQueryProgressCallback progress_callback;
+	gpointer progress_user_data;
+	GMainContext *progress_context;
+
+	/* The pages are sent as asynchronous operations, so they count towards the service's and the library's limits on operations in flight.
+	 * They're completed in a private main context, which the calling thread runs while it waits for them. Cancelling page_cancellable
+	 * (when the caller's cancellable is cancelled, or a page fails) cancels all the pages still in flight. */
+	GMainContext *context;
+	GMainLoop *main_loop;
+	GCancellable *page_cancellable;
+	guint max_connections;
+
+	/* The start-index windows still to be requested, as worked out from the first page; and the pages requested so far, in order */
+	guint first_start_index;
+	guint items_per_page;
+	guint next_start_index;
+	guint last_index;
+	GPtrArray *pages;
+	guint n_pending;
+
+	GError *error;
+};
+
+static gboolean
+query_all_page_complete_cb (GDataService *self, SoupMessage *message, GSimpleAsyncResult *result, GCancellable *cancellable)
+{
+	QueryAllPage *page = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+
+	page->feed = process_query_response (self, message, NULL, &(page->stream_data), cancellable, &error);
+	if (error != NULL) {
+		g_simple_async_result_set_from_error (result, error);
+		g_error_free (error);
+	}
+
+	return TRUE;
+}
+
+static void query_all_page_cb (GDataService *service, GAsyncResult *async_result, QueryAllPage *page);
+
+static void
+query_all_queue_page (QueryAllData *all, gint start_index, gint max_results, guint entry_offset)
+{
+	GDataServiceClass *klass = GDATA_SERVICE_GET_CLASS (all->service);
+	GSimpleAsyncResult *result;
+	GDataParsableStream *stream;
+	SoupMessage *message;
+	QueryAllPage *page;
+	gchar *query_uri;
+
+	page = g_slice_new0 (QueryAllPage);
+	page->all = all;
+
+	query_uri = _gdata_query_get_query_uri_for_page (all->query, all->feed_uri, start_index, max_results);
+	message = soup_message_new (SOUP_METHOD_GET, query_uri);
+	g_free (query_uri);
+
+	/* Make sure subclasses set their headers */
+	if (klass->append_query_headers != NULL)
+		klass->append_query_headers (all->service, message);
+
+	/* The progress callback's keys and counts cover the whole feed, rather than each page; and it's called in the context of the thread
+	 * which made the query, rather than the private one */
+	stream = _gdata_feed_stream_new (klass->feed_type, all->entry_type, all->query, entry_offset, TRUE, all->progress_callback,
+					 all->progress_user_data);
+	_gdata_feed_stream_set_progress_context (stream, all->progress_context);
+	query_stream_data_init (&(page->stream_data), all->service, all->service->priv->async_session, message, NULL, stream,
+				all->page_cancellable);
+
+	g_ptr_array_add (all->pages, page);
+	all->n_pending++;
+
+	/* The private context is the thread-default while the query's running, so the result's completed in it */
+	result = g_simple_async_result_new (G_OBJECT (all->service), (GAsyncReadyCallback) query_all_page_cb, page, gdata_service_query_all);
+	g_simple_async_result_set_op_res_gpointer (result, page, NULL);
+	queue_message (all->service, message, result, all->page_cancellable, query_all_page_complete_cb);
+	g_object_unref (result);
+}
+
+static void
+query_all_queue_next_page (QueryAllData *all)
+{
+	query_all_queue_page (all, all->next_start_index, all->items_per_page, all->next_start_index - all->first_start_index);
+	all->next_start_index += all->items_per_page;
+}
+
+static void
+query_all_page_cb (GDataService *service, GAsyncResult *async_result, QueryAllPage *page)
+{
+	QueryAllData *all = page->all;
+	GDataFeed *feed;
+	GError *error = NULL;
+
+	all->n_pending--;
+
+	/* Keep the first error, and don't bother downloading the rest of the feed if one of the pages has failed */
+	if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (async_result), &error) == TRUE) {
+		if (all->error == NULL) {
+			all->error = error;
+			g_cancellable_cancel (all->page_cancellable);
+		} else {
+			g_error_free (error);
+		}
+	}
+
+	if (all->error == NULL && g_cancellable_is_cancelled (all->page_cancellable) == FALSE) {
+		if (page == g_ptr_array_index (all->pages, 0) && page->feed != NULL) {
+			/* Work out the start-index windows of the rest of the feed from the first page, and start downloading them */
+			feed = page->feed;
+			all->first_start_index = MAX (gdata_feed_get_start_index (feed), 1);
+			all->items_per_page = gdata_feed_get_items_per_page (feed);
+			if (all->items_per_page == 0)
+				all->items_per_page = _gdata_feed_get_n_parsed_entries (feed);
+			all->next_start_index = all->first_start_index + all->items_per_page;
+			all->last_index = (all->items_per_page > 0) ? gdata_feed_get_total_results (feed) : 0;
+
+			while (all->n_pending < all->max_connections && all->next_start_index <= all->last_index)
+				query_all_queue_next_page (all);
+		} else if (all->next_start_index <= all->last_index) {
+			query_all_queue_next_page (all);
+		}
+	}
+
+	if (all->n_pending == 0)
+		g_main_loop_quit (all->main_loop);
+}
+
+static void
+query_all_cancelled_cb (GCancellable *cancellable, QueryAllData *all)
+{
+	/* This may be called from any thread; cancelling the pages' cancellable cancels their operations from the I/O thread */
+	g_cancellable_cancel (all->page_cancellable);
 }
 
 /**
- * gdata_service_query:
+ * gdata_service_query_all:
  * @self: a #GDataService
  * @feed_uri: the feed URI to query, including the host name and protocol
  * @query: a #GDataQuery with the query parameters, or %NULL
  * @entry_type: a #GType for the #GDataEntry<!-- -->s to build from the XML
+ * @max_connections: the maximum number of pages to download at once, or %0 to use the default
  * @cancellable: optional #GCancellable object, or %NULL
  * @progress_callback: a #GDataQueryProgressCallback to call when an entry is loaded, or %NULL
  * @progress_user_data: data to pass to the @progress_callback function
  * @error: a #GError, or %NULL
  *
- * Queries the service's @feed_uri feed to build a #GDataFeed.
+ * Queries the service's @feed_uri feed to build a #GDataFeed containing every entry in the result set, rather than just the first page of them.
  *
- * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
- * If the operation was cancelled, the error %G_IO_ERROR_CANCELLED will be returned.
+ * The first page of results is downloaded to find out (from its #GDataFeed:total-results and #GDataFeed:items-per-page properties) how many
+ * more pages there are. The rest of the pages are then requested by #GDataQuery:start-index, with up to @max_connections of them being
+ * downloaded at once, and their entries are appended to the first page's feed in order. The returned feed's other properties are those of the
+ * first page. If @query has its #GDataQuery:max-results property set, it's used as the size of the first page.
  *
- * A %GDATA_SERVICE_ERROR_WITH_QUERY will be returned if the server indicates there is a problem with the query, but subclasses may override
- * this and return their own errors. See their documentation for more details.
+ * Each page is requested as an asynchronous operation, so the pages count towards the #GDataService:max-operations limit and the library-wide
+ * limit set with gdata_service_set_max_total_operations(), and fewer than @max_connections of them may be downloaded at once if the limits
+ * are reached.
  *
- * For each entry in the response feed, @progress_callback will be called in the main thread. If there was an error parsing the XML response,
- * a #GDataParserError will be returned.
+ * @progress_callback is called for each entry as in gdata_service_query(), but the entry keys and count it's passed cover the whole result set,
+ * rather than each page. Since the pages are downloaded concurrently, the callbacks for later pages may be called before those for earlier ones.
  *
- * If the query is successful and the feed supports pagination, @query will be updated with the pagination URIs, and the next or previous page
- * can then be loaded by calling gdata_query_next_page() or gdata_query_previous_page() before running the query again.
+ * @query is not modified, and its #GDataQuery:etag property and pagination URIs are ignored. The #GDataService:cache-directory property is
+ * honoured for each page.
  *
- * If the #GDataQuery's ETag is set and it finds a match on the server, %FALSE will be returned, but @error will remain unset. Otherwise,
- * @query's ETag will be updated with the ETag from the returned feed, if available.
+ * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
+ * If the operation was cancelled, the error %G_IO_ERROR_CANCELLED will be returned.
  *
- * Return value: a #GDataFeed of query results, or %NULL; unref with g_object_unref()
+ * If any of the pages can't be downloaded or parsed, the query is aborted and the error from that page is returned, as it would be from
+ * gdata_service_query().
+ *
+ * Return value: a #GDataFeed of all the query results, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.4.0
  **/
 GDataFeed *
-gdata_service_query (GDataService *self, const gchar *feed_uri, GDataQuery *query, GType entry_type,
-		     GCancellable *cancellable, GDataQueryProgressCallback progress_callback, gpointer progress_user_data, GError **error)
+gdata_service_query_all (GDataService *self, const gchar *feed_uri, GDataQuery *query, GType entry_type, guint max_connections,
+			 GCancellable *cancellable, GDataQueryProgressCallback progress_callback, gpointer progress_user_data, GError **error)
 {
-	GDataServiceClass *klass;
-	GDataFeed *feed;
-	SoupMessage *message;
-	gchar *query_uri;
-	guint status;
-	GDataLink *link;
+	QueryAllData all;
+	QueryAllPage *page;
+	GDataFeed *feed = NULL;
+	gulong cancelled_signal = 0;
+	guint i;
 
 	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
 	g_return_val_if_fail (feed_uri != NULL, NULL);
+	g_return_val_if_fail (query == NULL || GDATA_IS_QUERY (query), NULL);
 	g_return_val_if_fail (entry_type != G_TYPE_INVALID, NULL);
 
-	if (query != NULL) {
-		query_uri = gdata_query_get_query_uri (query, feed_uri);
-		message = soup_message_new (SOUP_METHOD_GET, query_uri);
-		g_free (query_uri);
-	} else {
-		message = soup_message_new (SOUP_METHOD_GET, feed_uri);
+	memset (&all, 0, sizeof (all));
+	all.service = self;
+	all.feed_uri = feed_uri;
+	all.query = (query != NULL) ? g_object_ref (query) : gdata_query_new (NULL);
+	all.entry_type = entry_type;
+	all.progress_callback = progress_callback;
+	all.progress_user_data = progress_user_data;
+	all.progress_context = g_main_context_get_thread_default ();
+	all.page_cancellable = g_cancellable_new ();
+	all.max_connections = (max_connections > 0) ? max_connections : DEFAULT_QUERY_ALL_CONNECTIONS;
+	all.pages = g_ptr_array_new ();
+
+	all.context = g_main_context_new ();
+	all.main_loop = g_main_loop_new (all.context, FALSE);
+	g_main_context_push_thread_default (all.context);
+
+	if (cancellable != NULL)
+		cancelled_signal = g_cancellable_connect (cancellable, (GCallback) query_all_cancelled_cb, &all, NULL);
+
+	/* Download the first page; the rest are queued from query_all_page_cb() once it's arrived */
+	query_all_queue_page (&all, gdata_query_get_start_index (all.query), gdata_query_get_max_results (all.query), 0);
+	g_main_loop_run (all.main_loop);
+
+	/* This waits for query_all_cancelled_cb() to return if it's running in another thread, since it uses the stack-allocated data */
+	if (cancelled_signal != 0)
+		g_cancellable_disconnect (cancellable, cancelled_signal);
+
+	g_main_context_pop_thread_default (all.context);
+
+	/* Report cancellation by the caller as such, rather than as whatever error the page it interrupted returned */
+	if (g_cancellable_is_cancelled (cancellable) == TRUE) {
+		g_clear_error (&(all.error));
+		g_cancellable_set_error_if_cancelled (cancellable, &(all.error));
 	}
 
+	/* Merge the pages into the first one, in order */
+	for (i = 0; i < all.pages->len; i++) {
+		page = g_ptr_array_index (all.pages, i);
+
+		if (all.error == NULL && page->feed != NULL) {
+			if (feed == NULL)
+				feed = g_object_ref (page->feed);
+			else
+				_gdata_feed_append_entries (feed, page->feed);
+		}
+
+		query_stream_data_clear (&(page->stream_data));
+		if (page->feed != NULL)
+			g_object_unref (page->feed);
+		g_slice_free (QueryAllPage, page);
+	}
+
+	g_ptr_array_free (all.pages, TRUE);
+
+	g_main_loop_unref (all.main_loop);
+	g_main_context_unref (all.context);
+	g_object_unref (all.page_cancellable);
+	g_object_unref (all.query);
+
+	if (all.error != NULL)
+		g_propagate_error (error, all.error);
+
+	return feed;
+}
+
+static SoupMessage *
+build_entry_message (GDataService *self, const gchar *method, const gchar *uri, GDataEntry *entry, gboolean with_body)
+{
+	GDataServiceClass *klass;
+	SoupMessage *message;
+	gchar *upload_data;
+
+	message = soup_message_new (method, uri);
+
 	/* Make sure subclasses set their headers */
 	klass = GDATA_SERVICE_GET_CLASS (self);
 	if (klass->append_query_headers != NULL)
 		klass->append_query_headers (self, message);
 
 	/* Append the ETag header if possible */
-	if (query != NULL && gdata_query_get_etag (query) != NULL)
-		soup_message_headers_append (message->request_headers, "If-None-Match", gdata_query_get_etag (query));
-
-	/* Send the message */
-	status = soup_session_send_message (self->priv->session, message);
+	if (method != SOUP_METHOD_POST && gdata_entry_get_etag (entry) != NULL)
+		soup_message_headers_append (message->request_headers, "If-Match", gdata_entry_get_etag (entry));
 
-	/* Check for cancellation */
-	if (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE) {
-		g_object_unref (message);
-		return NULL;
+	/* Append the data */
+	if (with_body == TRUE) {
+		upload_data = gdata_entry_get_xml (entry);
+		soup_message_set_request (message, "application/atom+xml", SOUP_MEMORY_TAKE, upload_data, strlen (upload_data));
 	}
 
-	if (status == 304) {
-		/* Not modified; ETag has worked */
-		g_object_unref (message);
-		return NULL;
-	} else if (status != 200) {
-		/* Error */
-		g_assert (klass->parse_error_response != NULL);
-		klass->parse_error_response (self, GDATA_SERVICE_ERROR_WITH_QUERY, status, message->reason_phrase, message->response_body->data,
-					     message->response_body->length, error);
-		g_object_unref (message);
-		return NULL;
-	}
+	return message;
+}
 
-	g_assert (message->response_body->data != NULL);
+static SoupMessage *
+build_edit_message (GDataService *self, const gchar *method, GDataEntry *entry, gboolean with_body)
+{
+	GDataLink *link;
 
-	feed = _gdata_feed_new_from_xml (klass->feed_type, message->response_body->data, message->response_body->length, entry_type,
-					 progress_callback, progress_user_data, error);
-	g_object_unref (message);
+	/* Get the edit URI */
+	link = gdata_entry_look_up_link (entry, "edit");
+	g_assert (link != NULL);
 
-	/* Update the query with the feed's ETag */
-	if (query != NULL && feed != NULL && gdata_feed_get_etag (feed) != NULL)
-		gdata_query_set_etag (query, gdata_feed_get_etag (feed));
+	return build_entry_message (self, method, link->href, entry, with_body);
+}
 
-	/* Update the query with the next and previous URIs from the feed */
-	if (query != NULL && feed != NULL) {
-		link = gdata_feed_look_up_link (feed, "next");
-		if (link != NULL)
-			_gdata_query_set_next_uri (query, link->href);
-		link = gdata_feed_look_up_link (feed, "previous");
-		if (link != NULL)
-			_gdata_query_set_previous_uri (query, link->href);
-	}
+static GDataEntry *
+process_entry_response (GDataService *self, SoupMessage *message, guint expected_status, GDataServiceError error_type, GType entry_type,
+			GError **error)
+{
+	if (check_response_status (self, message, expected_status, error_type, error) == FALSE)
+		return NULL;
 
-	return feed;
+	/* Build the updated entry */
+	g_assert (message->response_body->data != NULL);
+
+	/* Parse the XML; create and return a new GDataEntry of the same type as the original entry */
+	return _gdata_entry_new_from_xml (entry_type, message->response_body->data, message->response_body->length, error);
 }
 
 typedef struct {
@@ -1063,31 +2418,25 @@ insert_entry_async_data_free (InsertEntryAsyncData *self)
 	g_slice_free (InsertEntryAsyncData, self);
 }
 
-static void
-insert_entry_thread (GSimpleAsyncResult *result, GDataService *service, GCancellable *cancellable)
+static gboolean
+insert_entry_complete_cb (GDataService *self, SoupMessage *message, GSimpleAsyncResult *result, GCancellable *cancellable)
 {
 	GDataEntry *updated_entry;
 	GError *error = NULL;
 	InsertEntryAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
 
-	/* Check to see if it's been cancelled already */
-	if (g_cancellable_set_error_if_cancelled (cancellable, &error) == TRUE) {
-		g_simple_async_result_set_from_error (result, error);
-		g_error_free (error);
-		return;
-	}
-
-	/* Insert the entry and return */
-	updated_entry = gdata_service_insert_entry (service, data->upload_uri, data->entry, cancellable, &error);
+	updated_entry = process_entry_response (self, message, 201, GDATA_SERVICE_ERROR_WITH_INSERTION, G_OBJECT_TYPE (data->entry), &error);
 	if (updated_entry == NULL) {
 		g_simple_async_result_set_from_error (result, error);
 		g_error_free (error);
-		return;
+		return TRUE;
 	}
 
 	/* Swap the old entry with the new one */
 	g_object_unref (data->entry);
 	data->entry = updated_entry;
+
+	return TRUE;
 }
 
 /**
@@ -1126,7 +2475,16 @@ gdata_service_insert_entry_async (GDataService *self, const gchar *upload_uri, G
 
 	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_insert_entry_async);
 	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) insert_entry_async_data_free);
-	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) insert_entry_thread, G_PRIORITY_DEFAULT, cancellable);
+
+	if (gdata_entry_is_inserted (entry) == TRUE) {
+		g_simple_async_result_set_error (result, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_ENTRY_ALREADY_INSERTED, "%s",
+						 _("The entry has already been inserted."));
+		g_simple_async_result_complete_in_idle (result);
+	} else {
+		queue_message (self, build_entry_message (self, SOUP_METHOD_POST, upload_uri, entry, TRUE), result, cancellable,
+			       insert_entry_complete_cb);
+	}
+
 	g_object_unref (result);
 }
 
@@ -1191,10 +2549,8 @@ gdata_service_insert_entry_finish (GDataService *self, GAsyncResult *async_resul
 GDataEntry *
 gdata_service_insert_entry (GDataService *self, const gchar *upload_uri, GDataEntry *entry, GCancellable *cancellable, GError **error)
 {
-	GDataServiceClass *klass;
 	GDataEntry *updated_entry;
 	SoupMessage *message;
-	gchar *upload_data;
 	guint status;
 
 	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
@@ -1207,16 +2563,7 @@ gdata_service_insert_entry (GDataService *self, const gchar *upload_uri, GDataEn
 		return NULL;
 	}
 
-	message = soup_message_new (SOUP_METHOD_POST, upload_uri);
-
-	/* Make sure subclasses set their headers */
-	klass = GDATA_SERVICE_GET_CLASS (self);
-	if (klass->append_query_headers != NULL)
-		klass->append_query_headers (self, message);
-
-	/* Append the data */
-	upload_data = gdata_entry_get_xml (entry);
-	soup_message_set_request (message, "application/atom+xml", SOUP_MEMORY_TAKE, upload_data, strlen (upload_data));
+	message = build_entry_message (self, SOUP_METHOD_POST, upload_uri, entry, TRUE);
 
 	/* Send the message */
 	status = _gdata_service_send_message (self, message, error);
@@ -1231,48 +2578,30 @@ gdata_service_insert_entry (GDataService *self, const gchar *upload_uri, GDataEn
 		return NULL;
 	}
 
-	if (status != 201) {
-		/* Error */
-		g_assert (klass->parse_error_response != NULL);
-		klass->parse_error_response (self, GDATA_SERVICE_ERROR_WITH_INSERTION, status, message->reason_phrase, message->response_body->data,
-					     message->response_body->length, error);
-		g_object_unref (message);
-		return NULL;
-	}
-
-	/* Build the updated entry */
-	g_assert (message->response_body->data != NULL);
-
-	/* Parse the XML; create and return a new GDataEntry of the same type as @entry */
-	updated_entry = _gdata_entry_new_from_xml (G_OBJECT_TYPE (entry), message->response_body->data, message->response_body->length, error);
+	updated_entry = process_entry_response (self, message, 201, GDATA_SERVICE_ERROR_WITH_INSERTION, G_OBJECT_TYPE (entry), error);
 	g_object_unref (message);
 
 	return updated_entry;
 }
 
-static void
-update_entry_thread (GSimpleAsyncResult *result, GDataService *service, GCancellable *cancellable)
+static gboolean
+update_entry_complete_cb (GDataService *self, SoupMessage *message, GSimpleAsyncResult *result, GCancellable *cancellable)
 {
 	GDataEntry *updated_entry;
 	GError *error = NULL;
+	GDataEntry *entry = g_simple_async_result_get_op_res_gpointer (result);
 
-	/* Check to see if it's been cancelled already */
-	if (g_cancellable_set_error_if_cancelled (cancellable, &error) == TRUE) {
-		g_simple_async_result_set_from_error (result, error);
-		g_error_free (error);
-		return;
-	}
-
-	/* Update the entry and return */
-	updated_entry = gdata_service_update_entry (service, g_simple_async_result_get_op_res_gpointer (result), cancellable, &error);
+	updated_entry = process_entry_response (self, message, 200, GDATA_SERVICE_ERROR_WITH_UPDATE, G_OBJECT_TYPE (entry), &error);
 	if (updated_entry == NULL) {
 		g_simple_async_result_set_from_error (result, error);
 		g_error_free (error);
-		return;
+		return TRUE;
 	}
 
 	/* Swap the old entry with the new one */
 	g_simple_async_result_set_op_res_gpointer (result, updated_entry, (GDestroyNotify) g_object_unref);
+
+	return TRUE;
 }
 
 /**
@@ -1303,7 +2632,7 @@ gdata_service_update_entry_async (GDataService *self, GDataEntry *entry, GCancel
 
 	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_update_entry_async);
 	g_simple_async_result_set_op_res_gpointer (result, g_object_ref (entry), (GDestroyNotify) g_object_unref);
-	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) update_entry_thread, G_PRIORITY_DEFAULT, cancellable);
+	queue_message (self, build_edit_message (self, SOUP_METHOD_PUT, entry, TRUE), result, cancellable, update_entry_complete_cb);
 	g_object_unref (result);
 }
 
@@ -1366,33 +2695,14 @@ gdata_service_update_entry_finish (GDataService *self, GAsyncResult *async_resul
 GDataEntry *
 gdata_service_update_entry (GDataService *self, GDataEntry *entry, GCancellable *cancellable, GError **error)
 {
-	GDataServiceClass *klass;
 	GDataEntry *updated_entry;
-	GDataLink *link;
 	SoupMessage *message;
-	gchar *upload_data;
 	guint status;
 
 	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
 	g_return_val_if_fail (GDATA_IS_ENTRY (entry), NULL);
 
-	/* Get the edit URI */
-	link = gdata_entry_look_up_link (entry, "edit");
-	g_assert (link != NULL);
-	message = soup_message_new (SOUP_METHOD_PUT, link->href);
-
-	/* Make sure subclasses set their headers */
-	klass = GDATA_SERVICE_GET_CLASS (self);
-	if (klass->append_query_headers != NULL)
-		klass->append_query_headers (self, message);
-
-	/* Append the ETag header if possible */
-	if (gdata_entry_get_etag (entry) != NULL)
-		soup_message_headers_append (message->request_headers, "If-Match", gdata_entry_get_etag (entry));
-
-	/* Append the data */
-	upload_data = gdata_entry_get_xml (entry);
-	soup_message_set_request (message, "application/atom+xml", SOUP_MEMORY_TAKE, upload_data, strlen (upload_data));
+	message = build_edit_message (self, SOUP_METHOD_PUT, entry, TRUE);
 
 	/* Send the message */
 	status = _gdata_service_send_message (self, message, error);
@@ -1407,48 +2717,27 @@ gdata_service_update_entry (GDataService *self, GDataEntry *entry, GCancellable
 		return NULL;
 	}
 
-	if (status != 200) {
-		/* Error */
-		g_assert (klass->parse_error_response != NULL);
-		klass->parse_error_response (self, GDATA_SERVICE_ERROR_WITH_UPDATE, status, message->reason_phrase, message->response_body->data,
-					     message->response_body->length, error);
-		g_object_unref (message);
-		return NULL;
-	}
-
-	/* Build the updated entry */
-	g_assert (message->response_body->data != NULL);
-
-	/* Parse the XML; create and return a new GDataEntry of the same type as @entry */
-	updated_entry = _gdata_entry_new_from_xml (G_OBJECT_TYPE (entry), message->response_body->data, message->response_body->length, error);
+	updated_entry = process_entry_response (self, message, 200, GDATA_SERVICE_ERROR_WITH_UPDATE, G_OBJECT_TYPE (entry), error);
 	g_object_unref (message);
 
 	return updated_entry;
 }
 
-static void
-delete_entry_thread (GSimpleAsyncResult *result, GDataService *service, GCancellable *cancellable)
+static gboolean
+delete_entry_complete_cb (GDataService *self, SoupMessage *message, GSimpleAsyncResult *result, GCancellable *cancellable)
 {
-	gboolean success;
 	GError *error = NULL;
 
-	/* Check to see if it's been cancelled already */
-	if (g_cancellable_set_error_if_cancelled (cancellable, &error) == TRUE) {
-		g_simple_async_result_set_from_error (result, error);
-		g_error_free (error);
-		return;
-	}
-
-	/* Delete the entry and return */
-	success = gdata_service_delete_entry (service, g_simple_async_result_get_op_res_gpointer (result), cancellable, &error);
-	if (success == FALSE) {
+	if (check_response_status (self, message, 200, GDATA_SERVICE_ERROR_WITH_DELETION, &error) == FALSE) {
 		g_simple_async_result_set_from_error (result, error);
 		g_error_free (error);
-		return;
+		return TRUE;
 	}
 
 	/* Replace the entry with the success value */
-	g_simple_async_result_set_op_res_gboolean (result, success);
+	g_simple_async_result_set_op_res_gboolean (result, TRUE);
+
+	return TRUE;
 }
 
 /**
@@ -1479,7 +2768,7 @@ gdata_service_delete_entry_async (GDataService *self, GDataEntry *entry, GCancel
 
 	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_delete_entry_async);
 	g_simple_async_result_set_op_res_gpointer (result, g_object_ref (entry), (GDestroyNotify) g_object_unref);
-	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) delete_entry_thread, G_PRIORITY_DEFAULT, cancellable);
+	queue_message (self, build_edit_message (self, SOUP_METHOD_DELETE, entry, FALSE), result, cancellable, delete_entry_complete_cb);
 	g_object_unref (result);
 }
 
@@ -1535,27 +2824,14 @@ gdata_service_delete_entry_finish (GDataService *self, GAsyncResult *async_resul
 gboolean
 gdata_service_delete_entry (GDataService *self, GDataEntry *entry, GCancellable *cancellable, GError **error)
 {
-	GDataServiceClass *klass;
-	GDataLink *link;
 	SoupMessage *message;
 	guint status;
+	gboolean success;
 
 	g_return_val_if_fail (GDATA_IS_SERVICE (self), FALSE);
 	g_return_val_if_fail (GDATA_IS_ENTRY (entry), FALSE);
 
-	/* Get the edit URI */
-	link = gdata_entry_look_up_link (entry, "edit");
-	g_assert (link != NULL);
-	message = soup_message_new (SOUP_METHOD_DELETE, link->href);
-
-	/* Make sure subclasses set their headers */
-	klass = GDATA_SERVICE_GET_CLASS (self);
-	if (klass->append_query_headers != NULL)
-		klass->append_query_headers (self, message);
-
-	/* Append the ETag header if possible */
-	if (gdata_entry_get_etag (entry) != NULL)
-		soup_message_headers_append (message->request_headers, "If-Match", gdata_entry_get_etag (entry));
+	message = build_edit_message (self, SOUP_METHOD_DELETE, entry, FALSE);
 
 	/* Send the message */
 	status = _gdata_service_send_message (self, message, error);
@@ -1570,18 +2846,10 @@ gdata_service_delete_entry (GDataService *self, GDataEntry *entry, GCancellable
 		return FALSE;
 	}
 
-	if (status != 200) {
-		/* Error */
-		g_assert (klass->parse_error_response != NULL);
-		klass->parse_error_response (self, GDATA_SERVICE_ERROR_WITH_DELETION, status, message->reason_phrase, message->response_body->data,
-					     message->response_body->length, error);
-		g_object_unref (message);
-		return FALSE;
-	}
-
+	success = check_response_status (self, message, 200, GDATA_SERVICE_ERROR_WITH_DELETION, error);
 	g_object_unref (message);
 
-	return TRUE;
+	return success;
 }
 
 static void
@@ -1628,9 +2896,122 @@ gdata_service_set_proxy_uri (GDataService *self, SoupURI *proxy_uri)
 {
 	g_return_if_fail (GDATA_IS_SERVICE (self));
 	g_object_set (self->priv->session, SOUP_SESSION_PROXY_URI, proxy_uri, NULL);
+	g_object_set (self->priv->async_session, SOUP_SESSION_PROXY_URI, proxy_uri, NULL);
 	g_object_notify (G_OBJECT (self), "proxy-uri");
 }
 
+/**
+ * gdata_service_get_cache_directory:
+ * @self: a #GDataService
+ *
+ * Gets the #GDataService:cache-directory property.
+ *
+ * Return value: the directory in which query responses are cached, or %NULL
+ *
+ * Since: 0.4.0
+ **/
+const gchar *
+gdata_service_get_cache_directory (GDataService *self)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	return self->priv->cache_directory;
+}
+
+/**
+ * gdata_service_set_cache_directory:
+ * @self: a #GDataService
+ * @cache_directory: a directory in which to cache query responses, or %NULL
+ *
+ * Sets the #GDataService:cache-directory property to @cache_directory. If @cache_directory is %NULL, query responses will not be cached.
+ * Any responses already cached in a previous directory are left untouched.
+ *
+ * Since: 0.4.0
+ **/
+void
+gdata_service_set_cache_directory (GDataService *self, const gchar *cache_directory)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+
+	g_free (self->priv->cache_directory);
+	self->priv->cache_directory = g_strdup (cache_directory);
+	g_object_notify (G_OBJECT (self), "cache-directory");
+}
+
+/**
+ * gdata_service_get_max_operations:
+ * @self: a #GDataService
+ *
+ * Gets the #GDataService:max-operations property.
+ *
+ * Return value: the maximum number of the service's asynchronous operations in flight at once, or %0 if there's no per-service limit
+ *
+ * Since: 0.4.0
+ **/
+guint
+gdata_service_get_max_operations (GDataService *self)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), 0);
+	return (guint) g_atomic_int_get (&(self->priv->max_operations));
+}
+
+/**
+ * gdata_service_set_max_operations:
+ * @self: a #GDataService
+ * @max_operations: the maximum number of asynchronous operations in flight at once, or %0
+ *
+ * Sets the #GDataService:max-operations property to @max_operations. If @max_operations is %0, the service's asynchronous operations are
+ * only limited by gdata_service_set_max_total_operations(). Lowering the limit doesn't affect operations which are already in flight.
+ *
+ * Since: 0.4.0
+ **/
+void
+gdata_service_set_max_operations (GDataService *self, guint max_operations)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+
+	g_atomic_int_set (&(self->priv->max_operations), (gint) MIN (max_operations, G_MAXINT));
+	g_object_notify (G_OBJECT (self), "max-operations");
+
+	/* Raising the limit may let some pending operations run */
+	io_invoke ((GSourceFunc) run_pending_operations_idle, NULL);
+}
+
+/**
+ * gdata_service_get_max_total_operations:
+ *
+ * Gets the maximum number of asynchronous operations which may be in flight at once, across all #GDataService<!-- -->s.
+ *
+ * Return value: the maximum number of asynchronous operations in flight at once, or %0 if there's no limit
+ *
+ * Since: 0.4.0
+ **/
+guint
+gdata_service_get_max_total_operations (void)
+{
+	return (guint) g_atomic_int_get (&max_total_operations);
+}
+
+/**
+ * gdata_service_set_max_total_operations:
+ * @max_operations: the maximum number of asynchronous operations in flight at once, or %0
+ *
+ * Sets the maximum number of asynchronous operations which may be in flight at once, across all #GDataService<!-- -->s. Operations beyond
+ * this limit are queued, and are started in the order they were made as earlier operations finish, subject to each service's
+ * #GDataService:max-operations property. If @max_operations is %0, the number of operations in flight is only limited per service.
+ *
+ * The default limit is 32.
+ *
+ * Since: 0.4.0
+ **/
+void
+gdata_service_set_max_total_operations (guint max_operations)
+{
+	g_atomic_int_set (&max_total_operations, (gint) MIN (max_operations, G_MAXINT));
+
+	/* Raising the limit may let some pending operations run */
+	io_invoke ((GSourceFunc) run_pending_operations_idle, NULL);
+}
+
 /**
  * gdata_service_is_authenticated:
  * @self: a #GDataService
@@ -95,9 +95,11 @@ typedef enum {
  *
  * Callback function called for each #GDataEntry parsed in a #GDataFeed when loading the results of a query.
  *
- * It is called in the main thread, so there is no guarantee on the order in which the callbacks are executed,
- * or whether they will be called in a timely manner. It is, however, guaranteed that they will all be called before
- * the #GAsyncReadyCallback which signals the completion of the query is called.
+ * It is called in the thread-default #GMainContext of the thread which made the query (see g_main_context_get_thread_default()),
+ * so there is no guarantee on the order in which the callbacks are executed, or whether they will be called in a timely manner.
+ * It is, however, guaranteed that they will all be called before the #GAsyncReadyCallback which signals the completion of the query
+ * is called. If the query's flags include %GDATA_QUERY_FLAGS_SYNCHRONOUS_PROGRESS, it's instead called in the thread which parsed
+ * the entry, as soon as the entry's been parsed.
  **/
 typedef void (*GDataQueryProgressCallback) (GDataEntry *entry, guint entry_key, guint entry_count, gpointer user_data);
 
@@ -171,6 +173,9 @@ void gdata_service_query_async (GDataService *self, const gchar *feed_uri, GData
 				GDataQueryProgressCallback progress_callback, gpointer progress_user_data,
 				GAsyncReadyCallback callback, gpointer user_data);
 GDataFeed *gdata_service_query_finish (GDataService *self, GAsyncResult *async_result, GError **error) G_GNUC_WARN_UNUSED_RESULT;
+GDataFeed *gdata_service_query_all (GDataService *self, const gchar *feed_uri, GDataQuery *query, GType entry_type, guint max_connections,
+				    GCancellable *cancellable,
+				    GDataQueryProgressCallback progress_callback, gpointer progress_user_data, GError **error) G_GNUC_WARN_UNUSED_RESULT;
 
 GDataEntry *gdata_service_insert_entry (GDataService *self, const gchar *upload_uri, GDataEntry *entry,
 					GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT;
@@ -191,6 +196,14 @@ gboolean gdata_service_delete_entry_finish (GDataService *self, GAsyncResult *as
 SoupURI *gdata_service_get_proxy_uri (GDataService *self);
 void gdata_service_set_proxy_uri (GDataService *self, SoupURI *proxy_uri);
 
+const gchar *gdata_service_get_cache_directory (GDataService *self);
+void gdata_service_set_cache_directory (GDataService *self, const gchar *cache_directory);
+
+guint gdata_service_get_max_operations (GDataService *self);
+void gdata_service_set_max_operations (GDataService *self, guint max_operations);
+guint gdata_service_get_max_total_operations (void);
+void gdata_service_set_max_total_operations (guint max_operations);
+
 gboolean gdata_service_is_authenticated (GDataService *self);
 const gchar *gdata_service_get_client_id (GDataService *self);
 const gchar *gdata_service_get_username (GDataService *self);
@@ -31,6 +31,8 @@
 #include <gdata/gdata-access-handler.h>
 #include <gdata/gdata-access-rule.h>
 #include <gdata/gdata-parsable.h>
+#include <gdata/gdata-batch-operation.h>
+#include <gdata/gdata-feed-iterator.h>
 
 /* Namespaces */
 #include <gdata/gdata-atom.h>
@@ -43,6 +45,7 @@
 #include <gdata/services/youtube/gdata-youtube-service.h>
 #include <gdata/services/youtube/gdata-youtube-query.h>
 #include <gdata/services/youtube/gdata-youtube-video.h>
+#include <gdata/services/youtube/gdata-youtube-upload-queue.h>
 #include <gdata/services/youtube/gdata-youtube.h>
 #include <gdata/services/youtube/gdata-youtube-enums.h>
 
@@ -457,7 +457,7 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 	if (xmlStrcmp (node->name, (xmlChar*) "edited") == 0) {
 		/* app:edited */
 		xmlChar *edited = xmlNodeListGetString (doc, node->children, TRUE);
-		if (g_time_val_from_iso8601 ((gchar*) edited, &(self->priv->edited)) == FALSE) {
+		if (gdata_parser_time_val_from_iso8601 ((gchar*) edited, &(self->priv->edited)) == FALSE) {
 			/* Error */
 			gdata_parser_error_not_iso8601_format (node, (gchar*) edited, error);
 			xmlFree (edited);
@@ -542,7 +542,7 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 		start_time = xmlGetProp (node, (xmlChar*) "startTime");
 		if (gdata_parser_time_val_from_date ((gchar*) start_time, &start_time_timeval) == TRUE) {
 			is_date = TRUE;
-		} else if (g_time_val_from_iso8601 ((gchar*) start_time, &start_time_timeval) == FALSE) {
+		} else if (gdata_parser_time_val_from_iso8601 ((gchar*) start_time, &start_time_timeval) == FALSE) {
 			/* Error */
 			gdata_parser_error_not_iso8601_format (node, (gchar*) start_time, error);
 			xmlFree (start_time);
@@ -558,7 +558,7 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 			if (is_date == TRUE)
 				success = gdata_parser_time_val_from_date ((gchar*) end_time, &end_time_timeval);
 			else
-				success = g_time_val_from_iso8601 ((gchar*) end_time, &end_time_timeval);
+				success = gdata_parser_time_val_from_iso8601 ((gchar*) end_time, &end_time_timeval);
 
 			if (success == FALSE) {
 				/* Error */
@@ -709,27 +709,23 @@ get_xml (GDataEntry *entry, GString *xml_string)
 		g_string_append_printf (xml_string, "<gd:recurrence>%s</gd:recurrence>", priv->recurrence);
 
 	for (i = priv->times; i != NULL; i = i->next) {
-		gchar *start_time;
+		gchar buffer[GDATA_PARSER_ISO8601_BUFFER_SIZE];
 		GDataGDWhen *when = (GDataGDWhen*) i->data;
 
 		if (when->is_date == TRUE)
-			start_time = gdata_parser_date_from_time_val (&(when->start_time));
+			gdata_parser_date_from_time_val (&(when->start_time), buffer);
 		else
-			start_time = g_time_val_to_iso8601 (&(when->start_time));
+			gdata_parser_iso8601_from_time_val (&(when->start_time), buffer);
 
-		g_string_append_printf (xml_string, "<gd:when startTime='%s'", start_time);
-		g_free (start_time);
+		g_string_append_printf (xml_string, "<gd:when startTime='%s'", buffer);
 
 		if (when->end_time.tv_sec != 0 || when->end_time.tv_usec != 0) {
-			gchar *end_time;
-
 			if (when->is_date == TRUE)
-				end_time = gdata_parser_date_from_time_val (&(when->end_time));
+				gdata_parser_date_from_time_val (&(when->end_time), buffer);
 			else
-				end_time = g_time_val_to_iso8601 (&(when->end_time));
+				gdata_parser_iso8601_from_time_val (&(when->end_time), buffer);
 
-			g_string_append_printf (xml_string, " endTime='%s'", end_time);
-			g_free (end_time);
+			g_string_append_printf (xml_string, " endTime='%s'", buffer);
 		}
 
 		if (when->value_string != NULL)
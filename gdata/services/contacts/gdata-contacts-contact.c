@@ -240,7 +240,7 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 		/* app:edited */
 		/* TODO: Should be in GDataEntry? */
 		xmlChar *edited = xmlNodeListGetString (doc, node->children, TRUE);
-		if (g_time_val_from_iso8601 ((gchar*) edited, &(self->priv->edited)) == FALSE) {
+		if (gdata_parser_time_val_from_iso8601 ((gchar*) edited, &(self->priv->edited)) == FALSE) {
 			/* Error */
 			gdata_parser_error_not_iso8601_format (node, (gchar*) edited, error);
 			xmlFree (edited);
@@ -1352,29 +1352,10 @@ gdata_contacts_contact_get_photo (GDataContactsContact *self, GDataContactsServi
 	return data;
 }
 
-/**
- * gdata_contacts_contact_set_photo:
- * @self: a #GDataContactsContact
- * @service: a #GDataService
- * @data: the image data, or %NULL
- * @length: the image length, in bytes, or %0
- * @cancellable: optional #GCancellable object, or %NULL
- * @error: a #GError, or %NULL
- *
- * Sets the contact's photo to @data or, if @data is %NULL, deletes the contact's photo.
- *
- * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
- * If the operation was cancelled, the error %G_IO_ERROR_CANCELLED will be returned.
- *
- * If there is an error setting the photo, a %GDATA_SERVICE_ERROR_WITH_UPDATE error will be returned.
- *
- * Return value: %TRUE on success, %FALSE otherwise
- *
- * Since: 0.4.0
- **/
-gboolean
-gdata_contacts_contact_set_photo (GDataContactsContact *self, GDataService *service, gchar *data, gsize length,
-				  GCancellable *cancellable, GError **error)
+/* Sets the contact's photo to the data in @buffer, or deletes it if @buffer is %NULL. The buffer is sent as-is, without being copied. */
+static gboolean
+set_photo (GDataContactsContact *self, GDataService *service, SoupBuffer *buffer, const gchar *content_type,
+	   GCancellable *cancellable, GError **error)
 {
 	GDataServiceClass *klass;
 	GDataLink *link;
@@ -1382,13 +1363,9 @@ gdata_contacts_contact_set_photo (GDataContactsContact *self, GDataService *serv
 	guint status;
 	gboolean adding_photo = FALSE, deleting_photo = FALSE;
 
-	/* TODO: async version */
-	g_return_val_if_fail (GDATA_IS_CONTACTS_CONTACT (self), FALSE);
-	g_return_val_if_fail (GDATA_IS_SERVICE (service), FALSE);
-
-	if (self->priv->photo_etag == NULL && data != NULL)
+	if (self->priv->photo_etag == NULL && buffer != NULL)
 		adding_photo = TRUE;
-	else if (self->priv->photo_etag != NULL && data == NULL)
+	else if (self->priv->photo_etag != NULL && buffer == NULL)
 		deleting_photo = TRUE;
 
 	/* Get the photo URI */
@@ -1408,9 +1385,10 @@ gdata_contacts_contact_set_photo (GDataContactsContact *self, GDataService *serv
 	if (self->priv->photo_etag != NULL)
 		soup_message_headers_append (message->request_headers, "If-Match", self->priv->photo_etag);
 
-	if (deleting_photo == FALSE) {
+	if (deleting_photo == FALSE && buffer != NULL) {
 		/* Append the data */
-		soup_message_set_request (message, "image/*", SOUP_MEMORY_STATIC, (gchar*) data, length);
+		soup_message_headers_set_content_type (message->request_headers, content_type, NULL);
+		soup_message_body_append_buffer (message->request_body, buffer);
 	}
 
 	/* Send the message */
@@ -1445,3 +1423,104 @@ gdata_contacts_contact_set_photo (GDataContactsContact *self, GDataService *serv
 
 	return TRUE;
 }
+
+/**
+ * gdata_contacts_contact_set_photo:
+ * @self: a #GDataContactsContact
+ * @service: a #GDataService
+ * @data: the image data, or %NULL
+ * @length: the image length, in bytes, or %0
+ * @cancellable: optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Sets the contact's photo to @data or, if @data is %NULL, deletes the contact's photo.
+ *
+ * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
+ * If the operation was cancelled, the error %G_IO_ERROR_CANCELLED will be returned.
+ *
+ * If there is an error setting the photo, a %GDATA_SERVICE_ERROR_WITH_UPDATE error will be returned.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.4.0
+ **/
+gboolean
+gdata_contacts_contact_set_photo (GDataContactsContact *self, GDataService *service, gchar *data, gsize length,
+				  GCancellable *cancellable, GError **error)
+{
+	SoupBuffer *buffer = NULL;
+	gboolean success;
+
+	/* TODO: async version */
+	g_return_val_if_fail (GDATA_IS_CONTACTS_CONTACT (self), FALSE);
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), FALSE);
+
+	if (data != NULL)
+		buffer = soup_buffer_new (SOUP_MEMORY_STATIC, data, length);
+
+	success = set_photo (self, service, buffer, "image/*", cancellable, error);
+
+	if (buffer != NULL)
+		soup_buffer_free (buffer);
+
+	return success;
+}
+
+/**
+ * gdata_contacts_contact_set_photo_from_file:
+ * @self: a #GDataContactsContact
+ * @service: a #GDataService
+ * @photo_file: the image file to upload
+ * @cancellable: optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Sets the contact's photo to the contents of @photo_file. If @photo_file is a local file, it's mapped into memory and sent from there,
+ * rather than being loaded first; it mustn't be truncated while the photo is being set.
+ *
+ * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
+ * If the operation was cancelled, the error %G_IO_ERROR_CANCELLED will be returned.
+ *
+ * If there is an error setting the photo, a %GDATA_SERVICE_ERROR_WITH_UPDATE error will be returned. If there is an error reading
+ * @photo_file, an error from g_file_query_info() or g_file_load_contents() will be returned.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.4.0
+ **/
+gboolean
+gdata_contacts_contact_set_photo_from_file (GDataContactsContact *self, GDataService *service, GFile *photo_file,
+					    GCancellable *cancellable, GError **error)
+{
+	GFileInfo *photo_file_info;
+	SoupBuffer *buffer;
+	gboolean success;
+
+	g_return_val_if_fail (GDATA_IS_CONTACTS_CONTACT (self), FALSE);
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (G_IS_FILE (photo_file), FALSE);
+
+	photo_file_info = g_file_query_info (photo_file, "standard::content-type", G_FILE_QUERY_INFO_NONE, cancellable, error);
+	if (photo_file_info == NULL)
+		return FALSE;
+
+	/* Map the file if possible, and load it otherwise */
+	buffer = _gdata_service_map_file (photo_file);
+	if (buffer == NULL) {
+		gchar *data;
+		gsize length;
+
+		if (g_file_load_contents (photo_file, cancellable, &data, &length, NULL, error) == FALSE) {
+			g_object_unref (photo_file_info);
+			return FALSE;
+		}
+
+		buffer = soup_buffer_new (SOUP_MEMORY_TAKE, data, length);
+	}
+
+	success = set_photo (self, service, buffer, g_file_info_get_content_type (photo_file_info), cancellable, error);
+
+	soup_buffer_free (buffer);
+	g_object_unref (photo_file_info);
+
+	return success;
+}
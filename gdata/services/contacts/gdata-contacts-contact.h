@@ -22,6 +22,7 @@
 
 #include <glib.h>
 #include <glib-object.h>
+#include <gio/gio.h>
 
 #include <gdata/gdata-entry.h>
 #include <gdata/gdata-gdata.h>
@@ -101,6 +102,8 @@ gchar *gdata_contacts_contact_get_photo (GDataContactsContact *self, GDataContac
 					  GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT;
 gboolean gdata_contacts_contact_set_photo (GDataContactsContact *self, GDataService *service, gchar *data, gsize length,
 					   GCancellable *cancellable, GError **error);
+gboolean gdata_contacts_contact_set_photo_from_file (GDataContactsContact *self, GDataService *service, GFile *photo_file,
+						     GCancellable *cancellable, GError **error);
 
 G_END_DECLS
 
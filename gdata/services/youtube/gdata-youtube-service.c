@@ -39,6 +39,7 @@
 #include "gdata-youtube-service.h"
 #include "gdata-service.h"
 #include "gdata-private.h"
+#include "gdata-youtube-marshal.h"
 #include "gdata-parser.h"
 
 /* Standards reference here: http://code.google.com/apis/youtube/2.0/reference.html */
@@ -57,16 +58,28 @@ static void append_query_headers (GDataService *self, SoupMessage *message);
 static void parse_error_response (GDataService *self, GDataServiceError error_type, guint status, const gchar *reason_phrase,
 				  const gchar *response_body, gint length, GError **error);
 
+/* The default size of the chunks in which resumable uploads are sent */
+#define DEFAULT_UPLOAD_CHUNK_SIZE (1024 * 1024)
+
 struct _GDataYouTubeServicePrivate {
 	gchar *youtube_user;
 	gchar *developer_key;
+	guint upload_chunk_size;
 };
 
 enum {
 	PROP_DEVELOPER_KEY = 1,
-	PROP_YOUTUBE_USER
+	PROP_YOUTUBE_USER,
+	PROP_UPLOAD_CHUNK_SIZE
+};
+
+enum {
+	SIGNAL_UPLOAD_PROGRESS,
+	LAST_SIGNAL
 };
 
+static guint service_signals[LAST_SIGNAL] = { 0, };
+
 G_DEFINE_TYPE (GDataYouTubeService, gdata_youtube_service, GDATA_TYPE_SERVICE)
 #define GDATA_YOUTUBE_SERVICE_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GDATA_TYPE_YOUTUBE_SERVICE, GDataYouTubeServicePrivate))
 
@@ -113,12 +126,54 @@ gdata_youtube_service_class_init (GDataYouTubeServiceClass *klass)
 					"YouTube username", "The YouTube account username.",
 					NULL,
 					G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataYouTubeService:upload-chunk-size:
+	 *
+	 * The maximum number of bytes of a video to send in each request of a resumable upload, such as those made by
+	 * gdata_youtube_service_upload_chunk() and gdata_youtube_service_resume_upload(). Smaller chunks mean less data has to be re-sent
+	 * if the connection drops part-way through a request, at the cost of more requests.
+	 *
+	 * Since: 0.4.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_UPLOAD_CHUNK_SIZE,
+				g_param_spec_uint ("upload-chunk-size",
+					"Upload chunk size", "The maximum number of bytes to send in each request of a resumable upload.",
+					1, G_MAXUINT, DEFAULT_UPLOAD_CHUNK_SIZE,
+					G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataYouTubeService::upload-progress:
+	 * @service: the #GDataYouTubeService uploading the video
+	 * @video: the #GDataYouTubeVideo being uploaded, as passed to gdata_youtube_service_upload_video()
+	 * @bytes_sent: the number of bytes of the upload request sent so far
+	 * @total_bytes: the total number of bytes in the upload request
+	 * @bytes_per_second: the current throughput of the upload, in bytes per second
+	 *
+	 * The #GDataYouTubeService::upload-progress signal is emitted as a video's data is sent by gdata_youtube_service_upload_video() or
+	 * gdata_youtube_service_upload_video_async(). @bytes_sent and @total_bytes count the whole upload request, including the video's
+	 * metadata. @bytes_per_second is measured over the last half a second or so, rather than averaged over the whole upload, so that it
+	 * reflects the bandwidth currently available.
+	 *
+	 * For synchronous uploads, the signal is emitted in the thread performing the upload. For asynchronous uploads, it's emitted in the
+	 * main context of the thread which started the upload, and updates may be coalesced; the last one is always emitted before the upload's
+	 * #GAsyncReadyCallback is called.
+	 *
+	 * Since: 0.4.0
+	 **/
+	service_signals[SIGNAL_UPLOAD_PROGRESS] = g_signal_new ("upload-progress",
+				G_TYPE_FROM_CLASS (klass),
+				G_SIGNAL_RUN_LAST,
+				0, NULL, NULL,
+				gdata_youtube_marshal_VOID__OBJECT_UINT64_UINT64_DOUBLE,
+				G_TYPE_NONE, 4, GDATA_TYPE_YOUTUBE_VIDEO, G_TYPE_UINT64, G_TYPE_UINT64, G_TYPE_DOUBLE);
 }
 
 static void
 gdata_youtube_service_init (GDataYouTubeService *self)
 {
 	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_YOUTUBE_SERVICE, GDataYouTubeServicePrivate);
+	self->priv->upload_chunk_size = DEFAULT_UPLOAD_CHUNK_SIZE;
 }
 
 static void
@@ -145,6 +200,9 @@ gdata_youtube_service_get_property (GObject *object, guint property_id, GValue *
 		case PROP_YOUTUBE_USER:
 			g_value_set_string (value, priv->youtube_user);
 			break;
+		case PROP_UPLOAD_CHUNK_SIZE:
+			g_value_set_uint (value, priv->upload_chunk_size);
+			break;
 		default:
 			/* We don't have any other property... */
 			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -161,6 +219,9 @@ gdata_youtube_service_set_property (GObject *object, guint property_id, const GV
 		case PROP_DEVELOPER_KEY:
 			priv->developer_key = g_value_dup_string (value);
 			break;
+		case PROP_UPLOAD_CHUNK_SIZE:
+			gdata_youtube_service_set_upload_chunk_size (GDATA_YOUTUBE_SERVICE (object), g_value_get_uint (value));
+			break;
 		default:
 			/* We don't have any other property... */
 			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -587,52 +648,370 @@ gdata_youtube_service_query_related_async (GDataYouTubeService *self, GDataYouTu
 				   GDATA_TYPE_YOUTUBE_VIDEO, cancellable, progress_callback, progress_user_data, callback, user_data);
 }
 
-/**
- * gdata_youtube_service_upload_video:
- * @self: a #GDataYouTubeService
- * @video: a #GDataYouTubeVideo to insert
- * @video_file: the video file to upload
- * @cancellable: optional #GCancellable object, or %NULL
- * @error: a #GError, or %NULL
- *
- * Uploads a video to YouTube, using the properties from @video and the video file pointed to by @video_file.
- *
- * If @video has already been inserted, a %GDATA_SERVICE_ERROR_ENTRY_ALREADY_INSERTED error will be returned. If no user is authenticated
- * with the service, %GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED will be returned.
- *
- * If there is a problem reading @video_file, an error from g_file_load_contents() or g_file_query_info() will be returned. Other errors from
- * #GDataServiceError can be returned for other exceptional conditions, as determined by the server.
- *
- * Return value: the inserted #GDataYouTubeVideo with updated properties from @video; unref with g_object_unref()
- **/
-GDataYouTubeVideo *
-gdata_youtube_service_upload_video (GDataYouTubeService *self, GDataYouTubeVideo *video, GFile *video_file,
-				    GCancellable *cancellable, GError **error)
+#define BOUNDARY_STRING "0xdeadbeef6e0808d5e6ed8bc168390bcc"
+#define UPLOAD_FOOTER "\n--" BOUNDARY_STRING "--"
+
+/* The size of the chunks in which video files are read and uploaded */
+#define UPLOAD_CHUNK_SIZE (64 * 1024)
+
+/* The shortest period, in seconds, over which an upload's throughput is measured */
+#define THROUGHPUT_WINDOW 0.5
+
+/* The progress of a video upload, reported by emitting GDataYouTubeService::upload-progress in the thread which started the upload. Asynchronous
+ * uploads are written from the I/O thread, so their latest progress is stored and emitted from an idle source in the starting thread's main
+ * context instead; updates which arrive while the source is pending are coalesced. */
+typedef struct {
+	volatile gint ref_count;
+	GDataYouTubeService *service;
+	GDataYouTubeVideo *video;
+	gboolean asynchronous;
+	GMainContext *context;
+
+	/* These are only accessed from the thread writing the message */
+	GTimer *timer;
+	gdouble window_start;
+	goffset window_bytes;
+
+	GStaticMutex mutex;
+	goffset bytes_sent;
+	goffset total_bytes;
+	gdouble bytes_per_second;
+	gboolean source_pending;
+} UploadProgress;
+
+static UploadProgress *
+upload_progress_new (GDataYouTubeService *service, GDataYouTubeVideo *video, goffset total_bytes, gboolean asynchronous)
 {
-	/* TODO: Async variant */
-	#define BOUNDARY_STRING "0xdeadbeef6e0808d5e6ed8bc168390bcc"
+	UploadProgress *self;
+
+	self = g_slice_new0 (UploadProgress);
+	self->ref_count = 1;
+	self->service = g_object_ref (service);
+	self->video = g_object_ref (video);
+	self->asynchronous = asynchronous;
+	self->timer = g_timer_new ();
+	g_static_mutex_init (&(self->mutex));
+	self->total_bytes = total_bytes;
+
+	if (asynchronous == TRUE) {
+		self->context = g_main_context_get_thread_default ();
+		if (self->context != NULL)
+			g_main_context_ref (self->context);
+	}
 
-	GDataServiceClass *klass;
-	SoupMessage *message;
-	gchar *entry_xml, *upload_uri, *second_chunk_header, *upload_data, *video_contents, *i;
-	const gchar *first_chunk_header, *footer;
-	guint status;
-	GFileInfo *video_file_info;
-	gsize content_length, first_chunk_header_length, second_chunk_header_length, entry_xml_length, video_length, footer_length;
+	return self;
+}
 
-	g_return_val_if_fail (GDATA_IS_YOUTUBE_SERVICE (self), NULL);
-	g_return_val_if_fail (GDATA_IS_YOUTUBE_VIDEO (video), NULL);
+static UploadProgress *
+upload_progress_ref (UploadProgress *self)
+{
+	g_atomic_int_inc (&(self->ref_count));
+	return self;
+}
 
-	if (gdata_entry_is_inserted (GDATA_ENTRY (video)) == TRUE) {
-		g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_ENTRY_ALREADY_INSERTED,
-				     _("The entry has already been inserted."));
-		return NULL;
+static void
+upload_progress_unref (UploadProgress *self)
+{
+	if (g_atomic_int_dec_and_test (&(self->ref_count)) == FALSE)
+		return;
+
+	g_object_unref (self->service);
+	g_object_unref (self->video);
+	if (self->context != NULL)
+		g_main_context_unref (self->context);
+	g_timer_destroy (self->timer);
+	g_static_mutex_free (&(self->mutex));
+
+	g_slice_free (UploadProgress, self);
+}
+
+static void
+upload_progress_emit (UploadProgress *self, goffset bytes_sent, goffset total_bytes, gdouble bytes_per_second)
+{
+	g_signal_emit (self->service, service_signals[SIGNAL_UPLOAD_PROGRESS], 0, self->video, (guint64) bytes_sent, (guint64) total_bytes,
+		       bytes_per_second);
+}
+
+static gboolean
+upload_progress_dispatch_cb (UploadProgress *self)
+{
+	goffset bytes_sent, total_bytes;
+	gdouble bytes_per_second;
+
+	g_static_mutex_lock (&(self->mutex));
+	bytes_sent = self->bytes_sent;
+	total_bytes = self->total_bytes;
+	bytes_per_second = self->bytes_per_second;
+	self->source_pending = FALSE;
+	g_static_mutex_unlock (&(self->mutex));
+
+	upload_progress_emit (self, bytes_sent, total_bytes, bytes_per_second);
+
+	return FALSE;
+}
+
+static void
+upload_progress_reset (UploadProgress *self)
+{
+	g_timer_start (self->timer);
+	self->window_start = 0.0;
+	self->window_bytes = 0;
+
+	g_static_mutex_lock (&(self->mutex));
+	self->bytes_sent = 0;
+	self->bytes_per_second = 0.0;
+	g_static_mutex_unlock (&(self->mutex));
+}
+
+static void
+upload_progress_update (UploadProgress *self, gsize length)
+{
+	goffset bytes_sent, total_bytes;
+	gdouble elapsed, bytes_per_second;
+
+	elapsed = g_timer_elapsed (self->timer, NULL);
+
+	g_static_mutex_lock (&(self->mutex));
+
+	self->bytes_sent += length;
+
+	/* Measure the throughput over the most recent window, so that it follows the bandwidth currently available, rather than averaging it
+	 * over the whole upload. Until the first window's over, the average is all there is. */
+	if (elapsed - self->window_start >= THROUGHPUT_WINDOW) {
+		self->bytes_per_second = (self->bytes_sent - self->window_bytes) / (elapsed - self->window_start);
+		self->window_start = elapsed;
+		self->window_bytes = self->bytes_sent;
+	} else if (self->window_start == 0.0 && elapsed > 0.0) {
+		self->bytes_per_second = self->bytes_sent / elapsed;
 	}
 
-	if (gdata_service_is_authenticated (GDATA_SERVICE (self)) == FALSE) {
-		g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED,
-				     _("You must be authenticated to upload a video."));
+	if (self->asynchronous == FALSE) {
+		bytes_sent = self->bytes_sent;
+		total_bytes = self->total_bytes;
+		bytes_per_second = self->bytes_per_second;
+		g_static_mutex_unlock (&(self->mutex));
+
+		upload_progress_emit (self, bytes_sent, total_bytes, bytes_per_second);
+		return;
+	}
+
+	if (self->source_pending == FALSE) {
+		GSource *source;
+
+		/* As with query progress callbacks, the source runs at a slightly higher priority than G_PRIORITY_DEFAULT, so that the last
+		 * update is emitted before the upload's GAsyncReadyCallback is called */
+		source = g_idle_source_new ();
+		g_source_set_priority (source, G_PRIORITY_DEFAULT - 1);
+		g_source_set_callback (source, (GSourceFunc) upload_progress_dispatch_cb, upload_progress_ref (self),
+				       (GDestroyNotify) upload_progress_unref);
+		g_source_attach (source, self->context);
+		g_source_unref (source);
+
+		self->source_pending = TRUE;
+	}
+
+	g_static_mutex_unlock (&(self->mutex));
+}
+
+/* The state of a video upload's multipart/related request body, which is streamed from the video file a chunk at a time as the previous
+ * chunk is written, so that only one chunk of the video is ever held in memory. Local files are mapped into memory instead, and the chunks
+ * point into the mapping, so that the video's data isn't copied at all. */
+typedef struct {
+	GDataService *service;
+	GCancellable *cancellable;
+	GInputStream *video_stream; /* NULL if the file's mapped */
+	SoupBuffer *video_buffer; /* NULL if the file's read from video_stream */
+	goffset video_length;
+	goffset video_offset;
+	UploadProgress *progress;
+
+	/* Consulted before each chunk of the video is appended, if set */
+	GDataYouTubeUploadThrottleFunc throttle_func;
+	gpointer throttle_data;
+
+	/* The entry part of the body, and the headers of the video part */
+	gchar *header;
+	gsize last_chunk_length;
+	gboolean finished;
+
+	GError *error;
+} UploadBody;
+
+static void
+upload_body_free (UploadBody *body)
+{
+	if (body->cancellable != NULL)
+		g_object_unref (body->cancellable);
+	if (body->video_stream != NULL)
+		g_object_unref (body->video_stream);
+	if (body->video_buffer != NULL)
+		soup_buffer_free (body->video_buffer);
+	if (body->progress != NULL)
+		upload_progress_unref (body->progress);
+	if (body->error != NULL)
+		g_error_free (body->error);
+	g_free (body->header);
+	g_slice_free (UploadBody, body);
+}
+
+static void
+upload_body_fail (UploadBody *body, SoupMessage *message, GError *error)
+{
+	/* Keep the first error, and stop the message from being sent any further */
+	if (body->error == NULL)
+		body->error = error;
+	else
+		g_error_free (error);
+
+	_gdata_service_cancel_message (body->service, message);
+}
+
+static void
+upload_body_append (UploadBody *body, SoupMessage *message, SoupMemoryUse use, gconstpointer data, gsize length)
+{
+	body->last_chunk_length = length;
+	soup_message_body_append (message->request_body, use, data, length);
+}
+
+static void
+upload_body_read_video_cb (SoupMessage *message, gchar *buffer, gssize length, GError *error, UploadBody *body)
+{
+	if (length <= 0) {
+		g_free (buffer);
+
+		/* The file's been truncated since its size was queried, so the Content-Length we sent is wrong */
+		if (length == 0) {
+			g_set_error_literal (&error, G_IO_ERROR, G_IO_ERROR_FAILED,
+					     _("The video file changed size while it was being uploaded."));
+		}
+
+		upload_body_fail (body, message, error);
+		return;
+	}
+
+	body->video_offset += length;
+	upload_body_append (body, message, SOUP_MEMORY_TAKE, buffer, length);
+}
+
+/* Append the next chunk of the video to the message's body */
+static void
+upload_body_append_video (SoupMessage *message, UploadBody *body)
+{
+	SoupBuffer *chunk;
+	gssize length;
+
+	/* If the file's mapped, the chunk just points into the mapping */
+	if (body->video_buffer != NULL) {
+		length = MIN (UPLOAD_CHUNK_SIZE, body->video_length - body->video_offset);
+		chunk = soup_buffer_new_subbuffer (body->video_buffer, body->video_offset, length);
+		body->video_offset += length;
+
+		body->last_chunk_length = length;
+		soup_message_body_append_buffer (message->request_body, chunk);
+		soup_buffer_free (chunk);
+
+		return;
+	}
+
+	/* If not, it's read into a new buffer, which is freed once it's been written; asynchronous uploads are paused while it's read, rather
+	 * than blocking the I/O thread */
+	length = MIN (UPLOAD_CHUNK_SIZE, body->video_length - body->video_offset);
+	_gdata_service_read_message_chunk (body->service, message, body->video_stream, length, body->cancellable,
+					   (GDataServiceMessageReadFunc) upload_body_read_video_cb, body);
+}
+
+static void
+upload_wrote_headers_cb (SoupMessage *message, UploadBody *body)
+{
+	GError *error = NULL;
+
+	/* The message may be being re-sent after a redirect, in which case the video has to be read again from the start */
+	if (body->video_offset != 0 && body->video_stream != NULL) {
+		if (g_seekable_seek (G_SEEKABLE (body->video_stream), 0, G_SEEK_SET, body->cancellable, &error) == FALSE) {
+			upload_body_fail (body, message, error);
+			return;
+		}
+	}
+
+	body->video_offset = 0;
+	upload_progress_reset (body->progress);
+	body->finished = FALSE;
+	soup_message_body_truncate (message->request_body);
+	upload_body_append (body, message, SOUP_MEMORY_COPY, body->header, strlen (body->header));
+}
+
+static void
+upload_wrote_chunk_cb (SoupMessage *message, UploadBody *body)
+{
+	SoupBuffer *chunk;
+
+	/* libsoup holds on to the chunks of a request body it's written, in case it has to re-send the message, so drop the chunk which has just
+	 * been written ourselves; upload_wrote_headers_cb() rebuilds the body if the message is re-sent. The body only ever holds the last chunk
+	 * appended, so it can be found from the body's total length. */
+	chunk = soup_message_body_get_chunk (message->request_body, message->request_body->length - body->last_chunk_length);
+	if (chunk != NULL) {
+		soup_message_body_wrote_chunk (message->request_body, chunk);
+		soup_buffer_free (chunk);
+	}
+
+	if (body->finished == TRUE)
+		return;
+
+	/* Append the footer once all the video's been written */
+	if (body->video_offset >= body->video_length) {
+		body->finished = TRUE;
+		upload_body_append (body, message, SOUP_MEMORY_STATIC, UPLOAD_FOOTER, strlen (UPLOAD_FOOTER));
+		return;
+	}
+
+	/* Otherwise, append the next chunk of the video, once the throttle allows */
+	if (body->throttle_func != NULL) {
+		guint delay = body->throttle_func (MIN (UPLOAD_CHUNK_SIZE, body->video_length - body->video_offset), body->throttle_data);
+
+		if (delay > 0) {
+			_gdata_service_delay_message (body->service, message, delay, (GDataServiceMessageResumeFunc) upload_body_append_video, body);
+			return;
+		}
+	}
+
+	upload_body_append_video (message, body);
+}
+
+static void
+upload_wrote_body_data_cb (SoupMessage *message, SoupBuffer *chunk, UploadBody *body)
+{
+	upload_progress_update (body->progress, chunk->length);
+}
+
+/* Build a message to upload @video_file as a new video with the metadata in @video. The video data is streamed from the file as the message
+ * is sent, so isn't loaded into memory here; the returned @body must be freed once the message has been sent. If @asynchronous is %TRUE, the
+ * message is going to be sent by an asynchronous operation. */
+static SoupMessage *
+build_upload_message (GDataYouTubeService *self, GDataYouTubeVideo *video, GFile *video_file, gboolean asynchronous, GCancellable *cancellable,
+		      UploadBody **body, GError **error)
+{
+	GDataServiceClass *klass;
+	SoupMessage *message;
+	UploadBody *upload_body;
+	GFileInfo *video_file_info;
+	GFileInputStream *video_stream = NULL;
+	SoupBuffer *video_buffer;
+	gchar *entry_xml, *upload_uri;
+	goffset content_length;
+
+	video_file_info = g_file_query_info (video_file, "standard::display-name,standard::content-type,standard::size", G_FILE_QUERY_INFO_NONE,
+					     cancellable, error);
+	if (video_file_info == NULL)
 		return NULL;
+
+	/* Map the file if possible, and read it otherwise */
+	video_buffer = _gdata_service_map_file (video_file);
+	if (video_buffer == NULL) {
+		video_stream = g_file_read (video_file, cancellable, error);
+		if (video_stream == NULL) {
+			g_object_unref (video_file_info);
+			return NULL;
+		}
 	}
 
 	upload_uri = g_strdup_printf ("http://uploads.gdata.youtube.com/feeds/api/users/%s/uploads", gdata_service_get_username (GDATA_SERVICE (self)));
@@ -644,104 +1023,840 @@ gdata_youtube_service_upload_video (GDataYouTubeService *self, GDataYouTubeVideo
 	if (klass->append_query_headers != NULL)
 		klass->append_query_headers (GDATA_SERVICE (self), message);
 
-	/* Get the data early so we can calculate the content length */
-	if (g_file_load_contents (video_file, NULL, &video_contents, &video_length, NULL, error) == FALSE) {
-		g_object_unref (message);
-		return NULL;
-	}
+	/* Add video-upload--specific headers */
+	soup_message_headers_append (message->request_headers, "Slug", g_file_info_get_display_name (video_file_info));
+
+	upload_body = g_slice_new0 (UploadBody);
+	upload_body->service = GDATA_SERVICE (self);
+	upload_body->cancellable = (cancellable != NULL) ? g_object_ref (cancellable) : NULL;
+	upload_body->video_stream = (video_stream != NULL) ? G_INPUT_STREAM (video_stream) : NULL;
+	upload_body->video_buffer = video_buffer;
+	upload_body->video_length = (video_buffer != NULL) ? (goffset) video_buffer->length : g_file_info_get_size (video_file_info);
 
 	entry_xml = gdata_entry_get_xml (GDATA_ENTRY (video));
+	upload_body->header = g_strdup_printf ("--" BOUNDARY_STRING "\nContent-Type: application/atom+xml; charset=UTF-8\n\n<?xml version='1.0'?>%s"
+					       "\n--" BOUNDARY_STRING "\nContent-Type: %s\nContent-Transfer-Encoding: binary\n\n",
+					       entry_xml, g_file_info_get_content_type (video_file_info));
+	g_free (entry_xml);
+	g_object_unref (video_file_info);
 
-	/* Check for cancellation */
-	if (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE) {
-		g_object_unref (message);
-		g_free (entry_xml);
-		return NULL;
-	}
+	/* The body's length is known in advance, so it can be streamed with a Content-Length, rather than chunked */
+	content_length = strlen (upload_body->header) + upload_body->video_length + strlen (UPLOAD_FOOTER);
+	soup_message_headers_set_content_type (message->request_headers, "multipart/related; boundary=" BOUNDARY_STRING, NULL);
+	soup_message_headers_set_content_length (message->request_headers, content_length);
+	upload_body->progress = upload_progress_new (self, video, content_length, asynchronous);
 
-	video_file_info = g_file_query_info (video_file, "standard::display-name,standard::content-type", G_FILE_QUERY_INFO_NONE, NULL, error);
-	if (video_file_info == NULL) {
-		g_object_unref (message);
-		g_free (entry_xml);
+	soup_message_body_set_accumulate (message->request_body, FALSE);
+	g_signal_connect (message, "wrote-headers", (GCallback) upload_wrote_headers_cb, upload_body);
+	g_signal_connect (message, "wrote-chunk", (GCallback) upload_wrote_chunk_cb, upload_body);
+	g_signal_connect (message, "wrote-body-data", (GCallback) upload_wrote_body_data_cb, upload_body);
+
+	*body = upload_body;
+	return message;
+}
+
+/* Process the response to a message built by build_upload_message(), returning the uploaded video */
+static GDataYouTubeVideo *
+process_upload_response (GDataYouTubeService *self, SoupMessage *message, UploadBody *body, GError **error)
+{
+	/* Return any error from reading the video file, which will have stopped the message */
+	if (body->error != NULL) {
+		g_propagate_error (error, body->error);
+		body->error = NULL;
 		return NULL;
 	}
 
-	/* Check for cancellation */
-	if (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE) {
-		g_object_unref (message);
-		g_free (entry_xml);
-		g_object_unref (video_file_info);
+	if (message->status_code != 201) {
+		/* Error */
+		parse_error_response (GDATA_SERVICE (self), GDATA_SERVICE_ERROR_WITH_INSERTION, message->status_code, message->reason_phrase,
+				      message->response_body->data, message->response_body->length, error);
 		return NULL;
 	}
 
-	/* Add video-upload--specific headers */
-	soup_message_headers_append (message->request_headers, "Slug", g_file_info_get_display_name (video_file_info));
-
-	first_chunk_header = "--" BOUNDARY_STRING "\nContent-Type: application/atom+xml; charset=UTF-8\n\n<?xml version='1.0'?>";
-	second_chunk_header = g_strdup_printf ("\n--" BOUNDARY_STRING "\nContent-Type: %s\nContent-Transfer-Encoding: binary\n\n",
-					       g_file_info_get_content_type (video_file_info));
-	footer = "\n--" BOUNDARY_STRING "--";
-
-	g_object_unref (video_file_info);
+	g_assert (message->response_body->data != NULL);
 
-	first_chunk_header_length = strlen (first_chunk_header);
-	second_chunk_header_length = strlen (second_chunk_header);
-	footer_length = strlen (footer);
-	entry_xml_length = strlen (entry_xml);
+	return gdata_youtube_video_new_from_xml (message->response_body->data, (gint) message->response_body->length, error);
+}
 
-	content_length = first_chunk_header_length + entry_xml_length + second_chunk_header_length + video_length + footer_length;
+static gboolean
+check_upload_video (GDataYouTubeService *self, GDataYouTubeVideo *video, GError **error)
+{
+	if (gdata_entry_is_inserted (GDATA_ENTRY (video)) == TRUE) {
+		g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_ENTRY_ALREADY_INSERTED,
+				     _("The entry has already been inserted."));
+		return FALSE;
+	}
 
-	/* Build the upload data */
-	upload_data = i = g_malloc (content_length);
+	if (gdata_service_is_authenticated (GDATA_SERVICE (self)) == FALSE) {
+		g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED,
+				     _("You must be authenticated to upload a video."));
+		return FALSE;
+	}
 
-	memcpy (upload_data, first_chunk_header, first_chunk_header_length);
-	i += first_chunk_header_length;
+	return TRUE;
+}
 
-	memcpy (i, entry_xml, entry_xml_length);
-	i += entry_xml_length;
-	g_free (entry_xml);
+/**
+ * gdata_youtube_service_upload_video:
+ * @self: a #GDataYouTubeService
+ * @video: a #GDataYouTubeVideo to insert
+ * @video_file: the video file to upload
+ * @cancellable: optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Uploads a video to YouTube, using the properties from @video and the video file pointed to by @video_file.
+ *
+ * The video file is read and uploaded a chunk at a time, so the amount of memory used doesn't depend on the size of the video. Local files
+ * are mapped into memory rather than read, so that the video's data isn't copied before it's sent; they mustn't be truncated during the
+ * upload. If @cancellable is cancelled while the video is being uploaded, the upload is stopped after the current chunk. The progress of the
+ * upload is reported by the #GDataYouTubeService::upload-progress signal.
+ *
+ * If @video has already been inserted, a %GDATA_SERVICE_ERROR_ENTRY_ALREADY_INSERTED error will be returned. If no user is authenticated
+ * with the service, %GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED will be returned.
+ *
+ * If there is a problem reading @video_file, an error from g_file_query_info(), g_file_read() or g_input_stream_read() will be returned.
+ * Other errors from #GDataServiceError can be returned for other exceptional conditions, as determined by the server.
+ *
+ * Return value: the inserted #GDataYouTubeVideo with updated properties from @video; unref with g_object_unref()
+ **/
+GDataYouTubeVideo *
+gdata_youtube_service_upload_video (GDataYouTubeService *self, GDataYouTubeVideo *video, GFile *video_file,
+				    GCancellable *cancellable, GError **error)
+{
+	GDataYouTubeVideo *uploaded_video;
+	SoupMessage *message;
+	UploadBody *body;
+	guint status;
 
-	memcpy (i, second_chunk_header, second_chunk_header_length);
-	g_free (second_chunk_header);
-	i += second_chunk_header_length;
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_SERVICE (self), NULL);
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_VIDEO (video), NULL);
 
-	memcpy (i, video_contents, video_length);
-	g_free (video_contents);
-	i += video_length;
+	if (check_upload_video (self, video, error) == FALSE)
+		return NULL;
 
-	memcpy (i, footer, footer_length);
+	message = build_upload_message (self, video, video_file, FALSE, cancellable, &body, error);
+	if (message == NULL)
+		return NULL;
 
-	/* Append the data */
-	soup_message_set_request (message, "multipart/related; boundary=" BOUNDARY_STRING, SOUP_MEMORY_TAKE, upload_data, content_length);
+	/* Check for cancellation */
+	if (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE) {
+		g_object_unref (message);
+		upload_body_free (body);
+		return NULL;
+	}
 
 	/* Send the message */
 	status = _gdata_service_send_message (GDATA_SERVICE (self), message, error);
 	if (status == SOUP_STATUS_NONE) {
 		g_object_unref (message);
+		upload_body_free (body);
 		return NULL;
 	}
 
 	/* Check for cancellation */
 	if (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE) {
 		g_object_unref (message);
+		upload_body_free (body);
 		return NULL;
 	}
 
-	if (status != 201) {
-		/* Error */
-		parse_error_response (GDATA_SERVICE (self), GDATA_SERVICE_ERROR_WITH_INSERTION, status, message->reason_phrase,
-				      message->response_body->data, message->response_body->length, error);
-		g_object_unref (message);
-		return NULL;
+	uploaded_video = process_upload_response (self, message, body, error);
+	g_object_unref (message);
+	upload_body_free (body);
+
+	return uploaded_video;
+}
+
+static gboolean
+upload_video_complete_cb (GDataService *service, SoupMessage *message, GSimpleAsyncResult *result, GCancellable *cancellable)
+{
+	GDataYouTubeVideo *uploaded_video;
+	GError *error = NULL;
+	UploadBody *body = g_simple_async_result_get_op_res_gpointer (result);
+
+	uploaded_video = process_upload_response (GDATA_YOUTUBE_SERVICE (service), message, body, &error);
+	if (uploaded_video == NULL) {
+		g_simple_async_result_set_from_error (result, error);
+		g_error_free (error);
+		return TRUE;
 	}
 
-	g_assert (message->response_body->data != NULL);
+	/* Swap the upload body for the uploaded video */
+	g_simple_async_result_set_op_res_gpointer (result, uploaded_video, (GDestroyNotify) g_object_unref);
 
-	return gdata_youtube_video_new_from_xml (message->response_body->data, (gint) message->response_body->length, error);
+	return TRUE;
 }
 
 /**
- * gdata_youtube_service_get_developer_key:
+ * gdata_youtube_service_upload_video_async:
+ * @self: a #GDataYouTubeService
+ * @video: a #GDataYouTubeVideo to insert
+ * @video_file: the video file to upload
+ * @cancellable: optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the upload is finished
+ * @user_data: data to pass to the @callback function
+ *
+ * Uploads a video to YouTube, using the properties from @video and the video file pointed to by @video_file. @self and @video are both reffed
+ * when this function is called, and @video_file is opened by it, so they can all safely be unreffed after this function returns.
+ *
+ * The #GDataYouTubeService::upload-progress signal is emitted in the main context of the thread which called this function, before @callback
+ * is called. Files which can't be mapped into memory are read asynchronously, a chunk at a time, so reading them doesn't hold up other
+ * asynchronous operations.
+ *
+ * For more details, see gdata_youtube_service_upload_video(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_youtube_service_upload_video_finish()
+ * to get the results of the operation.
+ *
+ * Since: 0.4.0
+ **/
+void
+gdata_youtube_service_upload_video_async (GDataYouTubeService *self, GDataYouTubeVideo *video, GFile *video_file, GCancellable *cancellable,
+					  GAsyncReadyCallback callback, gpointer user_data)
+{
+	g_return_if_fail (GDATA_IS_YOUTUBE_SERVICE (self));
+	g_return_if_fail (GDATA_IS_YOUTUBE_VIDEO (video));
+	g_return_if_fail (G_IS_FILE (video_file));
+
+	_gdata_youtube_service_upload_video_async (self, video, video_file, NULL, NULL, cancellable, callback, user_data);
+}
+
+/* As gdata_youtube_service_upload_video_async(), but if @throttle_func is non-%NULL, it's called from the I/O thread before each chunk of the
+ * video is sent, and the chunk is held back for the number of milliseconds it returns. The result is finished with
+ * gdata_youtube_service_upload_video_finish(). */
+void
+_gdata_youtube_service_upload_video_async (GDataYouTubeService *self, GDataYouTubeVideo *video, GFile *video_file,
+					   GDataYouTubeUploadThrottleFunc throttle_func, gpointer throttle_data, GCancellable *cancellable,
+					   GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	SoupMessage *message;
+	UploadBody *body;
+	GError *error = NULL;
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_youtube_service_upload_video_async);
+
+	if (check_upload_video (self, video, &error) == FALSE ||
+	    (message = build_upload_message (self, video, video_file, TRUE, cancellable, &body, &error)) == NULL) {
+		g_simple_async_result_set_from_error (result, error);
+		g_simple_async_result_complete_in_idle (result);
+		g_error_free (error);
+		g_object_unref (result);
+		return;
+	}
+
+	body->throttle_func = throttle_func;
+	body->throttle_data = throttle_data;
+
+	g_simple_async_result_set_op_res_gpointer (result, body, (GDestroyNotify) upload_body_free);
+	_gdata_service_queue_message (GDATA_SERVICE (self), message, result, cancellable, upload_video_complete_cb);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_youtube_service_upload_video_finish:
+ * @self: a #GDataYouTubeService
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous video upload operation started with gdata_youtube_service_upload_video_async().
+ *
+ * Return value: the inserted #GDataYouTubeVideo with updated properties from the original video, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.4.0
+ **/
+GDataYouTubeVideo *
+gdata_youtube_service_upload_video_finish (GDataYouTubeService *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+	GDataYouTubeVideo *video;
+
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_SERVICE (self), NULL);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), NULL);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_youtube_service_upload_video_async);
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return NULL;
+
+	video = g_simple_async_result_get_op_res_gpointer (result);
+	if (video != NULL)
+		return g_object_ref (video);
+
+	g_assert_not_reached ();
+}
+
+/* The number of requests in a row a resumable upload may fail without the server committing any more of it, before it's abandoned */
+#define MAX_RESUME_ATTEMPTS 5
+
+/* The time (in milliseconds) to wait before retrying a failed request of a resumable upload; it's doubled for each further failure in a row */
+#define RESUME_BACKOFF_DELAY 500
+
+/* The details of the video file being sent in a resumable upload */
+typedef struct {
+	GDataYouTubeService *service;
+	const gchar *upload_uri;
+	GInputStream *video_stream;
+	gchar *content_type;
+	goffset video_length;
+} ResumableUpload;
+
+static gboolean
+resumable_upload_init (ResumableUpload *upload, GDataYouTubeService *self, const gchar *upload_uri, GFile *video_file, gboolean open_stream,
+		       GCancellable *cancellable, GError **error)
+{
+	GFileInfo *video_file_info;
+
+	upload->service = self;
+	upload->upload_uri = upload_uri;
+	upload->video_stream = NULL;
+
+	video_file_info = g_file_query_info (video_file, "standard::content-type,standard::size", G_FILE_QUERY_INFO_NONE, cancellable, error);
+	if (video_file_info == NULL)
+		return FALSE;
+
+	/* Fall back to a generic content type if GIO can't determine one, since every chunk has to be sent with one */
+	upload->content_type = g_strdup (g_file_info_get_content_type (video_file_info));
+	if (upload->content_type == NULL)
+		upload->content_type = g_strdup ("application/octet-stream");
+	upload->video_length = g_file_info_get_size (video_file_info);
+	g_object_unref (video_file_info);
+
+	if (open_stream == TRUE) {
+		upload->video_stream = G_INPUT_STREAM (g_file_read (video_file, cancellable, error));
+		if (upload->video_stream == NULL) {
+			g_free (upload->content_type);
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+static void
+resumable_upload_clear (ResumableUpload *upload)
+{
+	if (upload->video_stream != NULL)
+		g_object_unref (upload->video_stream);
+	g_free (upload->content_type);
+}
+
+typedef struct {
+	GMutex *mutex;
+	GCond *cond;
+	gboolean cancelled;
+} ResumeBackoff;
+
+static void
+resume_backoff_cancelled_cb (GCancellable *cancellable, ResumeBackoff *backoff)
+{
+	g_mutex_lock (backoff->mutex);
+	backoff->cancelled = TRUE;
+	g_cond_signal (backoff->cond);
+	g_mutex_unlock (backoff->mutex);
+}
+
+/* Wait before retrying after @n_failures failed requests in a row, backing off exponentially so that a struggling server isn't hammered.
+ * The wait is cut short if @cancellable is cancelled, in which case %FALSE is returned and @error is set. */
+static gboolean
+resume_backoff_wait (guint n_failures, GCancellable *cancellable, GError **error)
+{
+	ResumeBackoff backoff;
+	GTimeVal end_time;
+	gulong handler_id = 0;
+
+	g_assert (n_failures > 0 && n_failures < MAX_RESUME_ATTEMPTS);
+
+	backoff.mutex = g_mutex_new ();
+	backoff.cond = g_cond_new ();
+	backoff.cancelled = FALSE;
+
+	g_get_current_time (&end_time);
+	g_time_val_add (&end_time, (glong) (RESUME_BACKOFF_DELAY << (n_failures - 1)) * 1000);
+
+	/* If the cancellable's already been cancelled, the callback's called straight away */
+	if (cancellable != NULL)
+		handler_id = g_cancellable_connect (cancellable, G_CALLBACK (resume_backoff_cancelled_cb), &backoff, NULL);
+
+	g_mutex_lock (backoff.mutex);
+	while (backoff.cancelled == FALSE && g_cond_timed_wait (backoff.cond, backoff.mutex, &end_time) == TRUE);
+	g_mutex_unlock (backoff.mutex);
+
+	if (cancellable != NULL)
+		g_cancellable_disconnect (cancellable, handler_id);
+
+	g_cond_free (backoff.cond);
+	g_mutex_free (backoff.mutex);
+
+	return (g_cancellable_set_error_if_cancelled (cancellable, error) == FALSE);
+}
+
+/* Get the number of bytes the server has committed from the Range header of a "308 Resume Incomplete" response */
+static goffset
+get_committed_offset (SoupMessage *message)
+{
+	const gchar *range;
+	gchar *end;
+	guint64 last_byte;
+
+	/* If there's no Range header, nothing's been committed yet */
+	range = soup_message_headers_get_one (message->response_headers, "Range");
+	if (range == NULL || g_str_has_prefix (range, "bytes=0-") == FALSE)
+		return 0;
+
+	/* If the header's malformed, play it safe and start again from the beginning */
+	last_byte = g_ascii_strtoull (range + strlen ("bytes=0-"), &end, 10);
+	if (end == range + strlen ("bytes=0-") || *end != '\0')
+		return 0;
+
+	return (goffset) last_byte + 1;
+}
+
+/* Send a request of a resumable upload, and process the response, which either gives the number of bytes the server's committed so far, or is
+ * the uploaded video if the upload's complete. @status is set to the response's status, so that failed requests can be retried. */
+static gboolean
+resumable_upload_send (ResumableUpload *upload, SoupMessage *message, goffset *committed_offset, GDataYouTubeVideo **uploaded_video,
+		       guint *status, GCancellable *cancellable, GError **error)
+{
+	GDataServiceClass *klass;
+	GDataYouTubeVideo *video;
+
+	*status = SOUP_STATUS_NONE;
+
+	/* Make sure subclasses set their headers */
+	klass = GDATA_SERVICE_GET_CLASS (upload->service);
+	if (klass->append_query_headers != NULL)
+		klass->append_query_headers (GDATA_SERVICE (upload->service), message);
+
+	/* Check for cancellation */
+	if (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE)
+		return FALSE;
+
+	/* "308 Resume Incomplete" isn't a redirect, so make sure it isn't followed */
+	soup_message_set_flags (message, SOUP_MESSAGE_NO_REDIRECT);
+
+	/* Send the message */
+	*status = _gdata_service_send_message (GDATA_SERVICE (upload->service), message, error);
+	if (*status == SOUP_STATUS_NONE)
+		return FALSE;
+
+	/* Check for cancellation */
+	if (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE)
+		return FALSE;
+
+	switch (*status) {
+		case 308:
+			*committed_offset = get_committed_offset (message);
+			*uploaded_video = NULL;
+			return TRUE;
+		case 200:
+		case 201:
+			g_assert (message->response_body->data != NULL);
+
+			video = gdata_youtube_video_new_from_xml (message->response_body->data, (gint) message->response_body->length, error);
+			if (video == NULL)
+				return FALSE;
+
+			*committed_offset = upload->video_length;
+			*uploaded_video = video;
+			return TRUE;
+		default:
+			/* Error */
+			parse_error_response (GDATA_SERVICE (upload->service), GDATA_SERVICE_ERROR_WITH_INSERTION, *status, message->reason_phrase,
+					      message->response_body->data, message->response_body->length, error);
+			return FALSE;
+	}
+}
+
+static gboolean
+resumable_upload_query (ResumableUpload *upload, goffset *committed_offset, GDataYouTubeVideo **uploaded_video, guint *status,
+			GCancellable *cancellable, GError **error)
+{
+	SoupMessage *message;
+	gchar *content_range;
+	gboolean success;
+
+	/* An empty request with an unknown range asks the server how much it's committed */
+	message = soup_message_new (SOUP_METHOD_PUT, upload->upload_uri);
+	content_range = g_strdup_printf ("bytes */%" G_GOFFSET_FORMAT, upload->video_length);
+	soup_message_headers_append (message->request_headers, "Content-Range", content_range);
+	soup_message_headers_set_content_length (message->request_headers, 0);
+	g_free (content_range);
+
+	success = resumable_upload_send (upload, message, committed_offset, uploaded_video, status, cancellable, error);
+	g_object_unref (message);
+
+	return success;
+}
+
+static gboolean
+resumable_upload_send_chunk (ResumableUpload *upload, goffset offset, goffset *committed_offset, GDataYouTubeVideo **uploaded_video,
+			     guint *status, GCancellable *cancellable, GError **error)
+{
+	SoupMessage *message;
+	gchar *buffer, *content_range;
+	gsize length;
+	gboolean success;
+
+	/* libsoup drops a request body with no content type, so make sure there is one before reading the chunk into memory */
+	g_return_val_if_fail (upload->content_type != NULL, FALSE);
+
+	*status = SOUP_STATUS_NONE;
+
+	/* If everything's been sent, there's nothing left but to find out whether the server has all of it */
+	if (offset >= upload->video_length)
+		return resumable_upload_query (upload, committed_offset, uploaded_video, status, cancellable, error);
+
+	/* Read the chunk; only one chunk's ever held in memory */
+	if (g_seekable_seek (G_SEEKABLE (upload->video_stream), offset, G_SEEK_SET, cancellable, error) == FALSE)
+		return FALSE;
+
+	length = MIN (upload->service->priv->upload_chunk_size, upload->video_length - offset);
+	buffer = g_malloc (length);
+
+	if (g_input_stream_read_all (upload->video_stream, buffer, length, &length, cancellable, error) == FALSE) {
+		g_free (buffer);
+		return FALSE;
+	} else if (length == 0) {
+		/* The file's been truncated since its size was queried */
+		g_free (buffer);
+		g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_FAILED, _("The video file changed size while it was being uploaded."));
+		return FALSE;
+	}
+
+	message = soup_message_new (SOUP_METHOD_PUT, upload->upload_uri);
+	content_range = g_strdup_printf ("bytes %" G_GOFFSET_FORMAT "-%" G_GOFFSET_FORMAT "/%" G_GOFFSET_FORMAT,
+					 offset, offset + (goffset) length - 1, upload->video_length);
+	soup_message_headers_append (message->request_headers, "Content-Range", content_range);
+	soup_message_set_request (message, upload->content_type, SOUP_MEMORY_TAKE, buffer, length);
+	g_free (content_range);
+
+	success = resumable_upload_send (upload, message, committed_offset, uploaded_video, status, cancellable, error);
+	g_object_unref (message);
+
+	return success;
+}
+
+/**
+ * gdata_youtube_service_start_resumable_upload:
+ * @self: a #GDataYouTubeService
+ * @video: a #GDataYouTubeVideo to insert
+ * @video_file: the video file to upload
+ * @cancellable: optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Starts a resumable upload of the video file pointed to by @video_file, using the properties from @video. This sends the video's metadata,
+ * and returns the URI of the upload session, to which the video data itself can then be sent in chunks using
+ * gdata_youtube_service_upload_chunk() or gdata_youtube_service_resume_upload().
+ *
+ * The upload URI identifies the upload on the server, so it can be saved and used to carry on with the upload after the connection has dropped,
+ * or from another process entirely, with a new #GDataYouTubeService.
+ *
+ * If @video has already been inserted, a %GDATA_SERVICE_ERROR_ENTRY_ALREADY_INSERTED error will be returned. If no user is authenticated
+ * with the service, %GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED will be returned.
+ *
+ * If there is a problem reading @video_file, an error from g_file_query_info() will be returned. Other errors from #GDataServiceError can be
+ * returned for other exceptional conditions, as determined by the server.
+ *
+ * Return value: the upload URI, or %NULL; free with g_free()
+ *
+ * Since: 0.4.0
+ **/
+gchar *
+gdata_youtube_service_start_resumable_upload (GDataYouTubeService *self, GDataYouTubeVideo *video, GFile *video_file,
+					      GCancellable *cancellable, GError **error)
+{
+	GDataServiceClass *klass;
+	SoupMessage *message;
+	GFileInfo *video_file_info;
+	gchar *upload_uri, *entry_xml, *body;
+	const gchar *location;
+	guint status;
+
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_SERVICE (self), NULL);
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_VIDEO (video), NULL);
+	g_return_val_if_fail (G_IS_FILE (video_file), NULL);
+
+	if (gdata_entry_is_inserted (GDATA_ENTRY (video)) == TRUE) {
+		g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_ENTRY_ALREADY_INSERTED,
+				     _("The entry has already been inserted."));
+		return NULL;
+	}
+
+	if (gdata_service_is_authenticated (GDATA_SERVICE (self)) == FALSE) {
+		g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED,
+				     _("You must be authenticated to upload a video."));
+		return NULL;
+	}
+
+	video_file_info = g_file_query_info (video_file, "standard::display-name", G_FILE_QUERY_INFO_NONE, cancellable, error);
+	if (video_file_info == NULL)
+		return NULL;
+
+	upload_uri = g_strdup_printf ("http://uploads.gdata.youtube.com/resumable/feeds/api/users/%s/uploads",
+				      gdata_service_get_username (GDATA_SERVICE (self)));
+	message = soup_message_new (SOUP_METHOD_POST, upload_uri);
+	g_free (upload_uri);
+
+	/* Make sure subclasses set their headers */
+	klass = GDATA_SERVICE_GET_CLASS (self);
+	if (klass->append_query_headers != NULL)
+		klass->append_query_headers (GDATA_SERVICE (self), message);
+
+	/* Add video-upload--specific headers */
+	soup_message_headers_append (message->request_headers, "Slug", g_file_info_get_display_name (video_file_info));
+	g_object_unref (video_file_info);
+
+	/* Only the metadata's sent to start the upload */
+	entry_xml = gdata_entry_get_xml (GDATA_ENTRY (video));
+	body = g_strconcat ("<?xml version='1.0'?>", entry_xml, NULL);
+	g_free (entry_xml);
+	soup_message_set_request (message, "application/atom+xml; charset=UTF-8", SOUP_MEMORY_TAKE, body, strlen (body));
+
+	/* Check for cancellation */
+	if (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE) {
+		g_object_unref (message);
+		return NULL;
+	}
+
+	/* Send the message */
+	status = _gdata_service_send_message (GDATA_SERVICE (self), message, error);
+	if (status == SOUP_STATUS_NONE) {
+		g_object_unref (message);
+		return NULL;
+	}
+
+	/* Check for cancellation */
+	if (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE) {
+		g_object_unref (message);
+		return NULL;
+	}
+
+	if (status != 200) {
+		/* Error */
+		parse_error_response (GDATA_SERVICE (self), GDATA_SERVICE_ERROR_WITH_INSERTION, status, message->reason_phrase,
+				      message->response_body->data, message->response_body->length, error);
+		g_object_unref (message);
+		return NULL;
+	}
+
+	/* The upload URI is given in the Location header */
+	location = soup_message_headers_get_one (message->response_headers, "Location");
+	if (location == NULL || *location == '\0') {
+		g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+				     _("The server returned a malformed response."));
+		g_object_unref (message);
+		return NULL;
+	}
+
+	upload_uri = g_strdup (location);
+	g_object_unref (message);
+
+	return upload_uri;
+}
+
+/**
+ * gdata_youtube_service_query_resumable_upload:
+ * @self: a #GDataYouTubeService
+ * @upload_uri: the upload URI returned by gdata_youtube_service_start_resumable_upload()
+ * @video_file: the video file being uploaded
+ * @cancellable: optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Asks the server how many bytes of @video_file it has committed in the resumable upload identified by @upload_uri. The upload can then be
+ * carried on from that offset using gdata_youtube_service_upload_chunk().
+ *
+ * If the upload is already complete, the size of @video_file is returned.
+ *
+ * If there is a problem reading @video_file, an error from g_file_query_info() will be returned. Errors from #GDataServiceError can be
+ * returned for other exceptional conditions, as determined by the server.
+ *
+ * Return value: the number of bytes the server has committed, or %-1 on error
+ *
+ * Since: 0.4.0
+ **/
+goffset
+gdata_youtube_service_query_resumable_upload (GDataYouTubeService *self, const gchar *upload_uri, GFile *video_file,
+					      GCancellable *cancellable, GError **error)
+{
+	ResumableUpload upload;
+	GDataYouTubeVideo *uploaded_video = NULL;
+	goffset committed_offset = -1;
+	guint status;
+
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_SERVICE (self), -1);
+	g_return_val_if_fail (upload_uri != NULL, -1);
+	g_return_val_if_fail (G_IS_FILE (video_file), -1);
+
+	if (resumable_upload_init (&upload, self, upload_uri, video_file, FALSE, cancellable, error) == FALSE)
+		return -1;
+
+	if (resumable_upload_query (&upload, &committed_offset, &uploaded_video, &status, cancellable, error) == FALSE)
+		committed_offset = -1;
+
+	if (uploaded_video != NULL)
+		g_object_unref (uploaded_video);
+	resumable_upload_clear (&upload);
+
+	return committed_offset;
+}
+
+/**
+ * gdata_youtube_service_upload_chunk:
+ * @self: a #GDataYouTubeService
+ * @upload_uri: the upload URI returned by gdata_youtube_service_start_resumable_upload()
+ * @video_file: the video file being uploaded
+ * @offset: the offset into @video_file of the chunk to send
+ * @committed_offset: return location for the number of bytes the server has committed, or %NULL
+ * @uploaded_video: return location for the uploaded #GDataYouTubeVideo, or %NULL
+ * @cancellable: optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Sends the chunk of @video_file starting at @offset to the resumable upload identified by @upload_uri. The chunk is at most
+ * #GDataYouTubeService:upload-chunk-size bytes long, and is the only part of the file held in memory.
+ *
+ * On success, @committed_offset is set to the number of bytes of the file the server has committed, which is where the next chunk should
+ * start; it may be less than the end of the chunk just sent. Once the server has the whole file, @uploaded_video is set to the inserted
+ * #GDataYouTubeVideo, with updated properties from the video passed to gdata_youtube_service_start_resumable_upload(). Until then, it's set
+ * to %NULL.
+ *
+ * If the chunk can't be sent (for example, because the connection dropped), %FALSE is returned, and the upload can be carried on from the
+ * offset returned by gdata_youtube_service_query_resumable_upload().
+ *
+ * If there is a problem reading @video_file, an error from g_file_query_info(), g_file_read() or g_input_stream_read() will be returned.
+ * Errors from #GDataServiceError can be returned for other exceptional conditions, as determined by the server.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.4.0
+ **/
+gboolean
+gdata_youtube_service_upload_chunk (GDataYouTubeService *self, const gchar *upload_uri, GFile *video_file, goffset offset,
+				    goffset *committed_offset, GDataYouTubeVideo **uploaded_video, GCancellable *cancellable, GError **error)
+{
+	ResumableUpload upload;
+	GDataYouTubeVideo *video = NULL;
+	goffset new_offset;
+	guint status;
+	gboolean success;
+
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_SERVICE (self), FALSE);
+	g_return_val_if_fail (upload_uri != NULL, FALSE);
+	g_return_val_if_fail (G_IS_FILE (video_file), FALSE);
+	g_return_val_if_fail (offset >= 0, FALSE);
+
+	if (resumable_upload_init (&upload, self, upload_uri, video_file, TRUE, cancellable, error) == FALSE)
+		return FALSE;
+
+	success = resumable_upload_send_chunk (&upload, offset, &new_offset, &video, &status, cancellable, error);
+	resumable_upload_clear (&upload);
+
+	if (success == FALSE)
+		return FALSE;
+
+	if (committed_offset != NULL)
+		*committed_offset = new_offset;
+
+	if (uploaded_video != NULL)
+		*uploaded_video = video;
+	else if (video != NULL)
+		g_object_unref (video);
+
+	return TRUE;
+}
+
+/**
+ * gdata_youtube_service_resume_upload:
+ * @self: a #GDataYouTubeService
+ * @upload_uri: the upload URI returned by gdata_youtube_service_start_resumable_upload()
+ * @video_file: the video file being uploaded
+ * @cancellable: optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Carries on the resumable upload identified by @upload_uri until the server has all of @video_file. The offset to carry on from is queried
+ * from the server first, so this can be used to finish an upload started by gdata_youtube_service_start_resumable_upload() from scratch, or
+ * to resume one which was interrupted, even in another process.
+ *
+ * The file is sent in chunks of #GDataYouTubeService:upload-chunk-size bytes. If a chunk can't be sent because the connection dropped or
+ * because of a server error, the upload is carried on from whatever the server has committed by then. It's only abandoned if several
+ * requests in a row fail without the server committing any more of the file, in which case the error from the last of them is returned.
+ * The upload can still be resumed later. The wait before each retry is doubled for every further failure in a row, starting at half a second,
+ * and is cut short if the operation is cancelled.
+ *
+ * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
+ * If the operation was cancelled, the error %G_IO_ERROR_CANCELLED will be returned, and the upload can be resumed later.
+ *
+ * If there is a problem reading @video_file, an error from g_file_query_info(), g_file_read() or g_input_stream_read() will be returned.
+ * Other errors from #GDataServiceError can be returned for other exceptional conditions, as determined by the server.
+ *
+ * Return value: the inserted #GDataYouTubeVideo, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.4.0
+ **/
+GDataYouTubeVideo *
+gdata_youtube_service_resume_upload (GDataYouTubeService *self, const gchar *upload_uri, GFile *video_file, GCancellable *cancellable,
+				     GError **error)
+{
+	ResumableUpload upload;
+	GDataYouTubeVideo *uploaded_video = NULL;
+	goffset offset = -1, committed_offset, best_offset = -1;
+	guint status, n_failures = 0;
+	gboolean success;
+	GError *child_error = NULL;
+
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_SERVICE (self), NULL);
+	g_return_val_if_fail (upload_uri != NULL, NULL);
+	g_return_val_if_fail (G_IS_FILE (video_file), NULL);
+
+	if (resumable_upload_init (&upload, self, upload_uri, video_file, TRUE, cancellable, error) == FALSE)
+		return NULL;
+
+	while (uploaded_video == NULL) {
+		/* Ask the server where to carry on from, unless the last chunk's response told us */
+		if (offset < 0)
+			success = resumable_upload_query (&upload, &committed_offset, &uploaded_video, &status, cancellable, &child_error);
+		else
+			success = resumable_upload_send_chunk (&upload, offset, &committed_offset, &uploaded_video, &status, cancellable, &child_error);
+
+		if (success == TRUE) {
+			if (committed_offset > best_offset) {
+				best_offset = committed_offset;
+				n_failures = 0;
+			} else if (offset >= 0 && ++n_failures >= MAX_RESUME_ATTEMPTS) {
+				/* The server keeps accepting chunks without committing any of them */
+				g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+						     _("The server returned a malformed response."));
+				break;
+			}
+
+			offset = committed_offset;
+			continue;
+		}
+
+		/* Retry dropped connections and server errors from whatever the server's committed, as long as it's still making progress */
+		if ((SOUP_STATUS_IS_TRANSPORT_ERROR (status) || SOUP_STATUS_IS_SERVER_ERROR (status)) &&
+		    g_cancellable_is_cancelled (cancellable) == FALSE && ++n_failures < MAX_RESUME_ATTEMPTS) {
+			g_clear_error (&child_error);
+
+			/* Give the server a chance to recover before trying again */
+			if (resume_backoff_wait (n_failures, cancellable, error) == FALSE)
+				break;
+
+			offset = -1;
+			continue;
+		}
+
+		g_propagate_error (error, child_error);
+		break;
+	}
+
+	resumable_upload_clear (&upload);
+
+	return uploaded_video;
+}
+
+/**
+ * gdata_youtube_service_get_developer_key:
  * @self: a #GDataYouTubeService
  *
  * Gets the #GDataYouTubeService:developer-key property from the #GDataYouTubeService.
@@ -769,3 +1884,39 @@ gdata_youtube_service_get_youtube_user (GDataYouTubeService *self)
 	g_return_val_if_fail (GDATA_IS_YOUTUBE_SERVICE (self), NULL);
 	return self->priv->youtube_user;
 }
+
+/**
+ * gdata_youtube_service_get_upload_chunk_size:
+ * @self: a #GDataYouTubeService
+ *
+ * Gets the #GDataYouTubeService:upload-chunk-size property.
+ *
+ * Return value: the maximum number of bytes sent in each request of a resumable upload
+ *
+ * Since: 0.4.0
+ **/
+guint
+gdata_youtube_service_get_upload_chunk_size (GDataYouTubeService *self)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_SERVICE (self), 0);
+	return self->priv->upload_chunk_size;
+}
+
+/**
+ * gdata_youtube_service_set_upload_chunk_size:
+ * @self: a #GDataYouTubeService
+ * @chunk_size: the maximum number of bytes to send in each request of a resumable upload
+ *
+ * Sets the #GDataYouTubeService:upload-chunk-size property to @chunk_size, which must be greater than %0.
+ *
+ * Since: 0.4.0
+ **/
+void
+gdata_youtube_service_set_upload_chunk_size (GDataYouTubeService *self, guint chunk_size)
+{
+	g_return_if_fail (GDATA_IS_YOUTUBE_SERVICE (self));
+	g_return_if_fail (chunk_size > 0);
+
+	self->priv->upload_chunk_size = chunk_size;
+	g_object_notify (G_OBJECT (self), "upload-chunk-size");
+}
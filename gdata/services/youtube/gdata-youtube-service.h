@@ -132,9 +132,24 @@ void gdata_youtube_service_query_related_async (GDataYouTubeService *self, GData
 
 GDataYouTubeVideo *gdata_youtube_service_upload_video (GDataYouTubeService *self, GDataYouTubeVideo *video, GFile *video_file,
 						       GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT;
+void gdata_youtube_service_upload_video_async (GDataYouTubeService *self, GDataYouTubeVideo *video, GFile *video_file,
+					       GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+GDataYouTubeVideo *gdata_youtube_service_upload_video_finish (GDataYouTubeService *self, GAsyncResult *async_result,
+							      GError **error) G_GNUC_WARN_UNUSED_RESULT;
+
+gchar *gdata_youtube_service_start_resumable_upload (GDataYouTubeService *self, GDataYouTubeVideo *video, GFile *video_file,
+						     GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT;
+goffset gdata_youtube_service_query_resumable_upload (GDataYouTubeService *self, const gchar *upload_uri, GFile *video_file,
+						      GCancellable *cancellable, GError **error);
+gboolean gdata_youtube_service_upload_chunk (GDataYouTubeService *self, const gchar *upload_uri, GFile *video_file, goffset offset,
+					     goffset *committed_offset, GDataYouTubeVideo **uploaded_video, GCancellable *cancellable, GError **error);
+GDataYouTubeVideo *gdata_youtube_service_resume_upload (GDataYouTubeService *self, const gchar *upload_uri, GFile *video_file,
+							GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT;
 
 const gchar *gdata_youtube_service_get_developer_key (GDataYouTubeService *self);
 const gchar *gdata_youtube_service_get_youtube_user (GDataYouTubeService *self);
+guint gdata_youtube_service_get_upload_chunk_size (GDataYouTubeService *self);
+void gdata_youtube_service_set_upload_chunk_size (GDataYouTubeService *self, guint chunk_size);
 
 G_END_DECLS
 
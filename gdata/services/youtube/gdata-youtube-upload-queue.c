@@ -0,0 +1,591 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2009 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-youtube-upload-queue
+ * @short_description: GData YouTube upload queue object
+ * @stability: Unstable
+ * @include: gdata/services/youtube/gdata-youtube-upload-queue.h
+ *
+ * #GDataYouTubeUploadQueue uploads videos with a #GDataYouTubeService, running up to #GDataYouTubeUploadQueue:max-uploads of them at once
+ * and holding the rest back until there's room for them. Videos are added with gdata_youtube_upload_queue_add(), and the result of each
+ * upload is returned by gdata_youtube_upload_queue_add_finish() once it's finished. The progress of each upload is reported by the
+ * #GDataYouTubeService::upload-progress signal, which identifies the upload by its video.
+ *
+ * Waiting uploads are started in order of their priority and then their deadline, with uploads which have the same priority and deadline
+ * started in the order they were added. Priorities work like those of I/O operations in GIO: lower values are more important. A deadline
+ * only orders the upload ahead of those with later deadlines (or none); an upload isn't abandoned if its deadline passes.
+ *
+ * The uploads running from a queue share the bandwidth given by #GDataYouTubeUploadQueue:max-bytes-per-second between them. Each chunk of a
+ * video is held back until the queue's allowance has caught up with it, so the queue can saturate the link when it's set to the link's
+ * capacity, or leave some of it for other requests when it's set lower.
+ *
+ * Each upload is an asynchronous operation of the service, so also counts against its #GDataService:max-operations. To keep the service
+ * responsive to other requests while the queue is busy, #GDataYouTubeUploadQueue:max-uploads should be less than that.
+ *
+ * A queue must only be used from one thread; its callbacks are called in the thread-default main context of that thread.
+ *
+ * Since: 0.4.0
+ **/
+
+#include <config.h>
+#include <glib.h>
+
+#include "gdata-youtube-upload-queue.h"
+#include "gdata-private.h"
+
+/* The most data, in seconds' worth of the bandwidth limit, which may be sent in a burst after the queue's uploads have been held back less than
+ * they could have been (for example, when the queue's been idle) */
+#define BURST_LENGTH 1.0
+
+/* A video added to the queue, from when it's added until its upload finishes */
+typedef struct {
+	GDataYouTubeUploadQueue *queue;
+	GSimpleAsyncResult *result;
+	GDataYouTubeVideo *video;
+	GFile *video_file;
+	GCancellable *cancellable;
+
+	gint priority;
+	gboolean has_deadline;
+	GTimeVal deadline;
+	guint sequence;
+} Upload;
+
+static void gdata_youtube_upload_queue_dispose (GObject *object);
+static void gdata_youtube_upload_queue_finalize (GObject *object);
+static void gdata_youtube_upload_queue_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_youtube_upload_queue_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+struct _GDataYouTubeUploadQueuePrivate {
+	GDataYouTubeService *service;
+	guint max_uploads;
+
+	GQueue *pending; /* the uploads which haven't been started yet, in the order they'll be started */
+	guint n_running;
+	guint next_sequence;
+
+	/* The bandwidth limit is a token bucket, shared between the uploads. It's consulted from the I/O thread, so is protected by the mutex.
+	 * The number of tokens goes negative when a chunk is allowed to borrow against the future, and the chunk's held back until it's
+	 * been paid off. */
+	GStaticMutex bucket_mutex;
+	guint64 max_bytes_per_second;
+	GTimer *bucket_timer;
+	gdouble bucket_time;
+	gdouble tokens;
+};
+
+enum {
+	PROP_SERVICE = 1,
+	PROP_MAX_UPLOADS,
+	PROP_MAX_BYTES_PER_SECOND
+};
+
+G_DEFINE_TYPE (GDataYouTubeUploadQueue, gdata_youtube_upload_queue, G_TYPE_OBJECT)
+#define GDATA_YOUTUBE_UPLOAD_QUEUE_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GDATA_TYPE_YOUTUBE_UPLOAD_QUEUE, GDataYouTubeUploadQueuePrivate))
+
+static void
+gdata_youtube_upload_queue_class_init (GDataYouTubeUploadQueueClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataYouTubeUploadQueuePrivate));
+
+	gobject_class->get_property = gdata_youtube_upload_queue_get_property;
+	gobject_class->set_property = gdata_youtube_upload_queue_set_property;
+	gobject_class->dispose = gdata_youtube_upload_queue_dispose;
+	gobject_class->finalize = gdata_youtube_upload_queue_finalize;
+
+	/**
+	 * GDataYouTubeUploadQueue:service:
+	 *
+	 * The #GDataYouTubeService the videos are uploaded with.
+	 *
+	 * Since: 0.4.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_SERVICE,
+				g_param_spec_object ("service",
+					"Service", "The service the videos are uploaded with.",
+					GDATA_TYPE_YOUTUBE_SERVICE,
+					G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataYouTubeUploadQueue:max-uploads:
+	 *
+	 * The most uploads which may be running at once. If it's %0, every video is uploaded as soon as it's added, subject to the service's
+	 * #GDataService:max-operations.
+	 *
+	 * If it's lowered below the number of uploads currently running, no more are started until enough of those have finished.
+	 *
+	 * Since: 0.4.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_MAX_UPLOADS,
+				g_param_spec_uint ("max-uploads",
+					"Maximum uploads", "The most uploads which may be running at once.",
+					0, G_MAXUINT, 2,
+					G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataYouTubeUploadQueue:max-bytes-per-second:
+	 *
+	 * The most bytes per second which may be sent by all the queue's uploads together, averaged over about a second. If it's %0, the
+	 * uploads aren't limited.
+	 *
+	 * Since: 0.4.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_MAX_BYTES_PER_SECOND,
+				g_param_spec_uint64 ("max-bytes-per-second",
+					"Maximum bytes per second", "The most bytes per second which may be sent by the queue's uploads.",
+					0, G_MAXUINT64, 0,
+					G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gdata_youtube_upload_queue_init (GDataYouTubeUploadQueue *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_YOUTUBE_UPLOAD_QUEUE, GDataYouTubeUploadQueuePrivate);
+	self->priv->pending = g_queue_new ();
+	self->priv->bucket_timer = g_timer_new ();
+	g_static_mutex_init (&(self->priv->bucket_mutex));
+}
+
+static void
+gdata_youtube_upload_queue_dispose (GObject *object)
+{
+	GDataYouTubeUploadQueuePrivate *priv = GDATA_YOUTUBE_UPLOAD_QUEUE_GET_PRIVATE (object);
+
+	if (priv->service != NULL)
+		g_object_unref (priv->service);
+	priv->service = NULL;
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_youtube_upload_queue_parent_class)->dispose (object);
+}
+
+static void
+gdata_youtube_upload_queue_finalize (GObject *object)
+{
+	GDataYouTubeUploadQueuePrivate *priv = GDATA_YOUTUBE_UPLOAD_QUEUE_GET_PRIVATE (object);
+
+	/* Every upload holds a reference to the queue until it's finished, so there can't be any left */
+	g_assert (g_queue_is_empty (priv->pending) == TRUE);
+	g_queue_free (priv->pending);
+
+	g_timer_destroy (priv->bucket_timer);
+	g_static_mutex_free (&(priv->bucket_mutex));
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_youtube_upload_queue_parent_class)->finalize (object);
+}
+
+static void
+gdata_youtube_upload_queue_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataYouTubeUploadQueue *self = GDATA_YOUTUBE_UPLOAD_QUEUE (object);
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			g_value_set_object (value, self->priv->service);
+			break;
+		case PROP_MAX_UPLOADS:
+			g_value_set_uint (value, self->priv->max_uploads);
+			break;
+		case PROP_MAX_BYTES_PER_SECOND:
+			g_value_set_uint64 (value, gdata_youtube_upload_queue_get_max_bytes_per_second (self));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_youtube_upload_queue_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataYouTubeUploadQueue *self = GDATA_YOUTUBE_UPLOAD_QUEUE (object);
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			self->priv->service = g_value_dup_object (value);
+			break;
+		case PROP_MAX_UPLOADS:
+			gdata_youtube_upload_queue_set_max_uploads (self, g_value_get_uint (value));
+			break;
+		case PROP_MAX_BYTES_PER_SECOND:
+			gdata_youtube_upload_queue_set_max_bytes_per_second (self, g_value_get_uint64 (value));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+/**
+ * gdata_youtube_upload_queue_new:
+ * @service: the #GDataYouTubeService to upload the videos with
+ * @max_uploads: the most uploads which may be running at once, or %0
+ * @max_bytes_per_second: the most bytes per second the uploads may send between them, or %0
+ *
+ * Creates a new #GDataYouTubeUploadQueue which uploads videos with @service. See #GDataYouTubeUploadQueue:max-uploads and
+ * #GDataYouTubeUploadQueue:max-bytes-per-second for the details of the limits.
+ *
+ * Return value: a new #GDataYouTubeUploadQueue; unref with g_object_unref()
+ *
+ * Since: 0.4.0
+ **/
+GDataYouTubeUploadQueue *
+gdata_youtube_upload_queue_new (GDataYouTubeService *service, guint max_uploads, guint64 max_bytes_per_second)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_SERVICE (service), NULL);
+
+	return g_object_new (GDATA_TYPE_YOUTUBE_UPLOAD_QUEUE,
+			     "service", service,
+			     "max-uploads", max_uploads,
+			     "max-bytes-per-second", max_bytes_per_second,
+			     NULL);
+}
+
+/* Called from the I/O thread before each chunk of a video is sent, returning the number of milliseconds to hold the chunk back for */
+static guint
+throttle_cb (gsize length, GDataYouTubeUploadQueue *self)
+{
+	GDataYouTubeUploadQueuePrivate *priv = self->priv;
+	gdouble rate, now, delay = 0.0;
+
+	g_static_mutex_lock (&(priv->bucket_mutex));
+
+	if (priv->max_bytes_per_second != 0) {
+		rate = (gdouble) priv->max_bytes_per_second;
+
+		/* Top up the tokens for the time since they were last taken, then take the chunk's worth */
+		now = g_timer_elapsed (priv->bucket_timer, NULL);
+		priv->tokens = MIN (priv->tokens + (now - priv->bucket_time) * rate, rate * BURST_LENGTH);
+		priv->bucket_time = now;
+		priv->tokens -= length;
+
+		if (priv->tokens < 0.0)
+			delay = -priv->tokens / rate;
+	}
+
+	g_static_mutex_unlock (&(priv->bucket_mutex));
+
+	/* Round up, so that the chunk's never sent early */
+	return (delay > 0.0) ? (guint) (delay * 1000.0) + 1 : 0;
+}
+
+static void
+upload_free (Upload *upload)
+{
+	g_object_unref (upload->queue);
+	g_object_unref (upload->result);
+	g_object_unref (upload->video);
+	g_object_unref (upload->video_file);
+	if (upload->cancellable != NULL)
+		g_object_unref (upload->cancellable);
+
+	g_slice_free (Upload, upload);
+}
+
+static gint
+compare_uploads (const Upload *a, const Upload *b, gpointer user_data)
+{
+	if (a->priority != b->priority)
+		return (a->priority < b->priority) ? -1 : 1;
+
+	/* Uploads with deadlines go before those without */
+	if (a->has_deadline != b->has_deadline)
+		return (a->has_deadline == TRUE) ? -1 : 1;
+
+	if (a->has_deadline == TRUE) {
+		if (a->deadline.tv_sec != b->deadline.tv_sec)
+			return (a->deadline.tv_sec < b->deadline.tv_sec) ? -1 : 1;
+		if (a->deadline.tv_usec != b->deadline.tv_usec)
+			return (a->deadline.tv_usec < b->deadline.tv_usec) ? -1 : 1;
+	}
+
+	return (a->sequence < b->sequence) ? -1 : 1;
+}
+
+static void run_uploads (GDataYouTubeUploadQueue *self);
+
+static void
+upload_finished_cb (GDataYouTubeService *service, GAsyncResult *async_result, Upload *upload)
+{
+	GDataYouTubeUploadQueue *self = upload->queue;
+	GDataYouTubeVideo *uploaded_video;
+	GError *error = NULL;
+
+	uploaded_video = gdata_youtube_service_upload_video_finish (service, async_result, &error);
+	if (uploaded_video == NULL) {
+		g_simple_async_result_set_from_error (upload->result, error);
+		g_error_free (error);
+	} else {
+		g_simple_async_result_set_op_res_gpointer (upload->result, uploaded_video, (GDestroyNotify) g_object_unref);
+	}
+
+	/* Start the next upload before handing over this one's result, so that the queue's counts are up to date in the callback */
+	self->priv->n_running--;
+	run_uploads (self);
+
+	g_simple_async_result_complete (upload->result);
+	upload_free (upload);
+}
+
+/* Start as many of the waiting uploads as the queue's limit allows */
+static void
+run_uploads (GDataYouTubeUploadQueue *self)
+{
+	GDataYouTubeUploadQueuePrivate *priv = self->priv;
+	Upload *upload;
+
+	while ((priv->max_uploads == 0 || priv->n_running < priv->max_uploads) && (upload = g_queue_pop_head (priv->pending)) != NULL) {
+		priv->n_running++;
+		_gdata_youtube_service_upload_video_async (priv->service, upload->video, upload->video_file,
+							   (GDataYouTubeUploadThrottleFunc) throttle_cb, self, upload->cancellable,
+							   (GAsyncReadyCallback) upload_finished_cb, upload);
+	}
+}
+
+/**
+ * gdata_youtube_upload_queue_add:
+ * @self: a #GDataYouTubeUploadQueue
+ * @video: a #GDataYouTubeVideo to insert
+ * @video_file: the video file to upload
+ * @priority: the priority of the upload; lower values are more important
+ * @deadline: the time by which the upload should be finished, or %NULL
+ * @cancellable: optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the upload is finished
+ * @user_data: data to pass to the @callback function
+ *
+ * Adds @video_file to the queue, to be uploaded as a new video with the properties from @video once the uploads ahead of it have been
+ * started and there's room for it. @video and @video_file are reffed, so can safely be unreffed after this function returns.
+ *
+ * The upload is started with gdata_youtube_service_upload_video_async(), so the same errors can be returned. If @cancellable is cancelled
+ * before the upload's started, it's finished with a %G_IO_ERROR_CANCELLED error once it reaches the front of the queue.
+ *
+ * When the upload is finished, @callback will be called. You can then call gdata_youtube_upload_queue_add_finish() to get the results of
+ * the upload.
+ *
+ * Since: 0.4.0
+ **/
+void
+gdata_youtube_upload_queue_add (GDataYouTubeUploadQueue *self, GDataYouTubeVideo *video, GFile *video_file, gint priority,
+				const GTimeVal *deadline, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+	Upload *upload;
+
+	g_return_if_fail (GDATA_IS_YOUTUBE_UPLOAD_QUEUE (self));
+	g_return_if_fail (GDATA_IS_YOUTUBE_VIDEO (video));
+	g_return_if_fail (G_IS_FILE (video_file));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	upload = g_slice_new0 (Upload);
+	upload->queue = g_object_ref (self);
+	upload->result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_youtube_upload_queue_add);
+	upload->video = g_object_ref (video);
+	upload->video_file = g_object_ref (video_file);
+	upload->cancellable = (cancellable != NULL) ? g_object_ref (cancellable) : NULL;
+	upload->priority = priority;
+	upload->sequence = self->priv->next_sequence++;
+
+	if (deadline != NULL) {
+		upload->has_deadline = TRUE;
+		upload->deadline = *deadline;
+	}
+
+	g_queue_insert_sorted (self->priv->pending, upload, (GCompareDataFunc) compare_uploads, NULL);
+	run_uploads (self);
+}
+
+/**
+ * gdata_youtube_upload_queue_add_finish:
+ * @self: a #GDataYouTubeUploadQueue
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an upload added to the queue with gdata_youtube_upload_queue_add().
+ *
+ * Return value: the inserted #GDataYouTubeVideo with updated properties from the original video, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.4.0
+ **/
+GDataYouTubeVideo *
+gdata_youtube_upload_queue_add_finish (GDataYouTubeUploadQueue *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+	GDataYouTubeVideo *video;
+
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_UPLOAD_QUEUE (self), NULL);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), NULL);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_youtube_upload_queue_add);
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return NULL;
+
+	video = g_simple_async_result_get_op_res_gpointer (result);
+	if (video != NULL)
+		return g_object_ref (video);
+
+	g_assert_not_reached ();
+}
+
+/**
+ * gdata_youtube_upload_queue_get_service:
+ * @self: a #GDataYouTubeUploadQueue
+ *
+ * Gets the #GDataYouTubeUploadQueue:service property.
+ *
+ * Return value: the service the videos are uploaded with
+ *
+ * Since: 0.4.0
+ **/
+GDataYouTubeService *
+gdata_youtube_upload_queue_get_service (GDataYouTubeUploadQueue *self)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_UPLOAD_QUEUE (self), NULL);
+	return self->priv->service;
+}
+
+/**
+ * gdata_youtube_upload_queue_get_max_uploads:
+ * @self: a #GDataYouTubeUploadQueue
+ *
+ * Gets the #GDataYouTubeUploadQueue:max-uploads property.
+ *
+ * Return value: the most uploads which may be running at once, or %0
+ *
+ * Since: 0.4.0
+ **/
+guint
+gdata_youtube_upload_queue_get_max_uploads (GDataYouTubeUploadQueue *self)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_UPLOAD_QUEUE (self), 0);
+	return self->priv->max_uploads;
+}
+
+/**
+ * gdata_youtube_upload_queue_set_max_uploads:
+ * @self: a #GDataYouTubeUploadQueue
+ * @max_uploads: the most uploads which may be running at once, or %0
+ *
+ * Sets the #GDataYouTubeUploadQueue:max-uploads property. If it's been raised, waiting uploads are started straight away to make up the
+ * difference.
+ *
+ * Since: 0.4.0
+ **/
+void
+gdata_youtube_upload_queue_set_max_uploads (GDataYouTubeUploadQueue *self, guint max_uploads)
+{
+	g_return_if_fail (GDATA_IS_YOUTUBE_UPLOAD_QUEUE (self));
+
+	self->priv->max_uploads = max_uploads;
+	g_object_notify (G_OBJECT (self), "max-uploads");
+
+	run_uploads (self);
+}
+
+/**
+ * gdata_youtube_upload_queue_get_max_bytes_per_second:
+ * @self: a #GDataYouTubeUploadQueue
+ *
+ * Gets the #GDataYouTubeUploadQueue:max-bytes-per-second property.
+ *
+ * Return value: the most bytes per second the uploads may send between them, or %0
+ *
+ * Since: 0.4.0
+ **/
+guint64
+gdata_youtube_upload_queue_get_max_bytes_per_second (GDataYouTubeUploadQueue *self)
+{
+	guint64 max_bytes_per_second;
+
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_UPLOAD_QUEUE (self), 0);
+
+	g_static_mutex_lock (&(self->priv->bucket_mutex));
+	max_bytes_per_second = self->priv->max_bytes_per_second;
+	g_static_mutex_unlock (&(self->priv->bucket_mutex));
+
+	return max_bytes_per_second;
+}
+
+/**
+ * gdata_youtube_upload_queue_set_max_bytes_per_second:
+ * @self: a #GDataYouTubeUploadQueue
+ * @max_bytes_per_second: the most bytes per second the uploads may send between them, or %0
+ *
+ * Sets the #GDataYouTubeUploadQueue:max-bytes-per-second property. It applies to the uploads which are already running, as well as those
+ * which are started later, from the next chunk of each video.
+ *
+ * Since: 0.4.0
+ **/
+void
+gdata_youtube_upload_queue_set_max_bytes_per_second (GDataYouTubeUploadQueue *self, guint64 max_bytes_per_second)
+{
+	GDataYouTubeUploadQueuePrivate *priv;
+
+	g_return_if_fail (GDATA_IS_YOUTUBE_UPLOAD_QUEUE (self));
+
+	priv = self->priv;
+
+	/* Start again with a full bucket */
+	g_static_mutex_lock (&(priv->bucket_mutex));
+	priv->max_bytes_per_second = max_bytes_per_second;
+	priv->bucket_time = g_timer_elapsed (priv->bucket_timer, NULL);
+	priv->tokens = (gdouble) max_bytes_per_second * BURST_LENGTH;
+	g_static_mutex_unlock (&(priv->bucket_mutex));
+
+	g_object_notify (G_OBJECT (self), "max-bytes-per-second");
+}
+
+/**
+ * gdata_youtube_upload_queue_get_n_pending:
+ * @self: a #GDataYouTubeUploadQueue
+ *
+ * Gets the number of uploads which have been added to the queue but not started yet.
+ *
+ * Return value: the number of waiting uploads
+ *
+ * Since: 0.4.0
+ **/
+guint
+gdata_youtube_upload_queue_get_n_pending (GDataYouTubeUploadQueue *self)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_UPLOAD_QUEUE (self), 0);
+	return g_queue_get_length (self->priv->pending);
+}
+
+/**
+ * gdata_youtube_upload_queue_get_n_running:
+ * @self: a #GDataYouTubeUploadQueue
+ *
+ * Gets the number of uploads which have been started and haven't finished yet.
+ *
+ * Return value: the number of running uploads
+ *
+ * Since: 0.4.0
+ **/
+guint
+gdata_youtube_upload_queue_get_n_running (GDataYouTubeUploadQueue *self)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_UPLOAD_QUEUE (self), 0);
+	return self->priv->n_running;
+}
@@ -0,0 +1,85 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2009 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_YOUTUBE_UPLOAD_QUEUE_H
+#define GDATA_YOUTUBE_UPLOAD_QUEUE_H
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <gdata/services/youtube/gdata-youtube-service.h>
+#include <gdata/services/youtube/gdata-youtube-video.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_YOUTUBE_UPLOAD_QUEUE		(gdata_youtube_upload_queue_get_type ())
+#define GDATA_YOUTUBE_UPLOAD_QUEUE(o)		(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_YOUTUBE_UPLOAD_QUEUE, GDataYouTubeUploadQueue))
+#define GDATA_YOUTUBE_UPLOAD_QUEUE_CLASS(k)	(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_YOUTUBE_UPLOAD_QUEUE, GDataYouTubeUploadQueueClass))
+#define GDATA_IS_YOUTUBE_UPLOAD_QUEUE(o)	(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_YOUTUBE_UPLOAD_QUEUE))
+#define GDATA_IS_YOUTUBE_UPLOAD_QUEUE_CLASS(k)	(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_YOUTUBE_UPLOAD_QUEUE))
+#define GDATA_YOUTUBE_UPLOAD_QUEUE_GET_CLASS(o)	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_YOUTUBE_UPLOAD_QUEUE, GDataYouTubeUploadQueueClass))
+
+typedef struct _GDataYouTubeUploadQueuePrivate	GDataYouTubeUploadQueuePrivate;
+
+/**
+ * GDataYouTubeUploadQueue:
+ *
+ * All the fields in the #GDataYouTubeUploadQueue structure are private and should never be accessed directly.
+ *
+ * Since: 0.4.0
+ **/
+typedef struct {
+	GObject parent;
+	GDataYouTubeUploadQueuePrivate *priv;
+} GDataYouTubeUploadQueue;
+
+/**
+ * GDataYouTubeUploadQueueClass:
+ *
+ * All the fields in the #GDataYouTubeUploadQueueClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.4.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataYouTubeUploadQueueClass;
+
+GType gdata_youtube_upload_queue_get_type (void) G_GNUC_CONST;
+
+GDataYouTubeUploadQueue *gdata_youtube_upload_queue_new (GDataYouTubeService *service, guint max_uploads,
+							 guint64 max_bytes_per_second) G_GNUC_WARN_UNUSED_RESULT;
+
+GDataYouTubeService *gdata_youtube_upload_queue_get_service (GDataYouTubeUploadQueue *self);
+guint gdata_youtube_upload_queue_get_max_uploads (GDataYouTubeUploadQueue *self);
+void gdata_youtube_upload_queue_set_max_uploads (GDataYouTubeUploadQueue *self, guint max_uploads);
+guint64 gdata_youtube_upload_queue_get_max_bytes_per_second (GDataYouTubeUploadQueue *self);
+void gdata_youtube_upload_queue_set_max_bytes_per_second (GDataYouTubeUploadQueue *self, guint64 max_bytes_per_second);
+guint gdata_youtube_upload_queue_get_n_pending (GDataYouTubeUploadQueue *self);
+guint gdata_youtube_upload_queue_get_n_running (GDataYouTubeUploadQueue *self);
+
+void gdata_youtube_upload_queue_add (GDataYouTubeUploadQueue *self, GDataYouTubeVideo *video, GFile *video_file, gint priority,
+				     const GTimeVal *deadline, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+GDataYouTubeVideo *gdata_youtube_upload_queue_add_finish (GDataYouTubeUploadQueue *self, GAsyncResult *async_result,
+							  GError **error) G_GNUC_WARN_UNUSED_RESULT;
+
+G_END_DECLS
+
+#endif /* !GDATA_YOUTUBE_UPLOAD_QUEUE_H */
@@ -835,7 +835,7 @@ parse_media_group_xml_node (GDataYouTubeVideo *self, xmlDoc *doc, xmlNode *node,
 		GTimeVal uploaded_timeval;
 
 		uploaded = xmlNodeListGetString (doc, node->children, TRUE);
-		if (g_time_val_from_iso8601 ((gchar*) uploaded, &uploaded_timeval) == FALSE) {
+		if (gdata_parser_time_val_from_iso8601 ((gchar*) uploaded, &uploaded_timeval) == FALSE) {
 			/* Error */
 			gdata_parser_error_not_iso8601_format (node, (gchar*) uploaded, error);
 			xmlFree (uploaded);
@@ -1087,9 +1087,8 @@ get_xml (GDataEntry *entry, GString *xml_string)
 	}
 
 	if (priv->recorded.tv_sec != 0 || priv->recorded.tv_usec != 0) {
-		gchar *recorded = gdata_parser_date_from_time_val (&(priv->recorded));
-		g_string_append_printf (xml_string, "<yt:recorded>%s</yt:recorded>", recorded);
-		g_free (recorded);
+		gchar recorded[GDATA_PARSER_ISO8601_BUFFER_SIZE];
+		g_string_append_printf (xml_string, "<yt:recorded>%s</yt:recorded>", gdata_parser_date_from_time_val (&(priv->recorded), recorded));
 	}
 
 	/* TODO:
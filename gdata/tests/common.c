@@ -0,0 +1,151 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2009 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#include "common.h"
+
+/* A GFile which wraps another, but which has no local path, so that libgdata can't map it into memory and has to read it through a stream */
+typedef struct {
+	GObject parent;
+	GFile *file;
+} UnmappableFile;
+
+typedef struct {
+	GObjectClass parent;
+} UnmappableFileClass;
+
+static GType unmappable_file_get_type (void) G_GNUC_CONST;
+static void unmappable_file_iface_init (GFileIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (UnmappableFile, unmappable_file, G_TYPE_OBJECT,
+			 G_IMPLEMENT_INTERFACE (G_TYPE_FILE, unmappable_file_iface_init))
+
+static void
+unmappable_file_finalize (GObject *object)
+{
+	g_object_unref (((UnmappableFile*) object)->file);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (unmappable_file_parent_class)->finalize (object);
+}
+
+static void
+unmappable_file_class_init (UnmappableFileClass *klass)
+{
+	G_OBJECT_CLASS (klass)->finalize = unmappable_file_finalize;
+}
+
+static void
+unmappable_file_init (UnmappableFile *self)
+{
+	/* Nothing to see here */
+}
+
+#define WRAPPED_FILE(f) (((UnmappableFile*) (f))->file)
+
+static GFile *
+unmappable_file_dup (GFile *file)
+{
+	return unmappable_file_new (WRAPPED_FILE (file));
+}
+
+static guint
+unmappable_file_hash (GFile *file)
+{
+	return g_file_hash (WRAPPED_FILE (file));
+}
+
+static gboolean
+unmappable_file_equal (GFile *file1, GFile *file2)
+{
+	return g_file_equal (WRAPPED_FILE (file1), WRAPPED_FILE (file2));
+}
+
+static gboolean
+unmappable_file_is_native (GFile *file)
+{
+	return FALSE;
+}
+
+static char *
+unmappable_file_get_basename (GFile *file)
+{
+	return g_file_get_basename (WRAPPED_FILE (file));
+}
+
+static char *
+unmappable_file_get_path (GFile *file)
+{
+	return NULL;
+}
+
+static char *
+unmappable_file_get_uri (GFile *file)
+{
+	return g_file_get_uri (WRAPPED_FILE (file));
+}
+
+static char *
+unmappable_file_get_parse_name (GFile *file)
+{
+	return g_file_get_parse_name (WRAPPED_FILE (file));
+}
+
+static GFileInfo *
+unmappable_file_query_info (GFile *file, const char *attributes, GFileQueryInfoFlags flags, GCancellable *cancellable, GError **error)
+{
+	return g_file_query_info (WRAPPED_FILE (file), attributes, flags, cancellable, error);
+}
+
+static GFileInputStream *
+unmappable_file_read (GFile *file, GCancellable *cancellable, GError **error)
+{
+	return g_file_read (WRAPPED_FILE (file), cancellable, error);
+}
+
+static void
+unmappable_file_iface_init (GFileIface *iface)
+{
+	iface->dup = unmappable_file_dup;
+	iface->hash = unmappable_file_hash;
+	iface->equal = unmappable_file_equal;
+	iface->is_native = unmappable_file_is_native;
+	iface->get_basename = unmappable_file_get_basename;
+	iface->get_path = unmappable_file_get_path;
+	iface->get_uri = unmappable_file_get_uri;
+	iface->get_parse_name = unmappable_file_get_parse_name;
+	iface->query_info = unmappable_file_query_info;
+	iface->read_fn = unmappable_file_read;
+}
+
+/* Returns a new GFile which reads @file's contents, but which can't be mapped into memory */
+GFile *
+unmappable_file_new (GFile *file)
+{
+	UnmappableFile *self;
+
+	g_return_val_if_fail (G_IS_FILE (file), NULL);
+
+	self = g_object_new (unmappable_file_get_type (), NULL);
+	self->file = g_object_ref (file);
+
+	return G_FILE (self);
+}
@@ -20,12 +20,17 @@
 #ifndef GDATA_TEST_COMMON_H
 #define GDATA_TEST_COMMON_H
 
+#include <glib.h>
+#include <gio/gio.h>
+
 G_BEGIN_DECLS
 
 #define CLIENT_ID "ytapi-GNOME-libgdata-444fubtt-0"
 #define USERNAME "libgdata.test@gmail.com"
 #define PASSWORD "gdata-libgdata"
 
+GFile *unmappable_file_new (GFile *file);
+
 G_END_DECLS
 
 #endif /* !GDATA_TEST_COMMON_H */
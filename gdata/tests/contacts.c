@@ -19,6 +19,8 @@
 
 #include <glib.h>
 #include <unistd.h>
+#include <string.h>
+#include <libsoup/soup.h>
 
 #include "gdata.h"
 #include "common.h"
@@ -391,6 +393,115 @@ test_photo_delete (void)
 	g_object_unref (contact);
 }
 
+typedef struct {
+	GString *photo;
+	gchar *content_type;
+	guint n_requests;
+} PhotoServerData;
+
+static void
+photo_server_cb (SoupServer *server, SoupMessage *message, const char *path, GHashTable *query, SoupClientContext *client,
+		 PhotoServerData *data)
+{
+	g_assert (message->method == SOUP_METHOD_PUT);
+	g_assert_cmpstr (path, ==, "/photo");
+
+	data->n_requests++;
+	g_string_truncate (data->photo, 0);
+	g_string_append_len (data->photo, message->request_body->data, message->request_body->length);
+	g_free (data->content_type);
+	data->content_type = g_strdup (soup_message_headers_get_content_type (message->request_headers, NULL));
+
+	soup_message_set_status (message, SOUP_STATUS_OK);
+	soup_message_headers_append (message->response_headers, "ETag", "\"photo\"");
+}
+
+static gpointer
+photo_server_thread_func (GMainLoop *loop)
+{
+	g_main_loop_run (loop);
+	return NULL;
+}
+
+static void
+test_photo_add_from_file (gconstpointer mapped)
+{
+	GDataService *local_service;
+	GDataContactsContact *contact;
+	PhotoServerData data;
+	GMainContext *context;
+	GMainLoop *loop;
+	GThread *thread;
+	SoupServer *server;
+	GFile *photo_file, *file;
+	GFileInfo *photo_file_info;
+	gchar *xml, *contents;
+	gsize length;
+	GError *error = NULL;
+
+	/* Run a stand-in for the photo server in another thread */
+	data.photo = g_string_new (NULL);
+	data.content_type = NULL;
+	data.n_requests = 0;
+
+	context = g_main_context_new ();
+	server = soup_server_new (SOUP_SERVER_PORT, 0, SOUP_SERVER_ASYNC_CONTEXT, context, NULL);
+	soup_server_add_handler (server, NULL, (SoupServerCallback) photo_server_cb, &data, NULL);
+	soup_server_run_async (server);
+
+	loop = g_main_loop_new (context, FALSE);
+	thread = g_thread_create ((GThreadFunc) photo_server_thread_func, loop, TRUE, NULL);
+
+	/* Point the contact's photo link at it */
+	xml = g_strdup_printf ("<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005'>"
+				"<id>http://www.google.com/m8/feeds/contacts/libgdata.test@googlemail.com/base/1b46cdd20bfbee3b</id>"
+				"<updated>2009-04-25T15:21:53.688Z</updated>"
+				"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/contact/2008#contact'/>"
+				"<title>Photo</title>"
+				"<link rel='http://schemas.google.com/contacts/2008/rel#photo' type='image/*' href='http://127.0.0.1:%u/photo'/>"
+			       "</entry>", soup_server_get_port (server));
+	contact = gdata_contacts_contact_new_from_xml (xml, -1, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_CONTACTS_CONTACT (contact));
+	g_assert (gdata_contacts_contact_has_photo (contact) == FALSE);
+	g_free (xml);
+
+	/* Local files are mapped and sent from the mapping; others are loaded first */
+	photo_file = g_file_new_for_path (TEST_FILE_DIR "photo.jpg");
+	file = (GPOINTER_TO_UINT (mapped) == TRUE) ? g_object_ref (photo_file) : unmappable_file_new (photo_file);
+
+	local_service = GDATA_SERVICE (gdata_contacts_service_new (CLIENT_ID));
+	g_assert (gdata_contacts_contact_set_photo_from_file (contact, local_service, file, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+	g_assert (gdata_contacts_contact_has_photo (contact) == TRUE);
+
+	/* The server should have received the whole photo, intact, with its content type */
+	g_assert_cmpuint (data.n_requests, ==, 1);
+	g_assert (g_file_load_contents (photo_file, NULL, &contents, &length, NULL, NULL) == TRUE);
+	g_assert_cmpuint (data.photo->len, ==, length);
+	g_assert (memcmp (data.photo->str, contents, length) == 0);
+	g_free (contents);
+
+	photo_file_info = g_file_query_info (photo_file, "standard::content-type", G_FILE_QUERY_INFO_NONE, NULL, NULL);
+	g_assert (photo_file_info != NULL);
+	g_assert_cmpstr (data.content_type, ==, g_file_info_get_content_type (photo_file_info));
+	g_object_unref (photo_file_info);
+
+	g_object_unref (local_service);
+	g_object_unref (file);
+	g_object_unref (photo_file);
+	g_object_unref (contact);
+
+	g_main_loop_quit (loop);
+	g_thread_join (thread);
+	g_main_loop_unref (loop);
+	soup_server_quit (server);
+	g_object_unref (server);
+	g_main_context_unref (context);
+	g_string_free (data.photo, TRUE);
+	g_free (data.content_type);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -410,6 +521,8 @@ main (int argc, char *argv[])
 	g_test_add_func ("/contacts/query/uri", test_query_uri);
 	g_test_add_func ("/contacts/parser/minimal", test_parser_minimal);
 	g_test_add_func ("/contacts/photo/has_photo", test_photo_has_photo);
+	g_test_add_data_func ("/contacts/photo/add_from_file/mapped", GUINT_TO_POINTER (TRUE), test_photo_add_from_file);
+	g_test_add_data_func ("/contacts/photo/add_from_file/unmapped", GUINT_TO_POINTER (FALSE), test_photo_add_from_file);
 	if (g_test_slow () == TRUE) {
 		g_test_add_func ("/contacts/photo/add", test_photo_add);
 		g_test_add_func ("/contacts/photo/get", test_photo_get);
@@ -18,9 +18,14 @@
  */
 
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <locale.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libsoup/soup.h>
 
 #include "gdata.h"
+#include "common.h"
 
 static void
 test_entry_get_xml (void)
@@ -150,6 +155,79 @@ test_entry_parse_xml (void)
 	g_free (xml);
 }
 
+static GDataContactsContact *
+parse_struct_strings_contact (void)
+{
+	GDataContactsContact *contact;
+	GError *error = NULL;
+
+	contact = gdata_contacts_contact_new_from_xml (
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005'>"
+			"<id>http://example.com/contact</id>"
+			"<updated>2009-04-25T15:21:53.688Z</updated>"
+			"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/contact/2008#contact'/>"
+			"<title>Contact</title>"
+			"<link rel='self' type='application/atom+xml' href='http://example.com/contact'/>"
+			"<gd:email rel='http://schemas.google.com/g/2005#work' address='bob@example.com'/>"
+		"</entry>", -1, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_CONTACTS_CONTACT (contact));
+
+	return contact;
+}
+
+static void
+test_entry_struct_strings (void)
+{
+	GDataContactsContact *contact1, *contact2;
+	GDataCategory *category, *category_copy;
+	GDataLink *link, *link_copy;
+	GDataGDEmailAddress *email, *email_copy;
+
+	/* Parse the same values into two entries, and copy the parsed structures */
+	contact1 = parse_struct_strings_contact ();
+	contact2 = parse_struct_strings_contact ();
+
+	category = gdata_entry_get_categories (GDATA_ENTRY (contact1))->data;
+	category_copy = gdata_category_new (category->term, category->scheme, category->label);
+	link = gdata_entry_look_up_link (GDATA_ENTRY (contact1), "self");
+	link_copy = gdata_link_new (link->href, link->rel, link->type, link->hreflang, link->title, link->length);
+	email = gdata_contacts_contact_get_email_addresses (contact1)->data;
+	email_copy = gdata_gd_email_address_new (email->address, email->rel, email->label, email->primary);
+
+	/* Freeing the originals shouldn't affect the copies, or the other entry's structures */
+	g_object_unref (contact1);
+
+	g_assert_cmpstr (category_copy->scheme, ==, "http://schemas.google.com/g/2005#kind");
+	g_assert_cmpstr (link_copy->rel, ==, "self");
+	g_assert_cmpstr (link_copy->type, ==, "application/atom+xml");
+	g_assert_cmpstr (email_copy->rel, ==, "http://schemas.google.com/g/2005#work");
+
+	/* The structures own their strings, so replacing them in the way clients always have should be safe */
+	g_free (category_copy->scheme);
+	category_copy->scheme = g_strdup ("http://example.com/scheme");
+	g_free (link_copy->rel);
+	link_copy->rel = g_strdup ("related");
+	g_free (link_copy->type);
+	link_copy->type = NULL;
+	g_free (email_copy->rel);
+	email_copy->rel = g_strdup ("http://schemas.google.com/g/2005#home");
+
+	gdata_category_free (category_copy);
+	gdata_link_free (link_copy);
+	gdata_gd_email_address_free (email_copy);
+
+	category = gdata_entry_get_categories (GDATA_ENTRY (contact2))->data;
+	g_assert_cmpstr (category->scheme, ==, "http://schemas.google.com/g/2005#kind");
+	link = gdata_entry_look_up_link (GDATA_ENTRY (contact2), "self");
+	g_assert (link != NULL);
+	g_assert_cmpstr (link->type, ==, "application/atom+xml");
+	email = gdata_contacts_contact_get_email_addresses (contact2)->data;
+	g_assert_cmpstr (email->rel, ==, "http://schemas.google.com/g/2005#work");
+
+	g_object_unref (contact2);
+}
+
 static void
 test_query_categories (void)
 {
@@ -254,20 +332,1701 @@ test_media_thumbnail_parse_time (const gchar *locale)
 	setlocale (LC_ALL, "");
 }
 
+typedef struct {
+	const gchar *string;
+	gboolean is_valid;
+	glong tv_sec;
+	glong tv_usec;
+} DateTimeTest;
+
+static const DateTimeTest date_time_tests[] = {
+	{ "2009-04-05T12:34:56Z", TRUE, 1238934896, 0 },
+	{ "2009-04-05T12:34:56.789Z", TRUE, 1238934896, 789000 },
+	{ "2009-04-05T12:34:56,789Z", TRUE, 1238934896, 789000 },
+	{ "2009-04-05T12:34:56.123456789Z", TRUE, 1238934896, 123456 },
+	{ "2009-04-05T12:34:56+01:00", TRUE, 1238931296, 0 },
+	{ "2009-04-05T12:34:56+0100", TRUE, 1238931296, 0 },
+	{ "2009-04-05T12:34:56-05:30", TRUE, 1238954696, 0 },
+	{ "2009-04-05T12:34:56.5-0530", TRUE, 1238954696, 500000 },
+	{ "20090405T12:34:56Z", TRUE, 1238934896, 0 },
+	{ "20090405T123456Z", TRUE, 1238934896, 0 },
+	{ "1969-07-20T20:17:40Z", TRUE, -14182940, 0 },
+	{ "1969-12-31T23:59:59.25Z", TRUE, -1, 250000 },
+	{ "1950-06-15T08:00:00Z", TRUE, -616867200, 0 },
+	{ "2008-02-29T23:59:59Z", TRUE, 1204329599, 0 },
+	{ "2000-02-29T00:00:00Z", TRUE, 951782400, 0 },
+	{ "", FALSE, 0, 0 },
+	{ "foobar", FALSE, 0, 0 },
+	{ "2009-04-05", FALSE, 0, 0 },
+	{ "12:34:56Z", FALSE, 0, 0 }
+};
+
+static void
+test_parser_iso8601 (void)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (date_time_tests); i++) {
+		const DateTimeTest *test = &(date_time_tests[i]);
+		GDataEntry *entry;
+		GTimeVal expected, updated;
+		gchar *xml, *expected_xml;
+		gboolean glib_success;
+		GError *error = NULL;
+
+		g_test_message ("Parsing \"%s\"...", test->string);
+
+		/* GLib is the reference for what's accepted */
+		glib_success = g_time_val_from_iso8601 (test->string, &expected);
+		g_assert (glib_success == test->is_valid);
+
+		xml = g_strdup_printf ("<entry xmlns='http://www.w3.org/2005/Atom'>"
+					"<title type='text'>Dates</title>"
+					"<updated>%s</updated>"
+				       "</entry>", test->string);
+		entry = gdata_entry_new_from_xml (xml, -1, &error);
+		g_free (xml);
+
+		if (test->is_valid == FALSE) {
+			g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);
+			g_assert (entry == NULL);
+			g_clear_error (&error);
+			continue;
+		}
+
+		g_assert_no_error (error);
+		g_assert (GDATA_IS_ENTRY (entry));
+
+		/* Check the parsed time against both GLib and the table */
+		gdata_entry_get_updated (entry, &updated);
+		g_assert_cmpint (updated.tv_sec, ==, expected.tv_sec);
+		g_assert_cmpint (updated.tv_usec, ==, expected.tv_usec);
+		g_assert_cmpint (updated.tv_sec, ==, test->tv_sec);
+		g_assert_cmpint (updated.tv_usec, ==, test->tv_usec);
+
+		/* Check it's formatted the same way as GLib would format it */
+		xml = gdata_entry_get_xml (entry);
+		expected_xml = g_time_val_to_iso8601 (&expected);
+		g_test_message ("Formatting as \"%s\"...", expected_xml);
+		g_assert (strstr (xml, expected_xml) != NULL);
+		g_free (expected_xml);
+		g_free (xml);
+
+		g_object_unref (entry);
+	}
+}
+
+static void
+test_parser_iso8601_repeated (void)
+{
+	guint i;
+	/* Pairs of <published> and <updated> times which are parsed one after the other, so that each is parsed straight after the same
+	 * string, a different time, or an invalid string which has a valid one as its prefix */
+	const struct {
+		const gchar *published;
+		const gchar *updated;
+		gboolean is_valid;
+		glong published_sec;
+		glong updated_sec;
+	} tests[] = {
+		{ "2009-04-05T12:34:56Z", "2009-04-05T12:34:56Z", TRUE, 1238934896, 1238934896 },
+		{ "2009-04-05T12:34:56Z", "2008-02-29T23:59:59Z", TRUE, 1238934896, 1204329599 },
+		{ "2008-02-29T23:59:59Z", "2009-04-05T12:34:56+01:00", TRUE, 1204329599, 1238931296 },
+		{ "2009-04-05T12:34:56+01:00", "2009-04-05T12:34:56+01:00foo", FALSE, 0, 0 },
+		{ "2009-04-05T12:34:56+01:00", "2009-04-05T12:34:56Z", TRUE, 1238931296, 1238934896 }
+	};
+
+	for (i = 0; i < G_N_ELEMENTS (tests); i++) {
+		GDataEntry *entry;
+		GTimeVal published, updated;
+		gchar *xml;
+		GError *error = NULL;
+
+		xml = g_strdup_printf ("<entry xmlns='http://www.w3.org/2005/Atom'>"
+					"<title type='text'>Dates</title>"
+					"<published>%s</published>"
+					"<updated>%s</updated>"
+				       "</entry>", tests[i].published, tests[i].updated);
+		entry = gdata_entry_new_from_xml (xml, -1, &error);
+		g_free (xml);
+
+		if (tests[i].is_valid == FALSE) {
+			g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);
+			g_assert (entry == NULL);
+			g_clear_error (&error);
+			continue;
+		}
+
+		g_assert_no_error (error);
+		g_assert (GDATA_IS_ENTRY (entry));
+
+		gdata_entry_get_published (entry, &published);
+		gdata_entry_get_updated (entry, &updated);
+		g_assert_cmpint (published.tv_sec, ==, tests[i].published_sec);
+		g_assert_cmpint (updated.tv_sec, ==, tests[i].updated_sec);
+
+		g_object_unref (entry);
+	}
+}
+
+typedef struct {
+	const gchar *string;
+	gboolean is_valid;
+	gint year;
+	gint month;
+	gint day;
+} DateTest;
+
+static const DateTest date_tests[] = {
+	{ "2009-04-05", TRUE, 2009, 4, 5 },
+	{ "20090405", TRUE, 2009, 4, 5 },
+	{ "2009-01-31", TRUE, 2009, 1, 31 },
+	{ "2009-12-31", TRUE, 2009, 12, 31 },
+	{ "2008-02-29", TRUE, 2008, 2, 29 },
+	{ "2000-02-29", TRUE, 2000, 2, 29 },
+	{ "1969-07-20", TRUE, 1969, 7, 20 },
+	{ "2009-02-29", FALSE },
+	{ "1900-02-29", FALSE },
+	{ "2009-02-31", FALSE },
+	{ "2009-04-31", FALSE },
+	{ "20090431", FALSE },
+	{ "2009-00-10", FALSE },
+	{ "2009-13-10", FALSE },
+	{ "2009-04-00", FALSE },
+	{ "2009-4-5", FALSE },
+	{ "2009-04-05T12:34:56Z", FALSE },
+	{ "foobar", FALSE },
+	{ "", FALSE }
+};
+
+static void
+test_parser_date (void)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (date_tests); i++) {
+		const DateTest *test = &(date_tests[i]);
+		GDataYouTubeVideo *video;
+		GTimeVal recorded, expected;
+		gchar *xml, *expected_xml;
+		GError *error = NULL;
+
+		g_test_message ("Parsing \"%s\"...", test->string);
+
+		xml = g_strdup_printf ("<entry xmlns='http://www.w3.org/2005/Atom' xmlns:yt='http://gdata.youtube.com/schemas/2007'>"
+					"<title type='text'>Dates</title>"
+					"<yt:recorded>%s</yt:recorded>"
+				       "</entry>", test->string);
+		video = gdata_youtube_video_new_from_xml (xml, -1, &error);
+		g_free (xml);
+
+		if (test->is_valid == FALSE) {
+			g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);
+			g_assert (video == NULL);
+			g_clear_error (&error);
+			continue;
+		}
+
+		g_assert_no_error (error);
+		g_assert (GDATA_IS_YOUTUBE_VIDEO (video));
+		g_assert (g_date_valid_dmy (test->day, test->month, test->year) == TRUE);
+
+		/* The date should be midnight UTC, as GLib would parse it */
+		xml = g_strdup_printf ("%04d-%02d-%02dT00:00:00Z", test->year, test->month, test->day);
+		g_assert (g_time_val_from_iso8601 (xml, &expected) == TRUE);
+		g_free (xml);
+
+		gdata_youtube_video_get_recorded (video, &recorded);
+		g_assert_cmpint (recorded.tv_sec, ==, expected.tv_sec);
+		g_assert_cmpint (recorded.tv_usec, ==, 0);
+
+		g_object_unref (video);
+	}
+}
+
+static void
+test_parser_date_output (void)
+{
+	GDataYouTubeVideo *video;
+	guint i;
+
+	video = gdata_youtube_video_new (NULL);
+	gdata_entry_set_title (GDATA_ENTRY (video), "Dates");
+	gdata_youtube_video_set_category (video, gdata_media_category_new ("People", NULL,
+									   "http://gdata.youtube.com/schemas/2007/categories.cat"));
+
+	/* The date should be the date part of what GLib would output for each time, including times before 1970 and part-way through a day */
+	for (i = 0; i < G_N_ELEMENTS (date_time_tests); i++) {
+		GTimeVal recorded;
+		gchar *xml, *iso8601, *expected_xml;
+
+		if (date_time_tests[i].is_valid == FALSE)
+			continue;
+
+		recorded.tv_sec = date_time_tests[i].tv_sec;
+		recorded.tv_usec = date_time_tests[i].tv_usec;
+		gdata_youtube_video_set_recorded (video, &recorded);
+
+		iso8601 = g_time_val_to_iso8601 (&recorded);
+		expected_xml = g_strdup_printf ("<yt:recorded>%.10s</yt:recorded>", iso8601);
+		g_test_message ("Formatting \"%s\" as \"%s\"...", iso8601, expected_xml);
+
+		xml = gdata_entry_get_xml (GDATA_ENTRY (video));
+		g_assert (strstr (xml, expected_xml) != NULL);
+
+		g_free (xml);
+		g_free (expected_xml);
+		g_free (iso8601);
+	}
+
+	g_object_unref (video);
+}
+
+typedef struct {
+	GMainContext *context;
+	GMainLoop *loop;
+	GThread *thread;
+	SoupServer *server;
+} TestServer;
+
+static gpointer
+test_server_thread_func (GMainLoop *loop)
+{
+	g_main_loop_run (loop);
+	return NULL;
+}
+
+/* Runs a stand-in for a GData server in another thread, handling every request with @callback */
+static void
+test_server_start (TestServer *test_server, SoupServerCallback callback, gpointer user_data)
+{
+	test_server->context = g_main_context_new ();
+	test_server->server = soup_server_new (SOUP_SERVER_PORT, 0, SOUP_SERVER_ASYNC_CONTEXT, test_server->context, NULL);
+	soup_server_add_handler (test_server->server, NULL, callback, user_data, NULL);
+	soup_server_run_async (test_server->server);
+
+	test_server->loop = g_main_loop_new (test_server->context, FALSE);
+	test_server->thread = g_thread_create ((GThreadFunc) test_server_thread_func, test_server->loop, TRUE, NULL);
+}
+
+static gchar *
+test_server_build_uri (TestServer *test_server, const gchar *path)
+{
+	return g_strdup_printf ("http://127.0.0.1:%u%s", soup_server_get_port (test_server->server), path);
+}
+
+static void
+test_server_stop (TestServer *test_server)
+{
+	g_main_loop_quit (test_server->loop);
+	g_thread_join (test_server->thread);
+	g_main_loop_unref (test_server->loop);
+	soup_server_quit (test_server->server);
+	g_object_unref (test_server->server);
+	g_main_context_unref (test_server->context);
+}
+
+typedef struct {
+	gchar *request;
+	guint n_requests;
+} BatchServerData;
+
+static void
+batch_server_cb (SoupServer *server, SoupMessage *message, const char *path, GHashTable *query, SoupClientContext *client,
+		 BatchServerData *data)
+{
+	SoupBuffer *buffer;
+
+	/* Results for operations 1 (a successful query), 2 (a successful insertion), 3 (an update which conflicts) and 4 (a successful
+	 * deletion), out of order, plus a result which doesn't match any operation; operation 5 doesn't get a result */
+	const gchar *response =
+		"<?xml version='1.0' encoding='UTF-8'?>"
+		"<feed xmlns='http://www.w3.org/2005/Atom' xmlns:batch='http://schemas.google.com/gdata/batch'>"
+			"<id>http://example.com/feed/batch/1</id>"
+			"<updated>2009-08-20T10:00:00Z</updated>"
+			"<title type='text'>Batch results</title>"
+			"<entry>"
+				"<batch:id>2</batch:id>"
+				"<batch:status code='201' reason='Created'/>"
+				"<batch:operation type='insert'/>"
+				"<id>http://example.com/feed/inserted</id>"
+				"<updated>2009-08-20T10:00:00Z</updated>"
+				"<title type='text'>Inserted entry</title>"
+			"</entry>"
+			"<entry>"
+				"<id>http://example.com/feed/queried</id>"
+				"<updated>2009-08-19T10:00:00Z</updated>"
+				"<title type='text'>Queried entry</title>"
+				"<batch:id>1</batch:id>"
+				"<batch:status code='200' reason='Success'/>"
+				"<batch:operation type='query'/>"
+			"</entry>"
+			"<entry>"
+				"<id>http://example.com/feed/updated</id>"
+				"<title type='text'>Error</title>"
+				"<batch:id>3</batch:id>"
+				"<batch:status code='409' reason='Version conflict'/>"
+				"<batch:operation type='update'/>"
+			"</entry>"
+			"<entry>"
+				"<id>http://example.com/feed/deleted</id>"
+				"<batch:id>4</batch:id>"
+				"<batch:status code='200' reason='Success'/>"
+				"<batch:operation type='delete'/>"
+			"</entry>"
+			"<entry>"
+				"<batch:id>42</batch:id>"
+				"<batch:status code='200' reason='Success'/>"
+			"</entry>"
+		"</feed>";
+
+	g_assert (message->method == SOUP_METHOD_POST);
+	g_assert_cmpstr (path, ==, "/feed/batch");
+
+	data->n_requests++;
+	buffer = soup_message_body_flatten (message->request_body);
+	data->request = g_strndup (buffer->data, buffer->length);
+	soup_buffer_free (buffer);
+
+	soup_message_set_status (message, SOUP_STATUS_OK);
+	soup_message_set_response (message, "application/atom+xml", SOUP_MEMORY_STATIC, response, strlen (response));
+}
+
+typedef struct {
+	guint n_calls;
+	GDataBatchOperationType type;
+	GDataEntry *entry;
+	GError *error;
+} BatchResult;
+
+static void
+batch_operation_cb (guint operation_id, GDataBatchOperationType operation_type, GDataEntry *entry, GError *error, BatchResult *results)
+{
+	BatchResult *result;
+
+	g_assert_cmpuint (operation_id, >=, 1);
+	g_assert_cmpuint (operation_id, <=, 5);
+
+	result = &(results[operation_id - 1]);
+	result->n_calls++;
+	result->type = operation_type;
+	result->entry = (entry != NULL) ? g_object_ref (entry) : NULL;
+	result->error = (error != NULL) ? g_error_copy (error) : NULL;
+}
+
+static void
+test_batch (void)
+{
+	GDataService *service;
+	GDataBatchOperation *operation;
+	GDataEntry *inserted_entry, *updated_entry, *deleted_entry;
+	BatchServerData data;
+	BatchResult results[5];
+	TestServer test_server;
+	gchar *feed_uri;
+	guint i;
+	GError *error = NULL;
+
+	data.request = NULL;
+	data.n_requests = 0;
+	memset (results, 0, sizeof (results));
+
+	test_server_start (&test_server, (SoupServerCallback) batch_server_cb, &data);
+	feed_uri = test_server_build_uri (&test_server, "/feed/batch");
+
+	service = GDATA_SERVICE (gdata_contacts_service_new (CLIENT_ID));
+	operation = gdata_batch_operation_new (service, feed_uri);
+	g_assert (gdata_batch_operation_get_service (operation) == service);
+	g_assert_cmpstr (gdata_batch_operation_get_feed_uri (operation), ==, feed_uri);
+
+	inserted_entry = gdata_entry_new (NULL);
+	gdata_entry_set_title (inserted_entry, "Inserted entry");
+
+	updated_entry = gdata_entry_new_from_xml (
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' gd:etag='W/\"CkcHQH8_fCp7ImA9WxRVGEQ.\"'>"
+			"<id>http://example.com/feed/updated</id>"
+			"<updated>2009-08-18T10:00:00Z</updated>"
+			"<title type='text'>Updated entry</title>"
+			"<link rel='self' href='http://example.com/feed/updated'/>"
+		"</entry>", -1, &error);
+	g_assert_no_error (error);
+
+	deleted_entry = gdata_entry_new_from_xml (
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' gd:etag='W/\"DUMFR3YyfCp7ImA9WxRVGEQ.\"'>"
+			"<id>http://example.com/feed/deleted</id>"
+			"<updated>2009-08-18T10:00:00Z</updated>"
+			"<title type='text'>Deleted entry</title>"
+			"<link rel='self' href='http://example.com/feed/deleted'/>"
+		"</entry>", -1, &error);
+	g_assert_no_error (error);
+
+	/* Operations are numbered in the order they're added */
+	g_assert_cmpuint (gdata_batch_operation_add_query (operation, "http://example.com/feed/queried", GDATA_TYPE_ENTRY,
+							   (GDataBatchOperationCallback) batch_operation_cb, results), ==, 1);
+	g_assert_cmpuint (gdata_batch_operation_add_insertion (operation, inserted_entry, (GDataBatchOperationCallback) batch_operation_cb,
+							       results), ==, 2);
+	g_assert_cmpuint (gdata_batch_operation_add_update (operation, updated_entry, (GDataBatchOperationCallback) batch_operation_cb,
+							    results), ==, 3);
+	g_assert_cmpuint (gdata_batch_operation_add_deletion (operation, deleted_entry, (GDataBatchOperationCallback) batch_operation_cb,
+							      results), ==, 4);
+	g_assert_cmpuint (gdata_batch_operation_add_query (operation, "http://example.com/feed/missing", GDATA_TYPE_ENTRY,
+							   (GDataBatchOperationCallback) batch_operation_cb, results), ==, 5);
+
+	g_assert (gdata_batch_operation_run (operation, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+
+	/* Check the request feed; the batch elements should be spliced in just after each entry's opening tag */
+	g_assert_cmpuint (data.n_requests, ==, 1);
+	g_assert (data.request != NULL);
+	g_assert (g_str_has_prefix (data.request, "<?xml version='1.0' encoding='UTF-8'?><feed xmlns='http://www.w3.org/2005/Atom' "
+						  "xmlns:gd='http://schemas.google.com/g/2005' "
+						  "xmlns:batch='http://schemas.google.com/gdata/batch'>") == TRUE);
+	g_assert (g_str_has_suffix (data.request, "</entry></feed>") == TRUE);
+	g_assert (strstr (data.request, "<entry><id>http://example.com/feed/queried</id>"
+					 "<batch:id>1</batch:id><batch:operation type='query'/></entry>") != NULL);
+	g_assert (strstr (data.request, "'><batch:id>2</batch:id><batch:operation type='insert'/>"
+					 "<title type='text'>Inserted entry</title>") != NULL);
+	g_assert (strstr (data.request, "'><batch:id>3</batch:id><batch:operation type='update'/>"
+					 "<title type='text'>Updated entry</title><id>http://example.com/feed/updated</id>") != NULL);
+	g_assert (strstr (data.request, "<entry gd:etag='W/&quot;DUMFR3YyfCp7ImA9WxRVGEQ.&quot;'><id>http://example.com/feed/deleted</id>"
+					 "<batch:id>4</batch:id><batch:operation type='delete'/></entry>") != NULL);
+	g_assert (strstr (data.request, "<entry><id>http://example.com/feed/missing</id>"
+					 "<batch:id>5</batch:id><batch:operation type='query'/></entry>") != NULL);
+
+	/* Check the results; every operation's callback should've been called exactly once */
+	for (i = 0; i < G_N_ELEMENTS (results); i++)
+		g_assert_cmpuint (results[i].n_calls, ==, 1);
+
+	g_assert_cmpint (results[0].type, ==, GDATA_BATCH_OPERATION_QUERY);
+	g_assert_no_error (results[0].error);
+	g_assert (GDATA_IS_ENTRY (results[0].entry));
+	g_assert_cmpstr (gdata_entry_get_id (results[0].entry), ==, "http://example.com/feed/queried");
+	g_assert_cmpstr (gdata_entry_get_title (results[0].entry), ==, "Queried entry");
+
+	g_assert_cmpint (results[1].type, ==, GDATA_BATCH_OPERATION_INSERTION);
+	g_assert_no_error (results[1].error);
+	g_assert (GDATA_IS_ENTRY (results[1].entry));
+	g_assert (results[1].entry != inserted_entry);
+	g_assert_cmpstr (gdata_entry_get_id (results[1].entry), ==, "http://example.com/feed/inserted");
+	g_assert_cmpstr (gdata_entry_get_title (results[1].entry), ==, "Inserted entry");
+
+	/* The per-entry error status */
+	g_assert_cmpint (results[2].type, ==, GDATA_BATCH_OPERATION_UPDATE);
+	g_assert_error (results[2].error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_CONFLICT);
+	g_assert (results[2].entry == NULL);
+
+	g_assert_cmpint (results[3].type, ==, GDATA_BATCH_OPERATION_DELETION);
+	g_assert_no_error (results[3].error);
+	g_assert (results[3].entry == NULL);
+
+	g_assert_cmpint (results[4].type, ==, GDATA_BATCH_OPERATION_QUERY);
+	g_assert_error (results[4].error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);
+	g_assert (results[4].entry == NULL);
+
+	for (i = 0; i < G_N_ELEMENTS (results); i++) {
+		if (results[i].entry != NULL)
+			g_object_unref (results[i].entry);
+		g_clear_error (&(results[i].error));
+	}
+
+	/* The operations should've been removed once they'd been run, so running the batch again shouldn't send anything */
+	g_free (data.request);
+	data.request = NULL;
+	g_assert (gdata_batch_operation_run (operation, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+	g_assert_cmpuint (data.n_requests, ==, 1);
+
+	g_object_unref (inserted_entry);
+	g_object_unref (updated_entry);
+	g_object_unref (deleted_entry);
+	g_object_unref (operation);
+	g_object_unref (service);
+	g_free (feed_uri);
+
+	test_server_stop (&test_server);
+}
+
+/* A stand-in for a paginated feed of PAGED_FEED_N_ENTRIES entries, which serves the pages requested by start-index and max-results */
+#define PAGED_FEED_N_ENTRIES 25
+#define PAGED_FEED_ITEMS_PER_PAGE 10
+
+typedef struct {
+	gchar *feed_uri;
+	guint n_requests;
+} PagedFeedData;
+
+static guint
+get_query_parameter (GHashTable *query, const gchar *name, guint default_value)
+{
+	const gchar *value = (query != NULL) ? g_hash_table_lookup (query, name) : NULL;
+	return (value != NULL) ? (guint) g_ascii_strtoull (value, NULL, 10) : default_value;
+}
+
+static void
+paged_feed_server_cb (SoupServer *server, SoupMessage *message, const char *path, GHashTable *query, SoupClientContext *client,
+		      PagedFeedData *data)
+{
+	GString *response;
+	guint start_index, max_results, i;
+
+	g_assert (message->method == SOUP_METHOD_GET);
+	g_assert_cmpstr (path, ==, "/feed");
+
+	data->n_requests++;
+	start_index = get_query_parameter (query, "start-index", 1);
+	max_results = get_query_parameter (query, "max-results", PAGED_FEED_ITEMS_PER_PAGE);
+
+	response = g_string_new ("<?xml version='1.0' encoding='UTF-8'?>"
+				 "<feed xmlns='http://www.w3.org/2005/Atom' xmlns:openSearch='http://a9.com/-/spec/opensearch/1.1/'>"
+					"<id>http://example.com/feed</id>"
+					"<updated>2009-08-20T10:00:00Z</updated>"
+					"<title type='text'>Paged feed</title>");
+	g_string_append_printf (response, "<link rel='self' type='application/atom+xml' href='%s?start-index=%u&amp;max-results=%u'/>",
+				data->feed_uri, start_index, max_results);
+	g_string_append (response, "<link rel='alternate' type='text/html' href='http://example.com/'/>"
+				   "<link rel='http://schemas.google.com/g/2005#feed' type='application/atom+xml' href='http://example.com/feed'/>"
+				   "<link rel='alternate' type='text/html' hreflang='de' href='http://example.com/de/'/>");
+	if (start_index + max_results <= PAGED_FEED_N_ENTRIES) {
+		g_string_append_printf (response, "<link rel='next' type='application/atom+xml' href='%s?start-index=%u&amp;max-results=%u'/>",
+					data->feed_uri, start_index + max_results, max_results);
+	}
+	g_string_append_printf (response, "<openSearch:totalResults>%u</openSearch:totalResults>"
+					  "<openSearch:startIndex>%u</openSearch:startIndex>"
+					  "<openSearch:itemsPerPage>%u</openSearch:itemsPerPage>",
+				PAGED_FEED_N_ENTRIES, start_index, max_results);
+
+	for (i = start_index; i < start_index + max_results && i <= PAGED_FEED_N_ENTRIES; i++) {
+		g_string_append_printf (response, "<entry>"
+							"<id>http://example.com/feed/entry/%u</id>"
+							"<updated>2009-08-20T10:00:00Z</updated>"
+							"<title type='text'>Entry %u</title>"
+						  "</entry>", i, i);
+	}
+
+	g_string_append (response, "</feed>");
+
+	soup_message_set_status (message, SOUP_STATUS_OK);
+	soup_message_set_response (message, "application/atom+xml", SOUP_MEMORY_TAKE, response->str, response->len);
+	g_string_free (response, FALSE);
+}
+
+static void
+paged_feed_start (TestServer *test_server, PagedFeedData *data)
+{
+	data->n_requests = 0;
+	test_server_start (test_server, (SoupServerCallback) paged_feed_server_cb, data);
+	data->feed_uri = test_server_build_uri (test_server, "/feed");
+}
+
+static void
+paged_feed_stop (TestServer *test_server, PagedFeedData *data)
+{
+	test_server_stop (test_server);
+	g_free (data->feed_uri);
+}
+
+/* Checks that the entry is entry number @number (counting from 1) of the paged feed */
+static void
+assert_paged_feed_entry (GDataEntry *entry, guint number)
+{
+	gchar *id;
+
+	g_assert (GDATA_IS_ENTRY (entry));
+
+	id = g_strdup_printf ("http://example.com/feed/entry/%u", number);
+	g_assert_cmpstr (gdata_entry_get_id (entry), ==, id);
+	g_free (id);
+}
+
+typedef struct {
+	guint n_calls;
+	guint entry_count;
+	gboolean *seen_keys;
+} QueryProgressData;
+
+static void
+query_all_progress_cb (GDataEntry *entry, guint entry_key, guint entry_count, QueryProgressData *data)
+{
+	g_assert_cmpuint (entry_key, <, PAGED_FEED_N_ENTRIES);
+	g_assert (data->seen_keys[entry_key] == FALSE);
+	assert_paged_feed_entry (entry, entry_key + 1);
+
+	data->seen_keys[entry_key] = TRUE;
+	data->entry_count = entry_count;
+	data->n_calls++;
+}
+
+static void
+test_query_all (void)
+{
+	GDataService *service;
+	GDataFeed *feed;
+	PagedFeedData data;
+	QueryProgressData progress_data;
+	TestServer test_server;
+	gboolean seen_keys[PAGED_FEED_N_ENTRIES] = { FALSE, };
+	guint i;
+	GError *error = NULL;
+
+	paged_feed_start (&test_server, &data);
+	service = GDATA_SERVICE (gdata_contacts_service_new (CLIENT_ID));
+
+	progress_data.n_calls = 0;
+	progress_data.entry_count = 0;
+	progress_data.seen_keys = seen_keys;
+
+	/* All three pages should be downloaded, two at a time, and merged in order */
+	feed = gdata_service_query_all (service, data.feed_uri, NULL, GDATA_TYPE_ENTRY, 2, NULL,
+					(GDataQueryProgressCallback) query_all_progress_cb, &progress_data, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+	g_assert_cmpuint (data.n_requests, ==, 3);
+
+	/* The feed's properties are those of the first page */
+	g_assert_cmpstr (gdata_feed_get_id (feed), ==, "http://example.com/feed");
+	g_assert_cmpuint (gdata_feed_get_total_results (feed), ==, PAGED_FEED_N_ENTRIES);
+	g_assert_cmpuint (gdata_feed_get_start_index (feed), ==, 1);
+
+	g_assert_cmpuint (gdata_feed_get_n_entries (feed), ==, PAGED_FEED_N_ENTRIES);
+	for (i = 0; i < PAGED_FEED_N_ENTRIES; i++)
+		assert_paged_feed_entry (gdata_feed_get_entry_at (feed, i), i + 1);
+
+	/* The progress callbacks are delivered in this thread's main context, with keys covering the whole feed */
+	while (g_main_context_iteration (NULL, FALSE) == TRUE);
+	g_assert_cmpuint (progress_data.n_calls, ==, PAGED_FEED_N_ENTRIES);
+	g_assert_cmpuint (progress_data.entry_count, ==, PAGED_FEED_N_ENTRIES);
+
+	g_object_unref (feed);
+	g_object_unref (service);
+	paged_feed_stop (&test_server, &data);
+}
+
+/* A stand-in for the paged feed which holds on to each response for a while before sending it, and records how many requests it's handling at
+ * once */
+typedef struct {
+	PagedFeedData feed_data;
+	GMainContext *context;
+	volatile gint n_in_flight;
+	volatile gint max_in_flight;
+} SlowFeedData;
+
+typedef struct {
+	SoupServer *server;
+	SoupMessage *message;
+	SlowFeedData *data;
+} SlowFeedResponse;
+
+static gboolean
+slow_feed_respond_cb (SlowFeedResponse *response)
+{
+	g_atomic_int_add (&(response->data->n_in_flight), -1);
+	soup_server_unpause_message (response->server, response->message);
+
+	g_slice_free (SlowFeedResponse, response);
+	return FALSE;
+}
+
+static void
+slow_feed_server_cb (SoupServer *server, SoupMessage *message, const char *path, GHashTable *query, SoupClientContext *client,
+		     SlowFeedData *data)
+{
+	SlowFeedResponse *response;
+	GSource *source;
+	gint n_in_flight;
+
+	paged_feed_server_cb (server, message, path, query, client, &(data->feed_data));
+
+	/* Only accessed from the server thread, apart from being read by the test once the requests have finished */
+	n_in_flight = g_atomic_int_exchange_and_add (&(data->n_in_flight), 1) + 1;
+	if (n_in_flight > g_atomic_int_get (&(data->max_in_flight)))
+		g_atomic_int_set (&(data->max_in_flight), n_in_flight);
+
+	response = g_slice_new (SlowFeedResponse);
+	response->server = server;
+	response->message = message;
+	response->data = data;
+
+	soup_server_pause_message (server, message);
+
+	source = g_timeout_source_new (50);
+	g_source_set_callback (source, (GSourceFunc) slow_feed_respond_cb, response, NULL);
+	g_source_attach (source, data->context);
+	g_source_unref (source);
+}
+
+typedef struct {
+	GMainLoop *loop;
+	guint n_remaining;
+} QueryLimitData;
+
+static void
+query_limit_cb (GDataService *service, GAsyncResult *async_result, QueryLimitData *data)
+{
+	GDataFeed *feed;
+	GError *error = NULL;
+
+	feed = gdata_service_query_finish (service, async_result, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+	g_object_unref (feed);
+
+	if (--data->n_remaining == 0)
+		g_main_loop_quit (data->loop);
+}
+
+static void
+test_service_max_operations (void)
+{
+	GDataService *service1, *service2;
+	GDataFeed *feed;
+	SlowFeedData data;
+	QueryLimitData limit_data;
+	TestServer test_server;
+	guint i;
+	GError *error = NULL;
+
+	data.feed_data.n_requests = 0;
+	data.n_in_flight = 0;
+	data.max_in_flight = 0;
+	test_server_start (&test_server, (SoupServerCallback) slow_feed_server_cb, &data);
+	data.context = test_server.context;
+	data.feed_data.feed_uri = test_server_build_uri (&test_server, "/feed");
+
+	service1 = GDATA_SERVICE (gdata_contacts_service_new (CLIENT_ID));
+	service2 = GDATA_SERVICE (gdata_contacts_service_new (CLIENT_ID));
+	limit_data.loop = g_main_loop_new (NULL, FALSE);
+
+	/* No more than max-operations of a service's queries should be in flight at once */
+	gdata_service_set_max_operations (service1, 1);
+	limit_data.n_remaining = 4;
+	for (i = 0; i < 4; i++) {
+		gdata_service_query_async (service1, data.feed_data.feed_uri, NULL, GDATA_TYPE_ENTRY, NULL, NULL, NULL,
+					   (GAsyncReadyCallback) query_limit_cb, &limit_data);
+	}
+	g_main_loop_run (limit_data.loop);
+
+	g_assert_cmpuint (data.feed_data.n_requests, ==, 4);
+	g_assert_cmpint (g_atomic_int_get (&(data.max_in_flight)), ==, 1);
+
+	/* No more than the library-wide limit of queries should be in flight at once, across all services */
+	gdata_service_set_max_operations (service1, 0);
+	gdata_service_set_max_total_operations (3);
+	g_atomic_int_set (&(data.max_in_flight), 0);
+	limit_data.n_remaining = 8;
+	for (i = 0; i < 4; i++) {
+		gdata_service_query_async (service1, data.feed_data.feed_uri, NULL, GDATA_TYPE_ENTRY, NULL, NULL, NULL,
+					   (GAsyncReadyCallback) query_limit_cb, &limit_data);
+		gdata_service_query_async (service2, data.feed_data.feed_uri, NULL, GDATA_TYPE_ENTRY, NULL, NULL, NULL,
+					   (GAsyncReadyCallback) query_limit_cb, &limit_data);
+	}
+	g_main_loop_run (limit_data.loop);
+
+	g_assert_cmpuint (data.feed_data.n_requests, ==, 12);
+	g_assert_cmpint (g_atomic_int_get (&(data.max_in_flight)), >=, 1);
+	g_assert_cmpint (g_atomic_int_get (&(data.max_in_flight)), <=, 3);
+
+	/* The pages of gdata_service_query_all() should be subject to the limits too, however many connections it's allowed */
+	gdata_service_set_max_total_operations (1);
+	g_atomic_int_set (&(data.max_in_flight), 0);
+	data.feed_data.n_requests = 0;
+
+	feed = gdata_service_query_all (service1, data.feed_data.feed_uri, NULL, GDATA_TYPE_ENTRY, 4, NULL, NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+	g_assert_cmpuint (gdata_feed_get_n_entries (feed), ==, PAGED_FEED_N_ENTRIES);
+	g_object_unref (feed);
+
+	g_assert_cmpuint (data.feed_data.n_requests, ==, 3);
+	g_assert_cmpint (g_atomic_int_get (&(data.max_in_flight)), ==, 1);
+
+	gdata_service_set_max_total_operations (32);
+
+	g_main_loop_unref (limit_data.loop);
+	g_object_unref (service2);
+	g_object_unref (service1);
+	test_server_stop (&test_server);
+	g_free (data.feed_data.feed_uri);
+}
+
+#define CACHED_FEED_ETAG "\"cached-feed\""
+
+typedef struct {
+	guint n_requests;
+	guint n_not_modified;
+} CachedFeedData;
+
+static void
+cached_feed_server_cb (SoupServer *server, SoupMessage *message, const char *path, GHashTable *query, SoupClientContext *client,
+		       CachedFeedData *data)
+{
+	const gchar *if_none_match, *response;
+
+	data->n_requests++;
+
+	/* The feed never changes */
+	if_none_match = soup_message_headers_get_one (message->request_headers, "If-None-Match");
+	if (if_none_match != NULL && strcmp (if_none_match, CACHED_FEED_ETAG) == 0) {
+		data->n_not_modified++;
+		soup_message_set_status (message, SOUP_STATUS_NOT_MODIFIED);
+		return;
+	}
+
+	response = "<?xml version='1.0' encoding='UTF-8'?>"
+		   "<feed xmlns='http://www.w3.org/2005/Atom'>"
+			"<id>http://example.com/feed</id>"
+			"<updated>2009-08-20T10:00:00Z</updated>"
+			"<title type='text'>Cached feed</title>"
+			"<entry>"
+				"<id>http://example.com/feed/entry/1</id>"
+				"<updated>2009-08-20T10:00:00Z</updated>"
+				"<title type='text'>Entry 1</title>"
+			"</entry>"
+			"<entry>"
+				"<id>http://example.com/feed/entry/2</id>"
+				"<updated>2009-08-20T10:00:00Z</updated>"
+				"<title type='text'>Entry 2</title>"
+			"</entry>"
+		   "</feed>";
+
+	soup_message_set_status (message, SOUP_STATUS_OK);
+	soup_message_headers_append (message->response_headers, "ETag", CACHED_FEED_ETAG);
+	soup_message_set_response (message, "application/atom+xml", SOUP_MEMORY_STATIC, response, strlen (response));
+}
+
+static void
+assert_cached_feed (GDataService *service, const gchar *feed_uri)
+{
+	GDataFeed *feed;
+	GError *error = NULL;
+
+	feed = gdata_service_query (service, feed_uri, NULL, GDATA_TYPE_ENTRY, NULL, NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+
+	g_assert_cmpstr (gdata_feed_get_title (feed), ==, "Cached feed");
+	g_assert_cmpuint (gdata_feed_get_n_entries (feed), ==, 2);
+	g_assert_cmpstr (gdata_entry_get_id (gdata_feed_get_entry_at (feed, 0)), ==, "http://example.com/feed/entry/1");
+	g_assert_cmpstr (gdata_entry_get_id (gdata_feed_get_entry_at (feed, 1)), ==, "http://example.com/feed/entry/2");
+
+	g_object_unref (feed);
+}
+
+/* Returns the path of the only cached response in @cache_directory */
+static gchar *
+get_cached_response_path (const gchar *cache_directory)
+{
+	GDir *dir;
+	const gchar *name;
+	gchar *path = NULL;
+
+	dir = g_dir_open (cache_directory, 0, NULL);
+	g_assert (dir != NULL);
+
+	while ((name = g_dir_read_name (dir)) != NULL) {
+		if (g_str_has_suffix (name, ".etag") == FALSE) {
+			g_assert (path == NULL);
+			path = g_build_filename (cache_directory, name, NULL);
+		}
+	}
+
+	g_dir_close (dir);
+	g_assert (path != NULL);
+
+	return path;
+}
+
+static void
+test_service_cache (void)
+{
+	GDataService *service;
+	CachedFeedData data;
+	TestServer test_server;
+	gchar *feed_uri, *cache_directory, *response_path, *etag_path, *contents;
+	const gchar *name;
+	gsize length;
+	GDir *dir;
+
+	data.n_requests = 0;
+	data.n_not_modified = 0;
+	test_server_start (&test_server, (SoupServerCallback) cached_feed_server_cb, &data);
+	feed_uri = test_server_build_uri (&test_server, "/feed");
+
+	cache_directory = g_build_filename (g_get_tmp_dir (), "libgdata-cache-XXXXXX", NULL);
+	g_assert (mkdtemp (cache_directory) != NULL);
+
+	service = GDATA_SERVICE (gdata_contacts_service_new (CLIENT_ID));
+	gdata_service_set_cache_directory (service, cache_directory);
+	g_assert_cmpstr (gdata_service_get_cache_directory (service), ==, cache_directory);
+
+	/* The first query should be downloaded and stored, along with its ETag */
+	assert_cached_feed (service, feed_uri);
+	g_assert_cmpuint (data.n_requests, ==, 1);
+	g_assert_cmpuint (data.n_not_modified, ==, 0);
+
+	response_path = get_cached_response_path (cache_directory);
+	etag_path = g_strconcat (response_path, ".etag", NULL);
+	g_assert (g_file_get_contents (etag_path, &contents, NULL, NULL) == TRUE);
+	g_assert_cmpstr (contents, ==, CACHED_FEED_ETAG);
+	g_free (contents);
+
+	/* The second should be revalidated with the ETag, and built from the cache */
+	assert_cached_feed (service, feed_uri);
+	g_assert_cmpuint (data.n_requests, ==, 2);
+	g_assert_cmpuint (data.n_not_modified, ==, 1);
+
+	/* A truncated cached response should be ignored, and the feed downloaded again and re-cached */
+	g_assert (g_file_get_contents (response_path, &contents, &length, NULL) == TRUE);
+	g_assert (g_file_set_contents (response_path, contents, length / 2, NULL) == TRUE);
+	g_free (contents);
+
+	assert_cached_feed (service, feed_uri);
+	g_assert_cmpuint (data.n_requests, ==, 3);
+	g_assert_cmpuint (data.n_not_modified, ==, 1);
+
+	assert_cached_feed (service, feed_uri);
+	g_assert_cmpuint (data.n_requests, ==, 4);
+	g_assert_cmpuint (data.n_not_modified, ==, 2);
+
+	/* As should one which has been overwritten */
+	g_assert (g_file_set_contents (response_path, "garbage", -1, NULL) == TRUE);
+
+	assert_cached_feed (service, feed_uri);
+	g_assert_cmpuint (data.n_requests, ==, 5);
+	g_assert_cmpuint (data.n_not_modified, ==, 2);
+
+	assert_cached_feed (service, feed_uri);
+	g_assert_cmpuint (data.n_requests, ==, 6);
+	g_assert_cmpuint (data.n_not_modified, ==, 3);
+
+	/* Clean up the cache */
+	dir = g_dir_open (cache_directory, 0, NULL);
+	g_assert (dir != NULL);
+	while ((name = g_dir_read_name (dir)) != NULL) {
+		gchar *path = g_build_filename (cache_directory, name, NULL);
+		g_unlink (path);
+		g_free (path);
+	}
+	g_dir_close (dir);
+	g_rmdir (cache_directory);
+
+	g_free (etag_path);
+	g_free (response_path);
+	g_free (cache_directory);
+	g_object_unref (service);
+	test_server_stop (&test_server);
+	g_free (feed_uri);
+}
+
+static void
+test_feed_entries (gconstpointer flags)
+{
+	GDataService *service;
+	GDataQuery *query;
+	GDataFeed *feed;
+	GDataEntry *entry;
+	PagedFeedData data;
+	TestServer test_server;
+	GList *entries;
+	guint i;
+	GError *error = NULL;
+
+	paged_feed_start (&test_server, &data);
+	service = GDATA_SERVICE (gdata_contacts_service_new (CLIENT_ID));
+
+	query = gdata_query_new (NULL);
+	gdata_query_set_flags (query, GPOINTER_TO_UINT (flags));
+
+	feed = gdata_service_query (service, data.feed_uri, query, GDATA_TYPE_ENTRY, NULL, NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+
+	/* Whether or not the entries have been built yet, they should all be counted */
+	g_assert_cmpuint (gdata_feed_get_n_entries (feed), ==, PAGED_FEED_ITEMS_PER_PAGE);
+
+	/* Access an entry out of order, and check the same entry is returned each time */
+	entry = gdata_feed_get_entry_at (feed, 5);
+	assert_paged_feed_entry (entry, 6);
+	g_assert (gdata_feed_get_entry_at (feed, 5) == entry);
+	g_assert_cmpuint (gdata_feed_get_n_entries (feed), ==, PAGED_FEED_ITEMS_PER_PAGE);
+
+	for (i = 0; i < PAGED_FEED_ITEMS_PER_PAGE; i++)
+		assert_paged_feed_entry (gdata_feed_get_entry_at (feed, i), i + 1);
+
+	/* The list should contain the same entries, in the same order */
+	entries = gdata_feed_get_entries (feed);
+	g_assert_cmpuint (g_list_length (entries), ==, PAGED_FEED_ITEMS_PER_PAGE);
+	for (i = 0; entries != NULL; entries = entries->next, i++)
+		g_assert (entries->data == gdata_feed_get_entry_at (feed, i));
+	g_assert (gdata_feed_get_entry_at (feed, 5) == entry);
+
+	g_object_unref (feed);
+	g_object_unref (query);
+	g_object_unref (service);
+	paged_feed_stop (&test_server, &data);
+}
+
+static void
+test_feed_look_up_entry (gconstpointer flags)
+{
+	GDataService *service;
+	GDataQuery *query;
+	GDataFeed *feed;
+	GDataEntry *entry;
+	PagedFeedData data;
+	TestServer test_server;
+	const guint numbers[] = { 25, 1, 11, 10, 18 };
+	guint i;
+	GError *error = NULL;
+
+	paged_feed_start (&test_server, &data);
+	service = GDATA_SERVICE (gdata_contacts_service_new (CLIENT_ID));
+
+	query = gdata_query_new (NULL);
+	gdata_query_set_flags (query, GPOINTER_TO_UINT (flags));
+
+	/* The later pages' entries are appended to the first page's feed, so they should be indexed too */
+	feed = gdata_service_query_all (service, data.feed_uri, query, GDATA_TYPE_ENTRY, 0, NULL, NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+	g_assert_cmpuint (gdata_feed_get_n_entries (feed), ==, PAGED_FEED_N_ENTRIES);
+
+	for (i = 0; i < G_N_ELEMENTS (numbers); i++) {
+		gchar *id = g_strdup_printf ("http://example.com/feed/entry/%u", numbers[i]);
+
+		entry = gdata_feed_look_up_entry (feed, id);
+		assert_paged_feed_entry (entry, numbers[i]);
+		g_assert (gdata_feed_get_entry_at (feed, numbers[i] - 1) == entry);
+		g_assert (gdata_feed_look_up_entry (feed, id) == entry);
+
+		g_free (id);
+	}
+
+	g_assert (gdata_feed_look_up_entry (feed, "http://example.com/feed/entry/26") == NULL);
+	g_assert (gdata_feed_look_up_entry (feed, "http://example.com/feed") == NULL);
+
+	g_object_unref (feed);
+	g_object_unref (query);
+	g_object_unref (service);
+	paged_feed_stop (&test_server, &data);
+}
+
+static void
+malformed_feed_server_cb (SoupServer *server, SoupMessage *message, const char *path, GHashTable *query, SoupClientContext *client,
+			  gpointer user_data)
+{
+	/* The second entry has an invalid update time, so it can't be parsed */
+	const gchar *response = "<?xml version='1.0' encoding='UTF-8'?>"
+				"<feed xmlns='http://www.w3.org/2005/Atom'>"
+					"<id>http://example.com/feed</id>"
+					"<updated>2009-08-20T10:00:00Z</updated>"
+					"<title type='text'>Malformed feed</title>"
+					"<entry>"
+						"<id>http://example.com/feed/entry/1</id>"
+						"<updated>2009-08-20T10:00:00Z</updated>"
+						"<title type='text'>Entry 1</title>"
+					"</entry>"
+					"<entry>"
+						"<id>http://example.com/feed/entry/2</id>"
+						"<updated>not a time</updated>"
+						"<title type='text'>Entry 2</title>"
+					"</entry>"
+					"<entry>"
+						"<id>http://example.com/feed/entry/3</id>"
+						"<updated>2009-08-20T10:00:00Z</updated>"
+						"<title type='text'>Entry 3</title>"
+					"</entry>"
+				"</feed>";
+
+	soup_message_set_status (message, SOUP_STATUS_OK);
+	soup_message_set_response (message, "application/atom+xml", SOUP_MEMORY_STATIC, response, strlen (response));
+}
+
+static void
+test_feed_entries_lazy_malformed (void)
+{
+	GDataService *service;
+	GDataQuery *query;
+	GDataFeed *feed;
+	TestServer test_server;
+	gchar *feed_uri;
+	GList *entries;
+	GError *error = NULL;
+
+	test_server_start (&test_server, (SoupServerCallback) malformed_feed_server_cb, NULL);
+	feed_uri = test_server_build_uri (&test_server, "/feed");
+	service = GDATA_SERVICE (gdata_contacts_service_new (CLIENT_ID));
+
+	query = gdata_query_new (NULL);
+	gdata_query_set_flags (query, GDATA_QUERY_FLAGS_LAZY_ENTRIES);
+
+	/* The malformed entry isn't parsed until it's accessed, so the query should succeed */
+	feed = gdata_service_query (service, feed_uri, query, GDATA_TYPE_ENTRY, NULL, NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+	g_assert_cmpuint (gdata_feed_get_n_entries (feed), ==, 3);
+
+	/* The malformed entry should be NULL every time it's accessed, without affecting the indices of the others */
+	g_assert (gdata_feed_get_entry_at (feed, 1) == NULL);
+	g_assert (gdata_feed_get_entry_at (feed, 1) == NULL);
+	g_assert (gdata_feed_look_up_entry (feed, "http://example.com/feed/entry/2") == NULL);
+	g_assert_cmpuint (gdata_feed_get_n_entries (feed), ==, 3);
+
+	g_assert_cmpstr (gdata_entry_get_id (gdata_feed_get_entry_at (feed, 0)), ==, "http://example.com/feed/entry/1");
+	g_assert_cmpstr (gdata_entry_get_id (gdata_feed_get_entry_at (feed, 2)), ==, "http://example.com/feed/entry/3");
+	g_assert (gdata_feed_look_up_entry (feed, "http://example.com/feed/entry/3") == gdata_feed_get_entry_at (feed, 2));
+
+	/* The list should leave it out */
+	entries = gdata_feed_get_entries (feed);
+	g_assert_cmpuint (g_list_length (entries), ==, 2);
+	g_assert (entries->data == gdata_feed_get_entry_at (feed, 0));
+	g_assert (entries->next->data == gdata_feed_get_entry_at (feed, 2));
+
+	g_object_unref (feed);
+	g_object_unref (query);
+	g_object_unref (service);
+	test_server_stop (&test_server);
+	g_free (feed_uri);
+}
+
+/* A single page of many entries, each with a variety of elements, including some libgdata doesn't understand */
+#define LARGE_FEED_N_ENTRIES 500
+
+static void
+large_feed_server_cb (SoupServer *server, SoupMessage *message, const char *path, GHashTable *query, SoupClientContext *client,
+		      gpointer user_data)
+{
+	GString *response;
+	guint i;
+
+	response = g_string_new ("<?xml version='1.0' encoding='UTF-8'?>"
+				 "<feed xmlns='http://www.w3.org/2005/Atom' xmlns:foo='http://example.com/foo'>"
+					"<id>http://example.com/feed</id>"
+					"<updated>2009-08-20T10:00:00Z</updated>"
+					"<title type='text'>Large feed</title>");
+
+	for (i = 1; i <= LARGE_FEED_N_ENTRIES; i++) {
+		g_string_append_printf (response, "<entry>"
+							"<id>http://example.com/feed/entry/%u</id>"
+							"<updated>2009-08-20T10:%02u:%02uZ</updated>"
+							"<title type='text'>Entry %u</title>"
+							"<content type='text'>Content of entry %u</content>"
+							"<category term='term%u' scheme='http://example.com/scheme' label='Label %u'/>"
+							"<link rel='alternate' type='text/html' href='http://example.com/entry/%u'/>"
+							"<author><name>Author %u</name><email>author%u@example.com</email></author>"
+							"<foo:bar foo:baz='%u'>Unknown element %u</foo:bar>"
+						  "</entry>", i, (i / 60) % 60, i % 60, i, i, i % 7, i % 7, i, i % 11, i % 11, i, i);
+	}
+
+	g_string_append (response, "</feed>");
+
+	soup_message_set_status (message, SOUP_STATUS_OK);
+	soup_message_set_response (message, "application/atom+xml", SOUP_MEMORY_TAKE, response->str, response->len);
+	g_string_free (response, FALSE);
+}
+
+static GDataFeed *
+query_large_feed (GDataService *service, const gchar *feed_uri, GDataQueryFlags flags, GDataQueryProgressCallback progress_callback,
+		  gpointer progress_user_data)
+{
+	GDataQuery *query;
+	GDataFeed *feed;
+	GError *error = NULL;
+
+	query = gdata_query_new (NULL);
+	gdata_query_set_flags (query, flags);
+
+	feed = gdata_service_query (service, feed_uri, query, GDATA_TYPE_ENTRY, NULL, progress_callback, progress_user_data, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+	g_assert_cmpuint (gdata_feed_get_n_entries (feed), ==, LARGE_FEED_N_ENTRIES);
+
+	g_object_unref (query);
+
+	return feed;
+}
+
+static void
+parallel_entries_progress_cb (GDataEntry *entry, guint entry_key, guint entry_count, gboolean *seen_keys)
+{
+	gchar *id;
+
+	/* Each entry should be reported once, with the key of its position in the feed */
+	g_assert_cmpuint (entry_key, <, LARGE_FEED_N_ENTRIES);
+	g_assert (seen_keys[entry_key] == FALSE);
+	seen_keys[entry_key] = TRUE;
+
+	id = g_strdup_printf ("http://example.com/feed/entry/%u", entry_key + 1);
+	g_assert_cmpstr (gdata_entry_get_id (entry), ==, id);
+	g_free (id);
+}
+
+static void
+test_feed_entries_parallel (void)
+{
+	GDataService *service;
+	GDataFeed *serial_feed, *parallel_feed;
+	TestServer test_server;
+	gchar *feed_uri;
+	gboolean seen_keys[LARGE_FEED_N_ENTRIES] = { FALSE, };
+	guint i;
+
+	test_server_start (&test_server, (SoupServerCallback) large_feed_server_cb, NULL);
+	feed_uri = test_server_build_uri (&test_server, "/feed");
+	service = GDATA_SERVICE (gdata_contacts_service_new (CLIENT_ID));
+
+	serial_feed = query_large_feed (service, feed_uri, GDATA_QUERY_FLAGS_NONE, NULL, NULL);
+	parallel_feed = query_large_feed (service, feed_uri, GDATA_QUERY_FLAGS_PARALLEL_ENTRIES | GDATA_QUERY_FLAGS_SYNCHRONOUS_PROGRESS,
+					  (GDataQueryProgressCallback) parallel_entries_progress_cb, seen_keys);
+
+	/* Every entry should have been reported */
+	for (i = 0; i < LARGE_FEED_N_ENTRIES; i++)
+		g_assert (seen_keys[i] == TRUE);
+
+	/* The entries should be in the same order, with the same contents, as when they're built one after another */
+	for (i = 0; i < LARGE_FEED_N_ENTRIES; i++) {
+		GDataEntry *serial_entry, *parallel_entry;
+		gchar *serial_xml, *parallel_xml;
+
+		serial_entry = gdata_feed_get_entry_at (serial_feed, i);
+		parallel_entry = gdata_feed_get_entry_at (parallel_feed, i);
+		g_assert (GDATA_IS_ENTRY (parallel_entry));
+
+		serial_xml = gdata_entry_get_xml (serial_entry);
+		parallel_xml = gdata_entry_get_xml (parallel_entry);
+		g_assert_cmpstr (parallel_xml, ==, serial_xml);
+		g_free (serial_xml);
+		g_free (parallel_xml);
+	}
+
+	g_object_unref (parallel_feed);
+	g_object_unref (serial_feed);
+	g_object_unref (service);
+	test_server_stop (&test_server);
+	g_free (feed_uri);
+}
+
+static void
+test_feed_unknown_xml (void)
+{
+	GDataService *service;
+	GDataFeed *feed, *deferred_feed, *dropped_feed;
+	TestServer test_server;
+	gchar *feed_uri, *xml, *deferred_xml, *dropped_xml;
+	guint i;
+
+	test_server_start (&test_server, (SoupServerCallback) large_feed_server_cb, NULL);
+	feed_uri = test_server_build_uri (&test_server, "/feed");
+	service = GDATA_SERVICE (gdata_contacts_service_new (CLIENT_ID));
+
+	feed = query_large_feed (service, feed_uri, GDATA_QUERY_FLAGS_NONE, NULL, NULL);
+	deferred_feed = query_large_feed (service, feed_uri, GDATA_QUERY_FLAGS_DEFER_UNKNOWN_XML, NULL, NULL);
+	dropped_feed = query_large_feed (service, feed_uri, GDATA_QUERY_FLAGS_DROP_UNKNOWN_XML | GDATA_QUERY_FLAGS_DEFER_UNKNOWN_XML, NULL, NULL);
+
+	for (i = 0; i < LARGE_FEED_N_ENTRIES; i++) {
+		xml = gdata_entry_get_xml (gdata_feed_get_entry_at (feed, i));
+		deferred_xml = gdata_entry_get_xml (gdata_feed_get_entry_at (deferred_feed, i));
+		dropped_xml = gdata_entry_get_xml (gdata_feed_get_entry_at (dropped_feed, i));
+
+		/* Deferred unknown elements should still be output, just as if they'd been serialised while parsing */
+		g_assert (strstr (xml, "Unknown element") != NULL);
+		g_assert (strstr (xml, "http://example.com/foo") != NULL);
+		g_assert_cmpstr (deferred_xml, ==, xml);
+
+		/* Dropped ones shouldn't, but the elements libgdata understands should be unaffected */
+		g_assert (strstr (dropped_xml, "Unknown element") == NULL);
+		g_assert (strstr (dropped_xml, "http://example.com/foo") == NULL);
+		g_assert (strstr (dropped_xml, "Content of entry") != NULL);
+		g_assert_cmpstr (gdata_entry_get_id (gdata_feed_get_entry_at (dropped_feed, i)),
+				 ==, gdata_entry_get_id (gdata_feed_get_entry_at (feed, i)));
+
+		g_free (xml);
+		g_free (deferred_xml);
+		g_free (dropped_xml);
+	}
+
+	g_object_unref (dropped_feed);
+	g_object_unref (deferred_feed);
+	g_object_unref (feed);
+	g_object_unref (service);
+	test_server_stop (&test_server);
+	g_free (feed_uri);
+}
+
+static void
+test_entry_look_up_link (void)
+{
+	GDataEntry *entry;
+	GDataLink *link, *new_link;
+	GList *links;
+	GError *error = NULL;
+
+	entry = gdata_entry_new_from_xml (
+		"<entry xmlns='http://www.w3.org/2005/Atom'>"
+			"<title type='text'>Testing links</title>"
+			"<updated>2009-01-25T14:07:37.880860Z</updated>"
+			"<link rel='alternate' href='http://example.com/'/>"
+			"<link rel='self' href='http://example.com/entry'/>"
+			"<link rel='alternate' hreflang='de' href='http://example.com/de/'/>"
+		 "</entry>", -1, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (entry));
+
+	/* Links with the same rel should be returned in document order */
+	links = gdata_entry_look_up_links (entry, "alternate");
+	g_assert_cmpuint (g_list_length (links), ==, 2);
+	g_assert_cmpstr (((GDataLink*) links->data)->href, ==, "http://example.com/");
+	g_assert_cmpstr (((GDataLink*) links->next->data)->href, ==, "http://example.com/de/");
+	g_assert (gdata_entry_look_up_link (entry, "alternate") == links->data);
+	g_list_free (links);
+
+	link = gdata_entry_look_up_link (entry, "self");
+	g_assert (link != NULL);
+	g_assert_cmpstr (link->href, ==, "http://example.com/entry");
+
+	/* Adding a link should invalidate the index built by the lookups above */
+	g_assert (gdata_entry_look_up_link (entry, "related") == NULL);
+	g_assert (gdata_entry_look_up_links (entry, "related") == NULL);
+
+	new_link = gdata_link_new ("http://example.com/related", "related", NULL, NULL, NULL, -1);
+	gdata_entry_add_link (entry, new_link);
+	g_assert (gdata_entry_look_up_link (entry, "related") == new_link);
+
+	/* New links are added to the start of the list, so should be returned before existing links with the same rel */
+	new_link = gdata_link_new ("http://example.com/fr/", "alternate", NULL, "fr", NULL, -1);
+	gdata_entry_add_link (entry, new_link);
+	g_assert (gdata_entry_look_up_link (entry, "alternate") == new_link);
+
+	links = gdata_entry_look_up_links (entry, "alternate");
+	g_assert_cmpuint (g_list_length (links), ==, 3);
+	g_assert (links->data == new_link);
+	g_assert_cmpstr (((GDataLink*) links->next->data)->href, ==, "http://example.com/");
+	g_assert_cmpstr (((GDataLink*) links->next->next->data)->href, ==, "http://example.com/de/");
+	g_list_free (links);
+
+	/* Duplicate links aren't added, and shouldn't disturb the index */
+	gdata_entry_add_link (entry, gdata_link_new ("http://example.com/related", "related", NULL, NULL, NULL, -1));
+	links = gdata_entry_look_up_links (entry, "related");
+	g_assert_cmpuint (g_list_length (links), ==, 1);
+	g_list_free (links);
+
+	g_assert (gdata_entry_look_up_link (entry, "self") == link);
+
+	g_object_unref (entry);
+}
+
+static void
+test_feed_look_up_link (void)
+{
+	GDataService *service;
+	GDataFeed *feed;
+	GDataLink *link;
+	PagedFeedData data;
+	TestServer test_server;
+	GList *links;
+	GError *error = NULL;
+
+	paged_feed_start (&test_server, &data);
+	service = GDATA_SERVICE (gdata_contacts_service_new (CLIENT_ID));
+
+	feed = gdata_service_query (service, data.feed_uri, NULL, GDATA_TYPE_ENTRY, NULL, NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+
+	/* Links with the same rel should be returned in document order */
+	links = gdata_feed_look_up_links (feed, "alternate");
+	g_assert_cmpuint (g_list_length (links), ==, 2);
+	g_assert_cmpstr (((GDataLink*) links->data)->href, ==, "http://example.com/");
+	g_assert_cmpstr (((GDataLink*) links->next->data)->href, ==, "http://example.com/de/");
+	g_assert_cmpstr (((GDataLink*) links->next->data)->hreflang, ==, "de");
+	g_assert (gdata_feed_look_up_link (feed, "alternate") == links->data);
+	g_list_free (links);
+
+	link = gdata_feed_look_up_link (feed, "next");
+	g_assert (link != NULL);
+	g_assert (strstr (link->href, "start-index=11") != NULL);
+
+	link = gdata_feed_look_up_link (feed, "http://schemas.google.com/g/2005#feed");
+	g_assert (link != NULL);
+
+	g_assert (gdata_feed_look_up_link (feed, "previous") == NULL);
+	g_assert (gdata_feed_look_up_links (feed, "previous") == NULL);
+
+	g_object_unref (feed);
+	g_object_unref (service);
+	paged_feed_stop (&test_server, &data);
+}
+
+static void
+test_query_discard_entries (void)
+{
+	GDataService *service;
+	GDataQuery *query;
+	GDataFeed *feed;
+	PagedFeedData data;
+	QueryProgressData progress_data;
+	TestServer test_server;
+	gboolean seen_keys[PAGED_FEED_N_ENTRIES] = { FALSE, };
+	GList *links;
+	GError *error = NULL;
+
+	paged_feed_start (&test_server, &data);
+	service = GDATA_SERVICE (gdata_contacts_service_new (CLIENT_ID));
+	query = gdata_query_new (NULL);
+
+	progress_data.n_calls = 0;
+	progress_data.entry_count = 0;
+	progress_data.seen_keys = seen_keys;
+
+	/* With synchronous progress callbacks, the entries should all have been passed to the callback before the query returns, and then
+	 * dropped; the rest of the feed should be intact */
+	gdata_query_set_flags (query, GDATA_QUERY_FLAGS_DISCARD_ENTRIES | GDATA_QUERY_FLAGS_SYNCHRONOUS_PROGRESS);
+	feed = gdata_service_query (service, data.feed_uri, query, GDATA_TYPE_ENTRY, NULL,
+				    (GDataQueryProgressCallback) query_all_progress_cb, &progress_data, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+	g_assert_cmpuint (progress_data.n_calls, ==, PAGED_FEED_ITEMS_PER_PAGE);
+
+	g_assert_cmpuint (gdata_feed_get_n_entries (feed), ==, 0);
+	g_assert (gdata_feed_get_entries (feed) == NULL);
+	g_assert (gdata_feed_look_up_entry (feed, "http://example.com/feed/entry/1") == NULL);
+
+	g_assert_cmpstr (gdata_feed_get_id (feed), ==, "http://example.com/feed");
+	g_assert_cmpuint (gdata_feed_get_total_results (feed), ==, PAGED_FEED_N_ENTRIES);
+	g_assert_cmpuint (gdata_feed_get_items_per_page (feed), ==, PAGED_FEED_ITEMS_PER_PAGE);
+	g_assert (gdata_feed_look_up_link (feed, "next") != NULL);
+	links = gdata_feed_look_up_links (feed, "alternate");
+	g_assert_cmpuint (g_list_length (links), ==, 2);
+	g_list_free (links);
+
+	g_object_unref (feed);
+
+	/* Without a progress callback, the flag should have no effect */
+	feed = gdata_service_query (service, data.feed_uri, query, GDATA_TYPE_ENTRY, NULL, NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+	g_assert_cmpuint (gdata_feed_get_n_entries (feed), ==, PAGED_FEED_ITEMS_PER_PAGE);
+	assert_paged_feed_entry (gdata_feed_get_entry_at (feed, 0), 1);
+	g_object_unref (feed);
+
+	/* With asynchronous progress callbacks, the entries should be kept alive until they've been passed to the callback */
+	memset (seen_keys, 0, sizeof (seen_keys));
+	progress_data.n_calls = 0;
+
+	gdata_query_set_flags (query, GDATA_QUERY_FLAGS_DISCARD_ENTRIES);
+	feed = gdata_service_query (service, data.feed_uri, query, GDATA_TYPE_ENTRY, NULL,
+				    (GDataQueryProgressCallback) query_all_progress_cb, &progress_data, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+	g_assert_cmpuint (gdata_feed_get_n_entries (feed), ==, 0);
+	g_object_unref (feed);
+
+	while (g_main_context_iteration (NULL, FALSE) == TRUE);
+	g_assert_cmpuint (progress_data.n_calls, ==, PAGED_FEED_ITEMS_PER_PAGE);
+
+	/* Discarded entries should still be counted when deciding whether to fetch more pages of the feed */
+	memset (seen_keys, 0, sizeof (seen_keys));
+	progress_data.n_calls = 0;
+	data.n_requests = 0;
+
+	feed = gdata_service_query_all (service, data.feed_uri, query, GDATA_TYPE_ENTRY, 0, NULL,
+					(GDataQueryProgressCallback) query_all_progress_cb, &progress_data, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+	g_assert_cmpuint (data.n_requests, ==, 3);
+	g_assert_cmpuint (gdata_feed_get_n_entries (feed), ==, 0);
+	g_object_unref (feed);
+
+	while (g_main_context_iteration (NULL, FALSE) == TRUE);
+	g_assert_cmpuint (progress_data.n_calls, ==, PAGED_FEED_N_ENTRIES);
+
+	g_object_unref (query);
+	g_object_unref (service);
+	paged_feed_stop (&test_server, &data);
+}
+
+typedef struct {
+	GThread *thread;
+	guint n_calls;
+	guint n_entries;
+} IteratorProgressData;
+
+static void
+iterator_batch_progress_cb (GDataEntry **entries, const guint *entry_keys, guint n_entries, guint entry_count, IteratorProgressData *data)
+{
+	guint i;
+
+	/* The callbacks for every page should be called in the thread which started the iteration, in order */
+	g_assert (g_thread_self () == data->thread);
+
+	for (i = 0; i < n_entries; i++)
+		assert_paged_feed_entry (entries[i], ++data->n_entries);
+	data->n_calls++;
+}
+
+static void
+test_feed_iterator (gconstpointer prefetch_depth)
+{
+	GDataService *service;
+	GDataQuery *query;
+	GDataFeedIterator *iterator;
+	GDataEntry *entry;
+	PagedFeedData data;
+	IteratorProgressData progress_data;
+	TestServer test_server;
+	guint i;
+	GError *error = NULL;
+
+	paged_feed_start (&test_server, &data);
+	service = GDATA_SERVICE (gdata_contacts_service_new (CLIENT_ID));
+
+	progress_data.thread = g_thread_self ();
+	progress_data.n_calls = 0;
+	progress_data.n_entries = 0;
+
+	query = gdata_query_new (NULL);
+	gdata_query_set_batch_progress_callback (query, (GDataQueryBatchProgressCallback) iterator_batch_progress_cb, &progress_data);
+
+	iterator = gdata_feed_iterator_new (service, data.feed_uri, query, GDATA_TYPE_ENTRY, GPOINTER_TO_UINT (prefetch_depth));
+	g_assert (GDATA_IS_FEED_ITERATOR (iterator));
+	g_assert_cmpuint (data.n_requests, ==, 0);
+
+	/* Every entry on every page should be returned in order, with each page being requested once */
+	for (i = 1; i <= PAGED_FEED_N_ENTRIES; i++) {
+		entry = gdata_feed_iterator_next (iterator, NULL, &error);
+		g_assert_no_error (error);
+		assert_paged_feed_entry (entry, i);
+		g_object_unref (entry);
+	}
+
+	g_assert (gdata_feed_iterator_next (iterator, NULL, &error) == NULL);
+	g_assert_no_error (error);
+	g_assert (gdata_feed_iterator_next (iterator, NULL, &error) == NULL);
+	g_assert_no_error (error);
+	g_assert_cmpuint (data.n_requests, ==, 3);
+
+	/* The batch progress callbacks for all the pages, including those requested from the I/O thread, should be waiting in this thread's
+	 * main context */
+	while (g_main_context_iteration (NULL, FALSE) == TRUE);
+	g_assert_cmpuint (progress_data.n_entries, ==, PAGED_FEED_N_ENTRIES);
+	g_assert_cmpuint (progress_data.n_calls, >=, 3);
+
+	g_object_unref (iterator);
+	g_object_unref (query);
+	g_object_unref (service);
+	paged_feed_stop (&test_server, &data);
+}
+
+typedef struct {
+	GMainLoop *loop;
+	guint n_entries;
+	GError *error;
+} IteratorAsyncData;
+
+static void
+iterator_next_cb (GDataFeedIterator *iterator, GAsyncResult *async_result, IteratorAsyncData *data)
+{
+	GDataEntry *entry;
+
+	entry = gdata_feed_iterator_next_finish (iterator, async_result, &(data->error));
+
+	if (entry == NULL) {
+		g_main_loop_quit (data->loop);
+		return;
+	}
+
+	assert_paged_feed_entry (entry, ++data->n_entries);
+	g_object_unref (entry);
+
+	gdata_feed_iterator_next_async (iterator, NULL, (GAsyncReadyCallback) iterator_next_cb, data);
+}
+
+static void
+test_feed_iterator_async (void)
+{
+	GDataService *service;
+	GDataFeedIterator *iterator;
+	PagedFeedData data;
+	IteratorAsyncData async_data;
+	TestServer test_server;
+
+	paged_feed_start (&test_server, &data);
+	service = GDATA_SERVICE (gdata_contacts_service_new (CLIENT_ID));
+
+	async_data.loop = g_main_loop_new (NULL, FALSE);
+	async_data.n_entries = 0;
+	async_data.error = NULL;
+
+	iterator = gdata_feed_iterator_new (service, data.feed_uri, NULL, GDATA_TYPE_ENTRY, 1);
+	gdata_feed_iterator_next_async (iterator, NULL, (GAsyncReadyCallback) iterator_next_cb, &async_data);
+	g_main_loop_run (async_data.loop);
+
+	g_assert_no_error (async_data.error);
+	g_assert_cmpuint (async_data.n_entries, ==, PAGED_FEED_N_ENTRIES);
+	g_assert_cmpuint (data.n_requests, ==, 3);
+
+	g_main_loop_unref (async_data.loop);
+	g_object_unref (iterator);
+	g_object_unref (service);
+	paged_feed_stop (&test_server, &data);
+}
+
+static void
+test_feed_iterator_invalid_uri (void)
+{
+	GDataService *service;
+	GDataFeedIterator *iterator;
+	GError *error = NULL;
+
+	service = GDATA_SERVICE (gdata_contacts_service_new (CLIENT_ID));
+
+	/* Page URIs which can't be parsed should fail the page, rather than the request being sent */
+	iterator = gdata_feed_iterator_new (service, "not a URI", NULL, GDATA_TYPE_ENTRY, 0);
+	g_assert (gdata_feed_iterator_next (iterator, NULL, &error) == NULL);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);
+	g_clear_error (&error);
+
+	g_object_unref (iterator);
+	g_object_unref (service);
+}
+
 int
 main (int argc, char *argv[])
 {
 	g_type_init ();
+	g_thread_init (NULL);
 	g_test_init (&argc, &argv, NULL);
 	g_test_bug_base ("http://bugzilla.gnome.org/show_bug.cgi?id=");
 
 	g_test_add_func ("/entry/get_xml", test_entry_get_xml);
 	g_test_add_func ("/entry/parse_xml", test_entry_parse_xml);
+	g_test_add_func ("/entry/struct_strings", test_entry_struct_strings);
 	g_test_add_func ("/query/categories", test_query_categories);
 	g_test_add_func ("/color/parsing", test_color_parsing);
 	g_test_add_func ("/color/output", test_color_output);
 	g_test_add_data_func ("/media/thumbnail/parse_time", "", test_media_thumbnail_parse_time);
 	g_test_add_data_func ("/media/thumbnail/parse_time", "de_DE", test_media_thumbnail_parse_time);
+	g_test_add_func ("/parser/iso8601", test_parser_iso8601);
+	g_test_add_func ("/parser/iso8601/repeated", test_parser_iso8601_repeated);
+	g_test_add_func ("/parser/date", test_parser_date);
+	g_test_add_func ("/parser/date/output", test_parser_date_output);
+	g_test_add_func ("/batch", test_batch);
+	g_test_add_func ("/service/query_all", test_query_all);
+	g_test_add_func ("/service/max_operations", test_service_max_operations);
+	g_test_add_func ("/service/cache", test_service_cache);
+	g_test_add_data_func ("/feed/entries", GUINT_TO_POINTER (GDATA_QUERY_FLAGS_NONE), test_feed_entries);
+	g_test_add_data_func ("/feed/entries/lazy", GUINT_TO_POINTER (GDATA_QUERY_FLAGS_LAZY_ENTRIES), test_feed_entries);
+	g_test_add_func ("/feed/entries/lazy/malformed", test_feed_entries_lazy_malformed);
+	g_test_add_func ("/feed/entries/parallel", test_feed_entries_parallel);
+	g_test_add_func ("/feed/unknown_xml", test_feed_unknown_xml);
+	g_test_add_data_func ("/feed/look_up_entry", GUINT_TO_POINTER (GDATA_QUERY_FLAGS_NONE), test_feed_look_up_entry);
+	g_test_add_data_func ("/feed/look_up_entry/lazy", GUINT_TO_POINTER (GDATA_QUERY_FLAGS_LAZY_ENTRIES), test_feed_look_up_entry);
+	g_test_add_func ("/entry/look_up_link", test_entry_look_up_link);
+	g_test_add_func ("/feed/look_up_link", test_feed_look_up_link);
+	g_test_add_func ("/query/discard_entries", test_query_discard_entries);
+	g_test_add_data_func ("/feed_iterator/next", GUINT_TO_POINTER (0), test_feed_iterator);
+	g_test_add_data_func ("/feed_iterator/next/prefetch", GUINT_TO_POINTER (2), test_feed_iterator);
+	g_test_add_func ("/feed_iterator/next_async", test_feed_iterator_async);
+	g_test_add_func ("/feed_iterator/invalid_uri", test_feed_iterator_invalid_uri);
 
 	return g_test_run ();
 }
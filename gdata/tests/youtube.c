@@ -19,6 +19,9 @@
 
 #include <glib.h>
 #include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <libsoup/soup.h>
 
 #include "gdata.h"
 #include "common.h"
@@ -319,6 +322,631 @@ test_upload_simple (void)
 	g_object_unref (video_file);
 }
 
+static void
+test_upload_async_progress_cb (GDataYouTubeService *youtube_service, GDataYouTubeVideo *video, guint64 bytes_sent, guint64 total_bytes,
+			       gdouble bytes_per_second, guint64 *last_bytes_sent)
+{
+	g_assert (GDATA_IS_YOUTUBE_VIDEO (video));
+	g_assert_cmpuint (bytes_sent, >=, *last_bytes_sent);
+	g_assert_cmpuint (bytes_sent, <=, total_bytes);
+	g_assert_cmpfloat (bytes_per_second, >=, 0.0);
+
+	*last_bytes_sent = bytes_sent;
+}
+
+static void
+test_upload_async_cb (GDataService *service, GAsyncResult *async_result, gpointer user_data)
+{
+	GDataYouTubeVideo *new_video;
+	GError *error = NULL;
+
+	new_video = gdata_youtube_service_upload_video_finish (GDATA_YOUTUBE_SERVICE (service), async_result, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_YOUTUBE_VIDEO (new_video));
+	g_clear_error (&error);
+
+	g_main_loop_quit (main_loop);
+
+	g_object_unref (new_video);
+}
+
+static void
+test_upload_async (void)
+{
+	GDataYouTubeVideo *video;
+	GDataMediaCategory *category;
+	GFile *video_file;
+	guint64 last_bytes_sent = 0;
+	gulong progress_signal;
+
+	g_assert (service != NULL);
+
+	video = gdata_youtube_video_new (NULL);
+
+	gdata_entry_set_title (GDATA_ENTRY (video), "Bad Wedding Toast");
+	gdata_youtube_video_set_title (video, "Bad Wedding Toast");
+	gdata_youtube_video_set_description (video, "I gave a bad toast at my friend's wedding.");
+	category = gdata_media_category_new ("People", NULL, "http://gdata.youtube.com/schemas/2007/categories.cat");
+	gdata_youtube_video_set_category (video, category);
+	gdata_youtube_video_set_keywords (video, "toast, wedding");
+
+	video_file = g_file_new_for_path (TEST_FILE_DIR "sample.ogg");
+
+	/* Upload the video, checking the progress is reported in order */
+	progress_signal = g_signal_connect (service, "upload-progress", (GCallback) test_upload_async_progress_cb, &last_bytes_sent);
+	gdata_youtube_service_upload_video_async (GDATA_YOUTUBE_SERVICE (service), video, video_file, NULL,
+						  (GAsyncReadyCallback) test_upload_async_cb, NULL);
+	g_object_unref (video);
+	g_object_unref (video_file);
+
+	main_loop = g_main_loop_new (NULL, TRUE);
+	g_main_loop_run (main_loop);
+	g_main_loop_unref (main_loop);
+
+	/* Progress should have been reported before the upload finished */
+	g_assert_cmpuint (last_bytes_sent, >, 0);
+	g_signal_handler_disconnect (service, progress_signal);
+}
+
+typedef struct {
+	GString *received;
+	guint n_chunks;
+} ResumableServerData;
+
+static void
+resumable_server_cb (SoupServer *server, SoupMessage *message, const char *path, GHashTable *query, SoupClientContext *client,
+		     ResumableServerData *data)
+{
+	const gchar *content_range;
+	gint64 start, end, total;
+	gsize length;
+	gchar *range;
+	const gchar *uploaded_video_xml =
+		"<entry xmlns='http://www.w3.org/2005/Atom' "
+			"xmlns:media='http://search.yahoo.com/mrss/' "
+			"xmlns:yt='http://gdata.youtube.com/schemas/2007'>"
+			"<id>tag:youtube.com,2008:video:ResumableUp</id>"
+			"<updated>2009-03-23T12:46:58.000Z</updated>"
+			"<title>Resumable upload</title>"
+		"</entry>";
+
+	content_range = soup_message_headers_get_one (message->request_headers, "Content-Range");
+	g_assert (content_range != NULL);
+
+	if (sscanf (content_range, "bytes %" G_GINT64_FORMAT "-%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT, &start, &end, &total) == 3) {
+		/* Chunks must carry on from (or overlap) what's been committed */
+		g_assert_cmpint (start, <=, data->received->len);
+		g_assert_cmpint (end - start + 1, ==, message->request_body->length);
+		length = end + 1 - data->received->len;
+
+		/* Only commit half of every third chunk, and fail the request, as if the connection had dropped part-way through it */
+		if (++data->n_chunks % 3 == 0) {
+			g_string_append_len (data->received, message->request_body->data + (data->received->len - start), length / 2);
+			soup_message_set_status (message, SOUP_STATUS_SERVICE_UNAVAILABLE);
+			return;
+		}
+
+		g_string_append_len (data->received, message->request_body->data + (data->received->len - start), length);
+	} else {
+		/* It's a query for the committed offset */
+		g_assert (sscanf (content_range, "bytes */%" G_GINT64_FORMAT, &total) == 1);
+	}
+
+	if (data->received->len == total) {
+		soup_message_set_status (message, SOUP_STATUS_CREATED);
+		soup_message_set_response (message, "application/atom+xml", SOUP_MEMORY_STATIC, uploaded_video_xml, strlen (uploaded_video_xml));
+		return;
+	}
+
+	/* 308 Resume Incomplete */
+	soup_message_set_status_full (message, 308, "Resume Incomplete");
+	if (data->received->len > 0) {
+		range = g_strdup_printf ("bytes=0-%" G_GSIZE_FORMAT, data->received->len - 1);
+		soup_message_headers_append (message->response_headers, "Range", range);
+		g_free (range);
+	}
+}
+
+static gpointer
+server_thread_func (GMainLoop *loop)
+{
+	g_main_loop_run (loop);
+	return NULL;
+}
+
+/* A stand-in for the YouTube servers, run in another thread. Services are pointed at it by using it as their proxy, so it's sent the requests
+ * for the real servers' URIs; StandInService authenticates over HTTP, so that its authentication request can be proxied too. */
+typedef struct {
+	GMainContext *context;
+	GMainLoop *loop;
+	GThread *thread;
+	SoupServer *server;
+	volatile gint n_uploads;
+	GString *video; /* the video from the last upload */
+} UploadServer;
+
+/* The end of the multipart/related body of an upload */
+#define UPLOAD_FOOTER "\n--0xdeadbeef6e0808d5e6ed8bc168390bcc--"
+
+typedef GDataYouTubeService StandInService;
+typedef GDataYouTubeServiceClass StandInServiceClass;
+
+static GType stand_in_service_get_type (void) G_GNUC_CONST;
+G_DEFINE_TYPE (StandInService, stand_in_service, GDATA_TYPE_YOUTUBE_SERVICE)
+
+static void
+stand_in_service_class_init (StandInServiceClass *klass)
+{
+	GDATA_SERVICE_CLASS (klass)->authentication_uri = "http://www.google.com/youtube/accounts/ClientLogin";
+}
+
+static void
+stand_in_service_init (StandInService *self)
+{
+	/* Nothing to see here */
+}
+
+static void
+upload_server_cb (SoupServer *server, SoupMessage *message, const char *path, GHashTable *query, SoupClientContext *client,
+		  UploadServer *data)
+{
+	const gchar *response, *video_start, *video_end;
+
+	g_assert (message->method == SOUP_METHOD_POST);
+
+	if (strcmp (path, "/youtube/accounts/ClientLogin") == 0) {
+		response = "SID=sid\nLSID=lsid\nAuth=auth\nYouTubeUser=" YT_USERNAME "\n";
+		soup_message_set_status (message, SOUP_STATUS_OK);
+		soup_message_set_response (message, "text/plain", SOUP_MEMORY_STATIC, response, strlen (response));
+		return;
+	}
+
+	/* The whole body has been received by now */
+	g_assert_cmpstr (path, ==, "/feeds/api/users/" YT_USERNAME "/uploads");
+	g_assert_cmpint (soup_message_headers_get_content_length (message->request_headers), ==, message->request_body->length);
+
+	/* Keep the video part of the body, which comes after the entry part and the video part's headers, and before the footer */
+	video_start = g_strstr_len (message->request_body->data, message->request_body->length, "Content-Transfer-Encoding: binary\n\n");
+	g_assert (video_start != NULL);
+	video_start += strlen ("Content-Transfer-Encoding: binary\n\n");
+	video_end = message->request_body->data + message->request_body->length - strlen (UPLOAD_FOOTER);
+	g_assert_cmpint (video_end - video_start, >=, 0);
+	g_assert (memcmp (video_end, UPLOAD_FOOTER, strlen (UPLOAD_FOOTER)) == 0);
+	g_string_truncate (data->video, 0);
+	g_string_append_len (data->video, video_start, video_end - video_start);
+
+	g_atomic_int_inc (&(data->n_uploads));
+
+	response = "<entry xmlns='http://www.w3.org/2005/Atom' "
+			"xmlns:media='http://search.yahoo.com/mrss/' "
+			"xmlns:yt='http://gdata.youtube.com/schemas/2007'>"
+			"<id>tag:youtube.com,2008:video:StandInUp</id>"
+			"<updated>2009-03-23T12:46:58.000Z</updated>"
+			"<title>Stand-in upload</title>"
+		   "</entry>";
+	soup_message_set_status (message, SOUP_STATUS_CREATED);
+	soup_message_set_response (message, "application/atom+xml", SOUP_MEMORY_STATIC, response, strlen (response));
+}
+
+/* Start the stand-in server, and return an authenticated service which sends all its requests to it */
+static GDataService *
+upload_server_start (UploadServer *data)
+{
+	GDataService *local_service;
+	SoupURI *proxy_uri;
+	gchar *uri;
+	GError *error = NULL;
+
+	data->n_uploads = 0;
+	data->video = g_string_new (NULL);
+
+	data->context = g_main_context_new ();
+	data->server = soup_server_new (SOUP_SERVER_PORT, 0, SOUP_SERVER_ASYNC_CONTEXT, data->context, NULL);
+	soup_server_add_handler (data->server, NULL, (SoupServerCallback) upload_server_cb, data, NULL);
+	soup_server_run_async (data->server);
+
+	data->loop = g_main_loop_new (data->context, FALSE);
+	data->thread = g_thread_create ((GThreadFunc) server_thread_func, data->loop, TRUE, NULL);
+
+	local_service = g_object_new (stand_in_service_get_type (), "developer-key", DEVELOPER_KEY, "client-id", CLIENT_ID, NULL);
+
+	uri = g_strdup_printf ("http://127.0.0.1:%u/", soup_server_get_port (data->server));
+	proxy_uri = soup_uri_new (uri);
+	gdata_service_set_proxy_uri (local_service, proxy_uri);
+	soup_uri_free (proxy_uri);
+	g_free (uri);
+
+	g_assert (gdata_service_authenticate (local_service, YT_USERNAME, YT_PASSWORD, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+
+	return local_service;
+}
+
+static void
+upload_server_stop (UploadServer *data)
+{
+	g_main_loop_quit (data->loop);
+	g_thread_join (data->thread);
+	g_main_loop_unref (data->loop);
+	soup_server_quit (data->server);
+	g_object_unref (data->server);
+	g_main_context_unref (data->context);
+	g_string_free (data->video, TRUE);
+}
+
+static GDataYouTubeVideo *
+build_upload_video (void)
+{
+	GDataYouTubeVideo *video;
+	GDataMediaCategory *category;
+
+	video = gdata_youtube_video_new (NULL);
+
+	gdata_entry_set_title (GDATA_ENTRY (video), "Bad Wedding Toast");
+	gdata_youtube_video_set_title (video, "Bad Wedding Toast");
+	gdata_youtube_video_set_description (video, "I gave a bad toast at my friend's wedding.");
+	category = gdata_media_category_new ("People", NULL, "http://gdata.youtube.com/schemas/2007/categories.cat");
+	gdata_youtube_video_set_category (video, category);
+	gdata_youtube_video_set_keywords (video, "toast, wedding");
+
+	return video;
+}
+
+typedef struct {
+	gboolean mapped;
+	gboolean asynchronous;
+} UploadFileTest;
+
+static const UploadFileTest upload_file_tests[] = {
+	{ TRUE, FALSE },
+	{ TRUE, TRUE },
+	{ FALSE, FALSE },
+	{ FALSE, TRUE }
+};
+
+static void
+test_upload_file_cb (GDataService *local_service, GAsyncResult *async_result, GDataYouTubeVideo **new_video)
+{
+	GError *error = NULL;
+
+	*new_video = gdata_youtube_service_upload_video_finish (GDATA_YOUTUBE_SERVICE (local_service), async_result, &error);
+	g_assert_no_error (error);
+
+	g_main_loop_quit (main_loop);
+}
+
+static void
+test_upload_file (gconstpointer test_data)
+{
+	const UploadFileTest *test = test_data;
+	GDataService *local_service;
+	GDataYouTubeVideo *video, *new_video = NULL;
+	GFile *sample_file, *video_file;
+	UploadServer server_data;
+	gchar *contents;
+	gsize length;
+	GError *error = NULL;
+
+	local_service = upload_server_start (&server_data);
+
+	/* Local files are mapped, and their chunks sent straight from the mapping; others are read a chunk at a time */
+	sample_file = g_file_new_for_path (TEST_FILE_DIR "sample.ogg");
+	video_file = (test->mapped == TRUE) ? g_object_ref (sample_file) : unmappable_file_new (sample_file);
+	video = build_upload_video ();
+
+	if (test->asynchronous == TRUE) {
+		gdata_youtube_service_upload_video_async (GDATA_YOUTUBE_SERVICE (local_service), video, video_file, NULL,
+							  (GAsyncReadyCallback) test_upload_file_cb, &new_video);
+
+		main_loop = g_main_loop_new (NULL, TRUE);
+		g_main_loop_run (main_loop);
+		g_main_loop_unref (main_loop);
+	} else {
+		new_video = gdata_youtube_service_upload_video (GDATA_YOUTUBE_SERVICE (local_service), video, video_file, NULL, &error);
+		g_assert_no_error (error);
+	}
+
+	g_assert (GDATA_IS_YOUTUBE_VIDEO (new_video));
+	g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (new_video)), ==, "tag:youtube.com,2008:video:StandInUp");
+	g_assert_cmpint (g_atomic_int_get (&(server_data.n_uploads)), ==, 1);
+
+	/* The server should have received the whole video, intact; it's more than one chunk long */
+	g_assert (g_file_load_contents (sample_file, NULL, &contents, &length, NULL, NULL) == TRUE);
+	g_assert_cmpuint (length, >, 64 * 1024);
+	g_assert_cmpuint (server_data.video->len, ==, length);
+	g_assert (memcmp (server_data.video->str, contents, length) == 0);
+	g_free (contents);
+
+	g_object_unref (new_video);
+	g_object_unref (video);
+	g_object_unref (video_file);
+	g_object_unref (sample_file);
+	g_object_unref (local_service);
+	upload_server_stop (&server_data);
+}
+
+typedef struct {
+	GString *order;
+	guint n_left;
+	GMainLoop *loop;
+} UploadQueueData;
+
+static void
+test_upload_queue_cb (GDataYouTubeUploadQueue *queue, GAsyncResult *async_result, gchar *name)
+{
+	UploadQueueData *data = g_object_get_data (G_OBJECT (queue), "test-data");
+	GDataYouTubeVideo *new_video;
+	GError *error = NULL;
+
+	/* Uploads whose names are in upper case have been cancelled */
+	new_video = gdata_youtube_upload_queue_add_finish (queue, async_result, &error);
+	if (g_ascii_isupper (*name) == TRUE) {
+		g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+		g_assert (new_video == NULL);
+	} else {
+		g_assert_no_error (error);
+		g_assert (GDATA_IS_YOUTUBE_VIDEO (new_video));
+		g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (new_video)), ==, "tag:youtube.com,2008:video:StandInUp");
+		g_object_unref (new_video);
+	}
+	g_clear_error (&error);
+
+	/* Only one upload should ever be running */
+	g_assert_cmpuint (gdata_youtube_upload_queue_get_n_running (queue), <=, 1);
+
+	g_string_append (data->order, name);
+	if (--data->n_left == 0)
+		g_main_loop_quit (data->loop);
+}
+
+static void
+test_upload_queue (void)
+{
+	GDataService *local_service;
+	GDataYouTubeUploadQueue *queue;
+	GDataYouTubeVideo *video;
+	GFile *video_file;
+	GTimeVal soon, later;
+	UploadServer server_data;
+	UploadQueueData data;
+
+	local_service = upload_server_start (&server_data);
+
+	/* Limit the queue to one upload at a time */
+	queue = gdata_youtube_upload_queue_new (GDATA_YOUTUBE_SERVICE (local_service), 1, 0);
+	g_assert (gdata_youtube_upload_queue_get_service (queue) == GDATA_YOUTUBE_SERVICE (local_service));
+	g_assert_cmpuint (gdata_youtube_upload_queue_get_max_uploads (queue), ==, 1);
+	g_assert_cmpuint (gdata_youtube_upload_queue_get_max_bytes_per_second (queue), ==, 0);
+
+	data.order = g_string_new (NULL);
+	data.n_left = 6;
+	data.loop = g_main_loop_new (NULL, FALSE);
+	g_object_set_data (G_OBJECT (queue), "test-data", &data);
+
+	video = build_upload_video ();
+	video_file = g_file_new_for_path (TEST_FILE_DIR "sample.ogg");
+
+	soon.tv_sec = 1000;
+	soon.tv_usec = 0;
+	later.tv_sec = 1000;
+	later.tv_usec = 1;
+
+	/* The first upload starts straight away. The rest should be started in order of priority, then deadline (with uploads which have
+	 * deadlines ahead of those which don't), then the order they were added in. */
+	gdata_youtube_upload_queue_add (queue, video, video_file, G_PRIORITY_DEFAULT, NULL, NULL, (GAsyncReadyCallback) test_upload_queue_cb, "a");
+	gdata_youtube_upload_queue_add (queue, video, video_file, G_PRIORITY_LOW, NULL, NULL, (GAsyncReadyCallback) test_upload_queue_cb, "f");
+	gdata_youtube_upload_queue_add (queue, video, video_file, G_PRIORITY_DEFAULT, NULL, NULL, (GAsyncReadyCallback) test_upload_queue_cb, "e");
+	gdata_youtube_upload_queue_add (queue, video, video_file, G_PRIORITY_DEFAULT, &later, NULL, (GAsyncReadyCallback) test_upload_queue_cb, "d");
+	gdata_youtube_upload_queue_add (queue, video, video_file, G_PRIORITY_DEFAULT, &soon, NULL, (GAsyncReadyCallback) test_upload_queue_cb, "c");
+	gdata_youtube_upload_queue_add (queue, video, video_file, G_PRIORITY_HIGH, &later, NULL, (GAsyncReadyCallback) test_upload_queue_cb, "b");
+	g_object_unref (video);
+	g_object_unref (video_file);
+
+	g_assert_cmpuint (gdata_youtube_upload_queue_get_n_running (queue), ==, 1);
+	g_assert_cmpuint (gdata_youtube_upload_queue_get_n_pending (queue), ==, 5);
+
+	g_main_loop_run (data.loop);
+
+	g_assert_cmpstr (data.order->str, ==, "abcdef");
+	g_assert_cmpuint (gdata_youtube_upload_queue_get_n_pending (queue), ==, 0);
+	g_assert_cmpuint (gdata_youtube_upload_queue_get_n_running (queue), ==, 0);
+	g_assert_cmpint (g_atomic_int_get (&(server_data.n_uploads)), ==, 6);
+
+	g_main_loop_unref (data.loop);
+	g_string_free (data.order, TRUE);
+	g_object_unref (queue);
+	g_object_unref (local_service);
+	upload_server_stop (&server_data);
+}
+
+static void
+test_upload_queue_cancel (void)
+{
+	GDataService *local_service;
+	GDataYouTubeUploadQueue *queue;
+	GDataYouTubeVideo *video;
+	GFile *video_file;
+	GCancellable *cancellable;
+	UploadServer server_data;
+	UploadQueueData data;
+
+	local_service = upload_server_start (&server_data);
+	queue = gdata_youtube_upload_queue_new (GDATA_YOUTUBE_SERVICE (local_service), 1, 0);
+
+	data.order = g_string_new (NULL);
+	data.n_left = 3;
+	data.loop = g_main_loop_new (NULL, FALSE);
+	g_object_set_data (G_OBJECT (queue), "test-data", &data);
+
+	video = build_upload_video ();
+	video_file = g_file_new_for_path (TEST_FILE_DIR "sample.ogg");
+	cancellable = g_cancellable_new ();
+
+	/* Cancel the second upload while it's waiting behind the first; it should be finished in its turn, without being sent */
+	gdata_youtube_upload_queue_add (queue, video, video_file, G_PRIORITY_DEFAULT, NULL, NULL, (GAsyncReadyCallback) test_upload_queue_cb, "a");
+	gdata_youtube_upload_queue_add (queue, video, video_file, G_PRIORITY_DEFAULT, NULL, cancellable, (GAsyncReadyCallback) test_upload_queue_cb,
+					"B");
+	gdata_youtube_upload_queue_add (queue, video, video_file, G_PRIORITY_DEFAULT, NULL, NULL, (GAsyncReadyCallback) test_upload_queue_cb, "c");
+	g_object_unref (video);
+	g_object_unref (video_file);
+
+	g_assert_cmpuint (gdata_youtube_upload_queue_get_n_pending (queue), ==, 2);
+	g_cancellable_cancel (cancellable);
+
+	g_main_loop_run (data.loop);
+
+	g_assert_cmpstr (data.order->str, ==, "aBc");
+	g_assert_cmpint (g_atomic_int_get (&(server_data.n_uploads)), ==, 2);
+
+	g_object_unref (cancellable);
+	g_main_loop_unref (data.loop);
+	g_string_free (data.order, TRUE);
+	g_object_unref (queue);
+	g_object_unref (local_service);
+	upload_server_stop (&server_data);
+}
+
+typedef struct {
+	GCancellable *cancellable;
+	guint64 bytes_sent;
+	guint64 total_bytes;
+} UploadThrottleData;
+
+static void
+test_upload_queue_throttle_progress_cb (GDataYouTubeService *youtube_service, GDataYouTubeVideo *video, guint64 bytes_sent, guint64 total_bytes,
+					gdouble bytes_per_second, UploadThrottleData *data)
+{
+	/* Stop the upload as soon as anything's been sent */
+	data->bytes_sent = bytes_sent;
+	data->total_bytes = total_bytes;
+	g_cancellable_cancel (data->cancellable);
+}
+
+static void
+test_upload_queue_throttle (void)
+{
+	GDataService *local_service;
+	GDataYouTubeUploadQueue *queue;
+	GDataYouTubeVideo *video;
+	GFile *video_file;
+	UploadServer server_data;
+	UploadQueueData data;
+	UploadThrottleData throttle_data;
+	GFileInfo *video_info;
+	guint64 video_length;
+	gulong progress_signal;
+
+	local_service = upload_server_start (&server_data);
+
+	/* The bucket only starts with a byte in it, so the video's first chunk should be held back for hours */
+	queue = gdata_youtube_upload_queue_new (GDATA_YOUTUBE_SERVICE (local_service), 1, 1);
+	g_assert_cmpuint (gdata_youtube_upload_queue_get_max_bytes_per_second (queue), ==, 1);
+
+	data.order = g_string_new (NULL);
+	data.n_left = 1;
+	data.loop = g_main_loop_new (NULL, FALSE);
+	g_object_set_data (G_OBJECT (queue), "test-data", &data);
+
+	throttle_data.cancellable = g_cancellable_new ();
+	throttle_data.bytes_sent = 0;
+	throttle_data.total_bytes = 0;
+	progress_signal = g_signal_connect (local_service, "upload-progress", (GCallback) test_upload_queue_throttle_progress_cb, &throttle_data);
+
+	video = build_upload_video ();
+	video_file = g_file_new_for_path (TEST_FILE_DIR "sample.ogg");
+	video_info = g_file_query_info (video_file, G_FILE_ATTRIBUTE_STANDARD_SIZE, G_FILE_QUERY_INFO_NONE, NULL, NULL);
+	g_assert (video_info != NULL);
+	video_length = (guint64) g_file_info_get_size (video_info);
+	g_object_unref (video_info);
+
+	gdata_youtube_upload_queue_add (queue, video, video_file, G_PRIORITY_DEFAULT, NULL, throttle_data.cancellable,
+					(GAsyncReadyCallback) test_upload_queue_cb, "A");
+	g_object_unref (video);
+	g_object_unref (video_file);
+
+	g_main_loop_run (data.loop);
+
+	/* Only the entry part of the body should have been sent before the throttle held the video back */
+	g_assert_cmpstr (data.order->str, ==, "A");
+	g_assert_cmpuint (throttle_data.bytes_sent, >, 0);
+	g_assert_cmpuint (throttle_data.bytes_sent, <=, throttle_data.total_bytes - video_length);
+	g_assert_cmpint (g_atomic_int_get (&(server_data.n_uploads)), ==, 0);
+
+	g_signal_handler_disconnect (local_service, progress_signal);
+	g_object_unref (throttle_data.cancellable);
+	g_main_loop_unref (data.loop);
+	g_string_free (data.order, TRUE);
+	g_object_unref (queue);
+	g_object_unref (local_service);
+	upload_server_stop (&server_data);
+}
+
+static void
+test_upload_resumable (void)
+{
+	GDataService *local_service;
+	GDataYouTubeVideo *video;
+	ResumableServerData data;
+	GMainContext *context;
+	GMainLoop *loop;
+	GThread *thread;
+	SoupServer *server;
+	GFile *video_file;
+	gchar *upload_uri, *contents;
+	gsize length;
+	GError *error = NULL;
+
+	/* Run a stand-in for the upload server, which drops some of the chunks, in another thread */
+	data.received = g_string_new (NULL);
+	data.n_chunks = 0;
+
+	context = g_main_context_new ();
+	server = soup_server_new (SOUP_SERVER_PORT, 0, SOUP_SERVER_ASYNC_CONTEXT, context, NULL);
+	soup_server_add_handler (server, NULL, (SoupServerCallback) resumable_server_cb, &data, NULL);
+	soup_server_run_async (server);
+
+	loop = g_main_loop_new (context, FALSE);
+	thread = g_thread_create ((GThreadFunc) server_thread_func, loop, TRUE, NULL);
+
+	upload_uri = g_strdup_printf ("http://127.0.0.1:%u/upload", soup_server_get_port (server));
+	video_file = g_file_new_for_path (TEST_FILE_DIR "sample.ogg");
+
+	/* No authentication's needed once the upload's been started */
+	local_service = GDATA_SERVICE (gdata_youtube_service_new (DEVELOPER_KEY, CLIENT_ID));
+	gdata_youtube_service_set_upload_chunk_size (GDATA_YOUTUBE_SERVICE (local_service), 8192);
+
+	/* Nothing's been committed yet */
+	g_assert_cmpint (gdata_youtube_service_query_resumable_upload (GDATA_YOUTUBE_SERVICE (local_service), upload_uri, video_file,
+								       NULL, &error), ==, 0);
+	g_assert_no_error (error);
+
+	/* Upload the video, resuming after each of the failures */
+	video = gdata_youtube_service_resume_upload (GDATA_YOUTUBE_SERVICE (local_service), upload_uri, video_file, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_YOUTUBE_VIDEO (video));
+	g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (video)), ==, "tag:youtube.com,2008:video:ResumableUp");
+	g_assert_cmpuint (data.n_chunks, >, 3);
+
+	/* Check the server got the whole file, intact */
+	g_assert (g_file_load_contents (video_file, NULL, &contents, &length, NULL, NULL) == TRUE);
+	g_assert_cmpuint (data.received->len, ==, length);
+	g_assert (memcmp (data.received->str, contents, length) == 0);
+	g_free (contents);
+
+	g_object_unref (video);
+	g_object_unref (local_service);
+	g_object_unref (video_file);
+	g_free (upload_uri);
+
+	g_main_loop_quit (loop);
+	g_thread_join (thread);
+	g_main_loop_unref (loop);
+	soup_server_quit (server);
+	g_object_unref (server);
+	g_main_context_unref (context);
+	g_string_free (data.received, TRUE);
+}
+
 static void
 test_parsing_app_control (void)
 {
@@ -598,6 +1226,16 @@ main (int argc, char *argv[])
 		g_test_add_func ("/youtube/query/related_async", test_query_related_async);
 	if (g_test_slow () == TRUE)
 		g_test_add_func ("/youtube/upload/simple", test_upload_simple);
+	if (g_test_slow () == TRUE)
+		g_test_add_func ("/youtube/upload/async", test_upload_async);
+	g_test_add_data_func ("/youtube/upload/file/mapped", &(upload_file_tests[0]), test_upload_file);
+	g_test_add_data_func ("/youtube/upload/file/mapped/async", &(upload_file_tests[1]), test_upload_file);
+	g_test_add_data_func ("/youtube/upload/file/unmapped", &(upload_file_tests[2]), test_upload_file);
+	g_test_add_data_func ("/youtube/upload/file/unmapped/async", &(upload_file_tests[3]), test_upload_file);
+	g_test_add_func ("/youtube/upload/queue", test_upload_queue);
+	g_test_add_func ("/youtube/upload/queue/cancel", test_upload_queue_cancel);
+	g_test_add_func ("/youtube/upload/queue/throttle", test_upload_queue_throttle);
+	g_test_add_func ("/youtube/upload/resumable", test_upload_resumable);
 	g_test_add_func ("/youtube/parsing/app:control", test_parsing_app_control);
 	g_test_add_func ("/youtube/parsing/comments/feedLink", test_parsing_comments_feed_link);
 	g_test_add_func ("/youtube/parsing/yt:recorded", test_parsing_yt_recorded);